@@ -0,0 +1,406 @@
+#include <benchmark/benchmark.h>
+#include "Headers/MultiThreadImageProcessor.hpp"
+#include "Headers/SyntheticContent.hpp"
+#include "Headers/ImageKernels.hpp"
+#include "Headers/NativeCapture.hpp"
+#include "Headers/FramePipeline.hpp"
+#include "Headers/FrameRecording.hpp"
+#include <thread>
+#include <memory>
+#include <filesystem>
+#include <cstdlib>
+
+// One benchmark per registered filter and thread count, on a 720p natural-like frame.
+// Sequential runs time the bare kernel; the others include splitting and stitching.
+// Each filter also runs on processors whose workers are pinned compactly and scattered.
+
+static MultiThreadImageProcessor& sharedProcessor(AffinityPolicy policy = AffinityPolicy::None) {
+    static const int budget = max(2, static_cast<int>(thread::hardware_concurrency()));
+    auto make = [](AffinityPolicy policy) {
+        AffinityOptions affinity;
+        affinity.policy = policy;
+        affinity.reservedCores = 0;     // No capture thread here; every core computes
+        return make_unique<MultiThreadImageProcessor>(1, budget, affinity);
+    };
+    static unique_ptr<MultiThreadImageProcessor> processors[] = {make(AffinityPolicy::None), make(AffinityPolicy::Compact),
+                                                                 make(AffinityPolicy::Scatter)};
+    return *processors[static_cast<int>(policy)];
+}
+
+static const Mat& benchmarkFrame() {
+    static Mat frame = SyntheticContent::generate(Size(1280, 720), ContentClass::Natural);
+    return frame;
+}
+
+static void filterBenchmark(benchmark::State& state, const string& filterName, AffinityPolicy policy) {
+    MultiThreadImageProcessor& processor = sharedProcessor(policy);
+    const Mat& input = benchmarkFrame();
+
+    ExecutionOptions options = processor.getDefaultOptions();
+    options.numThreads = static_cast<int>(state.range(0));
+    options.policy = (options.numThreads == 1) ? ParallelPolicy::Sequential : ParallelPolicy::Strips;
+
+    for (auto _ : state) {
+        Mat output = processor.applyFilter(filterName, input, options);
+        benchmark::DoNotOptimize(output.data);
+    }
+
+    double pixels = static_cast<double>(input.total());
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(pixels));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(input.total() * input.elemSize()));
+    state.counters["MP/s"] = benchmark::Counter(pixels / 1e6, benchmark::Counter::kIsIterationInvariantRate);
+    state.SetLabel(string("affinity=") + CpuTopology::policyName(policy));
+}
+
+// Denoisers on a 720p frame with Gaussian noise (sigma 15) added: speed as MP/s, quality as the
+// PSNR of the output against the clean frame, next to the PSNR of the noisy input
+static void denoiseQualityBenchmark(benchmark::State& state, const string& filterName) {
+    MultiThreadImageProcessor& processor = sharedProcessor();
+    static const Mat noisy = []() {
+        Mat noise(benchmarkFrame().size(), CV_16SC3), frame;
+        RNG rng(42);
+        rng.fill(noise, RNG::NORMAL, Scalar::all(0), Scalar::all(15));
+        benchmarkFrame().convertTo(frame, CV_16S);
+        frame += noise;
+        frame.convertTo(frame, CV_8U);
+        return frame;
+    }();
+
+    ExecutionOptions options = processor.getDefaultOptions();
+    options.numThreads = static_cast<int>(state.range(0));
+    options.policy = (options.numThreads == 1) ? ParallelPolicy::Sequential : ParallelPolicy::Strips;
+
+    Mat output;
+    for (auto _ : state) {
+        output = processor.applyFilter(filterName, noisy, options);
+        benchmark::DoNotOptimize(output.data);
+    }
+    state.counters["MP/s"] = benchmark::Counter(noisy.total() / 1e6, benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["psnr_db"] = PSNR(output, benchmarkFrame());
+    state.counters["noisy_psnr_db"] = PSNR(noisy, benchmarkFrame());
+}
+
+// Change-gated processing where a band covering the given percentage of the frame changes every frame
+static void incrementalBenchmark(benchmark::State& state, const string& filterName) {
+    MultiThreadImageProcessor& processor = sharedProcessor();
+    const Mat& base = benchmarkFrame();
+    Mat changed = base.clone();
+    int changedRows = static_cast<int>(base.rows * state.range(0) / 100);
+    if (changedRows > 0) {
+        bitwise_not(base(Rect(0, 0, base.cols, changedRows)), changed(Rect(0, 0, base.cols, changedRows)));
+    }
+
+    ExecutionOptions options = processor.getDefaultOptions();
+    options.numThreads = processor.getThreadBudget();
+    IncrementalOptions incremental;
+    incremental.refreshInterval = 0;
+    incremental.maxDirtyFraction = 1.0;     // Measure the gated path even when everything changed
+    IncrementalState cache;
+    IncrementalStats stats;
+    processor.applyFilterIncremental(filterName, base, options, cache, incremental);
+
+    bool flip = false;
+    for (auto _ : state) {
+        flip = !flip;
+        auto result = processor.applyFilterIncremental(filterName, flip ? changed : base, options, cache, incremental, &stats);
+        benchmark::DoNotOptimize(result.first.data);
+    }
+    state.counters["filtered"] = stats.filteredFraction;
+}
+
+// A grey-domain filter on an NV12 camera frame: converted to BGR first as VideoCapture does (native = 0),
+// or read from the luma plane directly (native = 1)
+static void nativeFormatBenchmark(benchmark::State& state, const string& filterName) {
+    MultiThreadImageProcessor& processor = sharedProcessor();
+    static Mat nv12 = NativeCapture::encode(benchmarkFrame(), PixelFormat::NV12);
+    bool native = state.range(0) != 0;
+
+    ExecutionOptions options = processor.getDefaultOptions();
+    options.numThreads = processor.getThreadBudget();
+
+    for (auto _ : state) {
+        Mat output;
+        if (native) {
+            FrameContext context(nv12, PixelFormat::NV12, &processor.getThreadPool(), options.numThreads);
+            output = processor.applyFilter(filterName, context, options);
+        } else {
+            Mat bgr;
+            cvtColor(nv12, bgr, COLOR_YUV2BGR_NV12);
+            output = processor.applyFilter(filterName, bgr, options);
+        }
+        benchmark::DoNotOptimize(output.data);
+    }
+    state.counters["MP/s"] = benchmark::Counter(benchmarkFrame().total() / 1e6, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// A capture loop where decoding the next NV12 frame waits for the filter (overlap = 0),
+// or runs while the submitted filter is still in flight (overlap = 1)
+static void submitOverlapBenchmark(benchmark::State& state, const string& filterName) {
+    MultiThreadImageProcessor& processor = sharedProcessor();
+    static Mat nv12 = NativeCapture::encode(benchmarkFrame(), PixelFormat::NV12);
+    bool overlap = state.range(0) != 0;
+
+    ExecutionOptions options = processor.getDefaultOptions();
+    options.numThreads = max(1, processor.getThreadBudget() - 1);     // One core is left to the capture side
+
+    Mat frame;
+    cvtColor(nv12, frame, COLOR_YUV2BGR_NV12);
+    for (auto _ : state) {
+        Mat output;
+        if (overlap) {
+            TaskFuture<Mat> pending = processor.submitFilter(filterName, frame, options);
+            frame = Mat();      // Decode into a new buffer; the submitted one is still shared with the filter
+            cvtColor(nv12, frame, COLOR_YUV2BGR_NV12);
+            output = pending.get();
+        } else {
+            output = processor.applyFilter(filterName, frame, options);
+            frame = Mat();
+            cvtColor(nv12, frame, COLOR_YUV2BGR_NV12);
+        }
+        benchmark::DoNotOptimize(output.data);
+    }
+    state.counters["fps"] = benchmark::Counter(1, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// A replay of 24 frames through a frame pipeline in each mode (0 auto, 1 intra-frame, 2 inter-frame, 3 hybrid).
+// Throughput is the fps counter; the latency counters show what the frames in flight and reordering cost.
+static void framePipelineBenchmark(benchmark::State& state, const string& filterName, Size frameSize) {
+    MultiThreadImageProcessor& processor = sharedProcessor();
+    static const int FRAMES = 24;
+    Mat frame = SyntheticContent::generate(frameSize, ContentClass::Natural);
+    FramePipelineOptions options;
+    options.mode = static_cast<FrameParallelism>(state.range(0));
+
+    FramePipelineStats stats;
+    FramePipelinePlan plan;
+    for (auto _ : state) {
+        FramePipeline pipeline(processor, filterName, options);
+        Mat output;
+        for (int i = 0; i < FRAMES; i++) {
+            pipeline.push(frame);
+            while (pipeline.tryPop(output)) benchmark::DoNotOptimize(output.data);
+        }
+        pipeline.finish();
+        while (pipeline.pop(output)) benchmark::DoNotOptimize(output.data);
+        stats = pipeline.getStats();
+        plan = pipeline.getPlan();
+    }
+    state.counters["fps"] = benchmark::Counter(FRAMES, benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["latency_ms"] = stats.averageLatencyMs;
+    state.counters["added_latency_ms"] = stats.addedLatencyMs;
+    state.SetLabel(FramePipeline::modeName(plan.mode) + " " + to_string(plan.framesInFlight) + "x" + to_string(plan.threadsPerFrame));
+}
+
+// Many small frames per call against one call per frame: arg 0 is the batch size, arg 1 picks the
+// batch API (1) or a loop of applyFilter calls (0) over the same frames
+static void batchBenchmark(benchmark::State& state, const vector<string>& chain) {
+    MultiThreadImageProcessor& processor = sharedProcessor();
+    vector<Mat> frames;
+    for (int i = 0; i < state.range(0); i++) {
+        frames.push_back(SyntheticContent::generate(Size(320, 240), (i % 2) ? ContentClass::HighEdge : ContentClass::Natural));
+    }
+    bool batched = state.range(1) != 0;
+    ExecutionOptions options;
+    options.numThreads = processor.getThreadBudget();
+
+    for (auto _ : state) {
+        if (batched) {
+            BatchResult result = processor.applyChainBatch(chain, frames, options);
+            benchmark::DoNotOptimize(result.frames.back().output.data);
+        } else {
+            for (const Mat& frame : frames) {
+                Mat output = frame;
+                for (const auto& filterName : chain) {
+                    output = processor.applyFilter(filterName, output, options);
+                }
+                benchmark::DoNotOptimize(output.data);
+            }
+        }
+    }
+    state.counters["fps"] = benchmark::Counter(static_cast<double>(frames.size()), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// Real footage for the replay benchmarks: the .cpraw recording named by CPMULTI_REPLAY (record one
+// with 'w' in the webcam view), or else a short synthetic clip recorded on first use
+static const string& replayPath() {
+    static const string path = []() {
+        const char* configured = getenv("CPMULTI_REPLAY");
+        if (configured && *configured) return string(configured);
+
+        const int frames = 30;
+        string generated = (filesystem::temp_directory_path() / "cpmulti_bench_replay.cpraw").string();
+        FrameRecorder recorder(frames);
+        recorder.open(generated, benchmarkFrame().size(), benchmarkFrame().type());
+        for (int i = 0; i < frames; i++) {
+            ContentClass content = (i % 3 == 0) ? ContentClass::Natural : (i % 3 == 1) ? ContentClass::HighEdge : ContentClass::Noise;
+            recorder.append(SyntheticContent::generate(benchmarkFrame().size(), content));
+        }
+        recorder.close();
+        return generated;
+    }();
+    return path;
+}
+
+// Cost of the replay input path per frame: map the recording and fault in every page of every
+// frame, with and without readahead. This is all a filter pays for its input on replay.
+static void replayInputBenchmark(benchmark::State& state) {
+    bool readahead = state.range(0) != 0;
+    size_t frames = 0;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        MappedRecording recording;
+        if (!recording.open(replayPath(), readahead)) {
+            state.SkipWithError("Recording cannot be opened");
+            return;
+        }
+        frames += recording.frameCount();
+        for (size_t i = 0; i < recording.frameCount(); i++) {
+            Mat frame = recording.frame(i);
+            size_t frameBytes = frame.total() * frame.elemSize();
+            uint8_t sum = 0;
+            for (size_t offset = 0; offset < frameBytes; offset += FrameRecorder::PAGE_BYTES) {
+                sum += frame.data[offset];
+            }
+            benchmark::DoNotOptimize(sum);
+            bytes += frameBytes;
+        }
+    }
+    state.counters["frames/s"] = benchmark::Counter(static_cast<double>(frames), benchmark::Counter::kIsRate);
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+
+// A filter over the recorded frames in order, read straight from the mapping
+static void replayFilterBenchmark(benchmark::State& state, const string& filterName) {
+    MultiThreadImageProcessor& processor = sharedProcessor();
+    MappedRecording recording;
+    if (!recording.open(replayPath()) || recording.frameCount() == 0) {
+        state.SkipWithError("Recording cannot be opened");
+        return;
+    }
+    ExecutionOptions options = processor.getDefaultOptions();
+    options.numThreads = processor.getThreadBudget();
+
+    size_t index = 0;
+    for (auto _ : state) {
+        Mat frame = recording.frame(index);
+        index = (index + 1) % recording.frameCount();
+        if (recording.format() != PixelFormat::BGR) {
+            FrameContext context(frame, recording.format(), &processor.getThreadPool(), options.numThreads);
+            benchmark::DoNotOptimize(processor.applyFilterTimed(filterName, context, options).first.data);
+        } else {
+            benchmark::DoNotOptimize(processor.applyFilterTimed(filterName, frame, options).first.data);
+        }
+    }
+    state.counters["fps"] = benchmark::Counter(1, benchmark::Counter::kIsIterationInvariantRate);
+    state.SetLabel(to_string(recording.frameSize().width) + "x" + to_string(recording.frameSize().height) + " " +
+                   FrameContext::formatName(recording.format()));
+}
+
+// The hand-written Sobel magnitude kernel at every instruction set this CPU can run
+static void gradientMagnitudeBenchmark(benchmark::State& state, ImageKernels::IsaLevel level) {
+    Mat gray, gx, gy;
+    cvtColor(benchmarkFrame(), gray, COLOR_BGR2GRAY);
+    Sobel(gray, gx, CV_16S, 1, 0);
+    Sobel(gray, gy, CV_16S, 0, 1);
+    Mat output(gray.size(), CV_8U);
+
+    for (auto _ : state) {
+        ImageKernels::gradientMagnitude(level, gx.ptr<int16_t>(), gy.ptr<int16_t>(), output.ptr<uint8_t>(), output.total());
+        benchmark::DoNotOptimize(output.data);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(output.total() * 5));
+}
+
+// The fused spectrum kernel alone, on the DFT of the benchmark frame; bytes are complex input plus output
+static void logMagnitudeBenchmark(benchmark::State& state, ImageKernels::IsaLevel level) {
+    Mat gray, spectrum;
+    cvtColor(benchmarkFrame(), gray, COLOR_BGR2GRAY);
+    gray.convertTo(gray, CV_32F);
+    dft(gray, spectrum, DFT_COMPLEX_OUTPUT);
+    Mat output(gray.size(), CV_8U);
+    float scale = 255.0f / log2(1.0f + spectrum.at<Vec2f>(0, 0)[0]);
+
+    for (auto _ : state) {
+        ImageKernels::logMagnitude(level, spectrum.ptr<float>(), output.ptr<uint8_t>(), output.total(), scale);
+        benchmark::DoNotOptimize(output.data);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(output.total() * 9));
+}
+
+int main(int argc, char** argv) {
+    // Recorded in the JSON output so results from different builds and machines can be told apart
+    benchmark::AddCustomContext("isa", ImageKernels::isaName(ImageKernels::activeIsa()));
+    benchmark::AddCustomContext("build_variant", ImageKernels::buildVariant());
+    benchmark::AddCustomContext("cpu_topology", CpuTopology::instance().describe());
+
+    for (auto level : {ImageKernels::IsaLevel::Generic, ImageKernels::IsaLevel::SSE42,
+                       ImageKernels::IsaLevel::AVX2, ImageKernels::IsaLevel::AVX512}) {
+        if (!ImageKernels::isAvailable(level)) continue;
+        string name = string("BM_gradient_magnitude/") + ImageKernels::isaName(level);
+        benchmark::RegisterBenchmark(name.c_str(), gradientMagnitudeBenchmark, level)->Unit(benchmark::kMicrosecond);
+        name = string("BM_log_magnitude/") + ImageKernels::isaName(level);
+        benchmark::RegisterBenchmark(name.c_str(), logMagnitudeBenchmark, level)->Unit(benchmark::kMicrosecond);
+    }
+
+    int maxThreads = sharedProcessor().getThreadBudget();
+    for (const auto& filterName : sharedProcessor().getFilterNames()) {
+        for (auto policy : {AffinityPolicy::None, AffinityPolicy::Compact, AffinityPolicy::Scatter}) {
+            string name = "BM_" + filterName;
+            if (policy != AffinityPolicy::None) name += string("_pinned_") + CpuTopology::policyName(policy);
+            auto* registered = benchmark::RegisterBenchmark(name.c_str(), filterBenchmark, filterName, policy);
+            registered->Arg(1);
+            for (int threads = 2; threads < maxThreads; threads *= 2) {
+                registered->Arg(threads);
+            }
+            registered->Arg(maxThreads)->ArgName("threads")->Unit(benchmark::kMillisecond)->UseRealTime();
+        }
+    }
+
+    for (const char* filterName : {"denoising", "guided", "gaussian", "median"}) {
+        benchmark::RegisterBenchmark((string("BM_denoise_quality_") + filterName).c_str(), denoiseQualityBenchmark, string(filterName))
+            ->Arg(1)->Arg(maxThreads)->ArgName("threads")->Unit(benchmark::kMillisecond)->UseRealTime();
+    }
+
+    for (const char* filterName : {"gaussian", "median", "denoising"}) {
+        benchmark::RegisterBenchmark((string("BM_incremental_") + filterName).c_str(), incrementalBenchmark, string(filterName))
+            ->Arg(0)->Arg(5)->Arg(25)->Arg(100)->ArgName("changed_percent")->Unit(benchmark::kMillisecond)->UseRealTime();
+    }
+
+    for (const char* filterName : {"greyscale", "sobel", "canny", "fourier"}) {
+        benchmark::RegisterBenchmark((string("BM_nv12_") + filterName).c_str(), nativeFormatBenchmark, string(filterName))
+            ->Arg(0)->Arg(1)->ArgName("native")->Unit(benchmark::kMillisecond)->UseRealTime();
+    }
+
+    for (const char* filterName : {"gaussian", "sobel", "denoising"}) {
+        benchmark::RegisterBenchmark((string("BM_submit_overlap_") + filterName).c_str(), submitOverlapBenchmark, string(filterName))
+            ->Arg(0)->Arg(1)->ArgName("overlap")->Unit(benchmark::kMillisecond)->UseRealTime();
+    }
+
+    for (const char* filterName : {"gaussian", "fourier", "rotate"}) {
+        for (Size frameSize : {Size(320, 240), Size(1280, 720)}) {
+            string name = string("BM_frame_pipeline_") + filterName + "/" + to_string(frameSize.width) + "x" + to_string(frameSize.height);
+            benchmark::RegisterBenchmark(name.c_str(), framePipelineBenchmark, string(filterName), frameSize)
+                ->DenseRange(0, 3)->ArgName("mode")->Unit(benchmark::kMillisecond)->UseRealTime();
+        }
+    }
+
+    for (const vector<string>& chain : vector<vector<string>>{{"gaussian"}, {"sobel"}, {"gaussian", "median"}}) {
+        string name = "BM_batch";
+        for (const auto& filterName : chain) name += "_" + filterName;
+        benchmark::RegisterBenchmark(name.c_str(), batchBenchmark, chain)
+            ->ArgsProduct({{1, 8, 32}, {0, 1}})->ArgNames({"frames", "batched"})->Unit(benchmark::kMillisecond)->UseRealTime();
+    }
+
+    benchmark::RegisterBenchmark("BM_replay_input", replayInputBenchmark)->Arg(0)->Arg(1)->ArgName("readahead")
+        ->Unit(benchmark::kMillisecond)->UseRealTime();
+    for (const char* filterName : {"gaussian", "median", "sobel"}) {
+        benchmark::RegisterBenchmark((string("BM_replay_") + filterName).c_str(), replayFilterBenchmark, string(filterName))
+            ->Unit(benchmark::kMillisecond)->UseRealTime();
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
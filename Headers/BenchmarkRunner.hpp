@@ -0,0 +1,75 @@
+#ifndef BENCHMARK_RUNNER_HPP
+#define BENCHMARK_RUNNER_HPP
+
+#include <opencv2/opencv.hpp>
+#include "Headers/MultiThreadImageProcessor.hpp"
+#include "Headers/PerfCounters.hpp"
+#include "Headers/SyntheticContent.hpp"
+#include <string>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+
+// Result of one filter at one thread count
+struct BenchmarkSample {
+    int threads = 1;
+    double meanUs = 0;
+    vector<double> trialsUs;
+    CounterSample counters;         // Summed over all trials; invalid when counters are unavailable
+    double bytesPerPixel = 0;       // Estimated DRAM traffic per pixel per trial, from LLC misses
+};
+
+struct BenchmarkOptions {
+    int minThreads = 1;
+    int maxThreads = 10;
+    int trials = 3;
+    bool collectCounters = true;    // Read hardware counters when the platform allows it
+    ExecutionOptions execution;     // Policy, halo and tile size; numThreads is swept
+};
+
+// One point of a resolution and content sweep
+struct SweepPoint {
+    string filterName;
+    ContentClass content = ContentClass::Natural;
+    Size size;
+    int threads = 1;
+    double meanUs = 0;
+    double usPerMegapixel = 0;
+};
+
+struct SweepOptions {
+    vector<Size> resolutions = {Size(320, 240), Size(640, 480), Size(1280, 720),
+                                Size(1920, 1080), Size(3840, 2160), Size(7680, 4320)};
+    vector<ContentClass> contents = SyntheticContent::all();
+    vector<int> threadCounts = {1};
+    int trials = 2;
+    double maxRunSeconds = 5.0;     // Larger resolutions are skipped once one run of a filter takes longer
+    ExecutionOptions execution;     // numThreads is swept
+};
+
+// Thread-scaling sweeps of the processor's filters
+class BenchmarkRunner {
+public:
+    BenchmarkRunner(MultiThreadImageProcessor& processor);
+
+    BenchmarkSample runSample(const string& filterName, const Mat& input, int threads,
+                              const BenchmarkOptions& options, Mat* lastOutput = nullptr);
+    // Timed runs never use the result cache. The outputs of the sequential run and of the fastest
+    // thread count are kept on request, so saving them needs no extra run.
+    vector<BenchmarkSample> runThreadSweep(const string& filterName, const Mat& input, const BenchmarkOptions& options,
+                                           Mat* sequentialOutput = nullptr, Mat* fastestOutput = nullptr);
+    // Every filter on generated images of every resolution and content class
+    vector<SweepPoint> runResolutionSweep(const vector<string>& filterNames, const SweepOptions& options);
+
+    bool countersAvailable() const { return counters.isAvailable(); }
+    const string& getCountersUnavailableReason() const { return counters.getUnavailableReason(); }
+
+    static void printSample(const string& filterName, const BenchmarkSample& sample);
+
+private:
+    MultiThreadImageProcessor& processor;
+    PerfCounters counters;
+};
+
+#endif // BENCHMARK_RUNNER_HPP
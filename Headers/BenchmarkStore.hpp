@@ -0,0 +1,65 @@
+#ifndef BENCHMARK_STORE_HPP
+#define BENCHMARK_STORE_HPP
+
+#include "Headers/BenchmarkRunner.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+using namespace std;
+
+// Build and machine details recorded with every benchmark run
+struct RunMetadata {
+    string runId;               // UTC timestamp of the run, unique per store
+    string gitHash;
+    string compiler;
+    string compilerFlags;
+    string cpuModel;
+    string opencvVersion;
+    string threadPolicy;        // Scheduling policy, halo and tile size
+    int hardwareThreads = 0;
+    string input;               // Description of the benchmarked frame
+    string isa;                 // Instruction set of the dispatched kernels
+    string buildVariant;        // Build type plus LTO, PGO and -march settings
+
+    static RunMetadata collect(const ExecutionOptions& execution, const string& input);
+};
+
+// One stored row: a filter at one thread count within a run
+struct StoredResult {
+    RunMetadata metadata;
+    string filterName;
+    int threads = 1;
+    vector<double> trialsUs;
+};
+
+struct ComparisonOptions {
+    string baselineRun;         // Run id or git hash prefix; empty picks the run before the candidate
+    string candidateRun;        // Empty picks the latest run
+    double thresholdPercent = 5.0;  // Slowdowns beyond this that are also significant fail the comparison
+    double alpha = 0.05;        // Significance level of Welch's t-test
+};
+
+// Append-only tab-separated store of benchmark results, one row per filter and thread count
+class BenchmarkStore {
+public:
+    BenchmarkStore(const string& path);
+
+    bool append(const RunMetadata& metadata, const unordered_map<string, vector<BenchmarkSample>>& samples);
+    vector<StoredResult> load() const;
+    vector<string> listRuns() const;    // Run ids in the order they were appended
+
+    // Print per-filter changes between two runs. Returns 0 when no filter regressed
+    // significantly beyond the threshold, 1 when one did and 2 when the runs are missing.
+    int compare(const ComparisonOptions& options) const;
+
+    // Two-sided p-value of Welch's t-test
+    static double welchPValue(const vector<double>& a, const vector<double>& b);
+
+private:
+    string path;
+
+    static string sanitize(const string& field);
+};
+
+#endif // BENCHMARK_STORE_HPP
@@ -3,6 +3,7 @@
 
 #include <opencv2/opencv.hpp>
 #include <iostream>
+#include "Headers/FrameContext.hpp"
 
 using namespace cv;
 using namespace std;
@@ -18,6 +19,7 @@ public:
 
     void setThresholds(double t1, double t2);
     Mat applyFilter(const Mat& inputFrame);
+    Mat applyFilter(FrameContext& context, const Rect& region); // Edges from the frame's shared gradients
     string windowName = "Greyscale Filter";
 };
 
@@ -0,0 +1,66 @@
+#ifndef CPU_TOPOLOGY_HPP
+#define CPU_TOPOLOGY_HPP
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// One logical CPU as the kernel numbers it
+struct LogicalCpu {
+    int id = 0;
+    int core = 0;       // Physical core, unique across packages
+    int package = 0;    // Socket
+    int node = 0;       // NUMA node
+    int smtIndex = 0;   // 0 for the first hardware thread of its core, 1 for its SMT sibling, ...
+};
+
+// Where pool workers are pinned
+enum class AffinityPolicy {
+    None,       // Threads float; the OS scheduler decides
+    Compact,    // Fill a core's SMT siblings before moving to the next core, one node at a time
+    Scatter     // One thread per physical core, spread across nodes, SMT siblings last
+};
+
+struct AffinityOptions {
+    AffinityPolicy policy = AffinityPolicy::None;
+    int reservedCores = 1;      // Physical cores kept free of pool workers for capture and display
+    bool firstTouch = true;     // Copy each strip into a buffer first touched by its pinned worker on multi-node machines
+
+    // CPMULTI_AFFINITY=none|compact|scatter and CPMULTI_RESERVED_CORES=<n>
+    static AffinityOptions fromEnvironment();
+};
+
+// Logical CPUs, cores and NUMA nodes of the machine, read from sysfs on Linux.
+// Elsewhere every hardware thread is reported as its own core on node 0 and pinning is a no-op.
+class CpuTopology {
+public:
+    static const CpuTopology& instance();
+
+    const vector<LogicalCpu>& cpus() const { return logicalCpus; }
+    int coreCount() const { return cores; }
+    int nodeCount() const { return nodes; }
+
+    // CPUs for capture and display, then the order in which pool workers are pinned.
+    // The two lists never overlap unless the machine has a single core.
+    vector<int> ioCpus(const AffinityOptions& options) const;
+    vector<int> workerCpus(const AffinityOptions& options) const;
+
+    int nodeOf(int cpu) const;
+    string describe() const;
+
+    // Restrict the calling thread to the given CPUs. Returns false when unsupported or refused.
+    static bool pinCurrentThread(const vector<int>& cpus);
+    static int currentCpu();    // -1 when unknown
+
+    static const char* policyName(AffinityPolicy policy);
+
+private:
+    CpuTopology();
+
+    vector<LogicalCpu> logicalCpus;
+    int cores = 0;
+    int nodes = 1;
+};
+
+#endif // CPU_TOPOLOGY_HPP
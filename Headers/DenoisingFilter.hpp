@@ -9,15 +9,18 @@ using namespace std;
 
 class DenoisingFilter {
 public:
-    DenoisingFilter(float strength = 10.0);  // Constructor with default denoising strength
+    DenoisingFilter(float strength = 10.0, int templateWindow = 7, int searchWindow = 10);  // Constructor with default denoising strength and window sizes
     ~DenoisingFilter(); // Destructor
 
     void setStrength(float strength); // Update the denoising strength
+    void setWindowSizes(int templateWindow, int searchWindow); // Smaller windows trade quality for speed
 
     Mat applyFilter(const Mat& inputFrame); // Apply denoising filter
 
 private:
     float hStrength;  // Filter strength parameter
+    int templateWindowSize;  // Patch compared around each pixel
+    int searchWindowSize;    // Area searched for similar patches
     string windowName = "Denoising Filter"; // Window name for display
 };
 
@@ -5,22 +5,36 @@
 #include <opencv2/imgproc.hpp>
 #include <iostream>
 #include <string>
+#include "Headers/FrameContext.hpp"
 
 using namespace cv;
 using namespace std;
 
+// Float: centred log-magnitude spectrum as CV_32F, min-max normalized to [0,1].
+// Bytes: the same spectrum as CV_8U, ready to show or save. Black is a magnitude of zero and
+// white the DC term, the largest magnitude any non-negative image can have, so no normalize
+// pass is needed; magnitude, log, quadrant shift and scaling are done in one pass.
+enum class SpectrumOutput {
+    Float,
+    Bytes
+};
 
 class FourierFilter {
 public:
-    FourierFilter();
+    explicit FourierFilter(SpectrumOutput output = SpectrumOutput::Float);
     ~FourierFilter();
 
     Mat applyFilter(const Mat& inputFrame);
+    Mat applyFilter(FrameContext& context);
 
     string getWindowName() const { return windowName; }
 
 private:
     string windowName = "Fourier Transform";
+    SpectrumOutput output;
+
+    Mat magnitudeSpectrum(const Mat& gray);
+    Mat byteSpectrum(const Mat& gray);
 };
 
 #endif // FOURIERFILTER_HPP
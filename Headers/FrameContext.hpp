@@ -0,0 +1,61 @@
+#ifndef FRAME_CONTEXT_HPP
+#define FRAME_CONTEXT_HPP
+
+#include <opencv2/opencv.hpp>
+#include <mutex>
+#include "Headers/ThreadPool.hpp"
+
+using namespace cv;
+using namespace std;
+
+// Layout of a frame as it comes from the camera
+enum class PixelFormat {
+    BGR,    // CV_8UC3, what VideoCapture converts to by default
+    NV12,   // CV_8UC1 of height * 3 / 2 rows: the Y plane, then interleaved U/V at half resolution
+    YUYV    // CV_8UC2: Y and alternating U/V for every pixel
+};
+
+// Planes derived from one frame, computed on first use and shared by every filter applied to it.
+// Each plane is computed exactly once even when several strips ask for it at the same time; the
+// others wait for it. The frame must not change while the context is alive. With a pool, the grey
+// plane and the gradients are computed in row bands on up to maxWorkers threads.
+// A camera-native frame is kept as captured: the grey plane comes straight from its luma, and the
+// BGR frame is only converted when a colour filter or the display asks for it.
+class FrameContext {
+public:
+    explicit FrameContext(const Mat& frame, ThreadPool* pool = nullptr, int maxWorkers = 1);
+    FrameContext(const Mat& raw, PixelFormat format, ThreadPool* pool = nullptr, int maxWorkers = 1);
+    FrameContext(const FrameContext&) = delete;
+    FrameContext& operator=(const FrameContext&) = delete;
+
+    PixelFormat format() const { return pixelFormat; }
+    Size size() const { return frameSize; }
+    bool empty() const { return raw.empty(); }
+    const Mat& native() const { return raw; }  // The frame as captured
+
+    const Mat& frame();                 // CV_8UC3, converted from a native frame on first use
+    const Mat& grey();                  // CV_8UC1; the luma plane itself for NV12
+    // 3x3 Sobel derivatives of the grey plane, CV_16SC1, with replicated borders as Canny computes them
+    const Mat& gradientX();
+    const Mat& gradientY();
+
+    static Size frameSizeOf(const Mat& raw, PixelFormat format);
+    static const char* formatName(PixelFormat format);
+
+private:
+    Mat raw;
+    PixelFormat pixelFormat;
+    Size frameSize;
+    ThreadPool* pool;
+    int maxWorkers;
+
+    Mat source;
+    once_flag sourceOnce;
+
+    Mat greyPlane, gradientXPlane, gradientYPlane;
+    once_flag greyOnce, gradientXOnce, gradientYOnce;
+
+    void forEachBand(int rows, const function<void(const Range&)>& body);
+};
+
+#endif // FRAME_CONTEXT_HPP
@@ -0,0 +1,111 @@
+#ifndef FRAME_PIPELINE_HPP
+#define FRAME_PIPELINE_HPP
+
+#include <opencv2/opencv.hpp>
+#include "Headers/MultiThreadImageProcessor.hpp"
+#include <string>
+#include <map>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+using namespace cv;
+using namespace std;
+
+// Where the parallelism of a frame sequence comes from
+enum class FrameParallelism {
+    Auto,           // Chosen from the frame size and the measured cost of the filter
+    IntraFrame,     // One frame at a time, split into strips across the whole budget
+    InterFrame,     // Whole frames on separate workers, one thread each
+    Hybrid          // A few frames at a time, each split across its share of the budget
+};
+
+struct FramePipelineOptions {
+    FrameParallelism mode = FrameParallelism::Auto;
+    int framesInFlight = 0;     // 0 derives it from the mode and the thread budget
+    double minStripMs = 1.0;    // A strip should take at least this long to repay its fork and join
+    int minStripRows = 32;      // and be at least this tall, so its halo stays a small share of it
+};
+
+// How the budget is divided, decided on the first frame
+struct FramePipelinePlan {
+    FrameParallelism mode = FrameParallelism::IntraFrame;
+    int framesInFlight = 1;
+    int threadsPerFrame = 1;
+    double frameCostMs = 0;     // Sequential time of the first frame
+};
+
+struct FramePipelineStats {
+    uint64_t framesPushed = 0;
+    uint64_t framesEmitted = 0;     // Released in order by the reorder buffer
+    double throughputFps = 0;       // Emitted frames per second since the first push
+    double averageFilterMs = 0;     // Time spent filtering one frame
+    double averageLatencyMs = 0;    // Push to in-order release, including queueing and reordering
+    double addedLatencyMs = 0;      // Latency beyond the filtering itself
+    size_t maxReorderDepth = 0;     // Most finished frames held back behind a slower earlier one
+};
+
+// Runs one filter over a sequence of frames and emits the outputs in input order. Strip splitting
+// scales poorly on small frames and cannot be used by filters that need the whole frame, so the
+// pipeline can instead keep several frames in flight on the shared pool. That raises throughput
+// at the cost of latency, which makes it a fit for offline replays rather than live feeds.
+class FramePipeline {
+public:
+    FramePipeline(MultiThreadImageProcessor& processor, const string& filterName,
+                  const FramePipelineOptions& options = FramePipelineOptions());
+    ~FramePipeline();
+
+    // Queue a frame; blocks while the plan's frames are all in flight. The frame is shared, not
+    // copied, and must not be written until its output was emitted.
+    void push(const Mat& frame);
+    // Next output in input order. Blocks until it is released; false once finish() was called and
+    // every output has been taken. A frame whose filter failed is emitted as an empty Mat.
+    bool pop(Mat& output);
+    bool tryPop(Mat& output);
+    void finish();      // No more frames will be pushed
+
+    FramePipelinePlan getPlan() const;
+    FramePipelineStats getStats() const;
+    void printSummary() const;
+
+    static FramePipelinePlan choosePlan(const FilterCapabilities& capabilities, const Size& frameSize, double frameCostMs,
+                                        int threadBudget, const FramePipelineOptions& options = FramePipelineOptions());
+    static string modeName(FrameParallelism mode);
+
+private:
+    using Clock = chrono::steady_clock;
+
+    struct Finished {
+        Mat output;
+        Clock::time_point pushedAt;
+        double filterMs = 0;
+    };
+
+    MultiThreadImageProcessor& processor;
+    string filterName;
+    FramePipelineOptions options;
+    FramePipelinePlan plan;
+    bool planned = false;
+
+    mutable mutex pipelineMutex;
+    condition_variable slotCondition;       // A frame finished filtering
+    condition_variable outputCondition;     // An output was released, or the sequence ended
+    map<uint64_t, Finished> reorderBuffer;  // Finished out of order, waiting for an earlier frame
+    deque<Mat> releasedOutputs;             // In order, waiting for pop()
+    uint64_t nextSequence = 0;
+    uint64_t nextRelease = 0;
+    int framesInFlight = 0;
+    bool finishing = false;
+
+    FramePipelineStats stats;
+    Clock::time_point firstPush;
+    Clock::time_point lastRelease;
+    double totalFilterMs = 0;
+    double totalLatencyMs = 0;
+
+    ExecutionOptions frameOptions() const;
+    void complete(uint64_t sequence, Clock::time_point pushedAt, Mat output, double filterUs);
+};
+
+#endif // FRAME_PIPELINE_HPP
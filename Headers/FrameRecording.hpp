@@ -0,0 +1,131 @@
+#ifndef FRAME_RECORDING_HPP
+#define FRAME_RECORDING_HPP
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <deque>
+#include <vector>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "Headers/FrameContext.hpp"
+
+using namespace cv;
+using namespace std;
+
+// A .cpraw file is one RecordingHeader followed by fixed-size frame slots. Each slot starts with a
+// RecordingFrameHeader and holds the frame's rows packed back to back at SLOT_DATA_OFFSET. Slots
+// are a whole number of pages, so every frame starts on its own page when the file is mapped.
+struct RecordingHeader {
+    static constexpr char MAGIC[8] = {'C', 'P', 'M', 'R', 'A', 'W', '0', '1'};
+    static constexpr uint32_t VERSION = 1;
+
+    char magic[8];
+    uint32_t version = VERSION;
+    uint32_t headerBytes = 0;   // Offset of the first slot
+    uint64_t slotBytes = 0;
+    uint64_t frameCount = 0;    // Written on close; a recording that was never closed is read up to its last whole slot
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t type = 0;           // OpenCV type of every frame
+    int32_t format = 0;         // PixelFormat of every frame
+};
+
+struct RecordingFrameHeader {
+    uint64_t timestampUs = 0;   // Since the first frame of the recording
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t type = 0;
+    int32_t format = 0;
+    uint64_t dataBytes = 0;
+};
+
+// Writes frames to a .cpraw file on a background thread, so a capture loop only pays for a copy.
+// Frames arriving while the writer is maxQueuedFrames behind are dropped and counted.
+class FrameRecorder {
+public:
+    static constexpr size_t PAGE_BYTES = 4096;
+    static constexpr size_t SLOT_DATA_OFFSET = 64;
+
+    explicit FrameRecorder(size_t maxQueuedFrames = 32);
+    ~FrameRecorder();
+
+    bool open(const string& path, const Size& frameSize, int type, PixelFormat format = PixelFormat::BGR);
+    bool append(const Mat& frame);      // Copies the frame; false when it was dropped or a write has failed
+    bool close();                       // Writes every queued frame, then the frame count; false when a write failed
+
+    bool isOpen() const { return recording; }
+    const string& getPath() const { return path; }
+    uint64_t framesWritten() const { return written.load(); }
+    uint64_t framesDropped() const { return dropped.load(); }
+
+    static size_t slotBytesFor(const Size& frameSize, int type);
+
+private:
+    using Clock = chrono::steady_clock;
+
+    struct QueuedFrame {
+        Mat pixels;
+        uint64_t timestampUs;
+    };
+
+    size_t maxQueuedFrames;
+    string path;
+    ofstream file;
+    RecordingHeader header;
+    bool recording = false;
+    Clock::time_point startedAt;
+
+    thread writerThread;
+    mutex queueMutex;
+    condition_variable queueCondition;
+    deque<QueuedFrame> queue;
+    bool closing = false;
+    atomic<uint64_t> written{0};
+    atomic<uint64_t> dropped{0};
+    atomic<bool> writeFailed{false};    // The writer stopped; later frames would never reach the file
+
+    void writerLoop();
+};
+
+// Read-only view of a .cpraw file. The file is mapped into memory and each frame is a Mat over
+// its pages, so reading a frame copies nothing and costs no more than the page faults of the
+// pixels a filter touches; with readahead the kernel is asked to fetch the pages ahead of time.
+// Frames stay valid while the recording is open. The mapping is private: writing to a frame
+// changes only this process's copy of that page, never the file.
+class MappedRecording {
+public:
+    MappedRecording() = default;
+    ~MappedRecording();
+    MappedRecording(const MappedRecording&) = delete;
+    MappedRecording& operator=(const MappedRecording&) = delete;
+
+    bool open(const string& path, bool readahead = true);
+    void close();
+    bool isOpen() const { return base != nullptr; }
+
+    size_t frameCount() const { return frames; }
+    Size frameSize() const { return Size(header.width, header.height); }
+    int frameType() const { return header.type; }
+    PixelFormat format() const { return static_cast<PixelFormat>(header.format); }
+
+    Mat frame(size_t index) const;
+    uint64_t timestampUs(size_t index) const;
+    void prefetch(size_t first, size_t count) const;   // Ask for the pages of these frames to be read in
+
+private:
+    uint8_t* base = nullptr;
+    size_t mappedBytes = 0;
+    bool mapped = false;            // False when the platform cannot map files and the file was read instead
+    vector<uint8_t> fallbackBuffer;
+    RecordingHeader header;
+    size_t frames = 0;
+
+    const RecordingFrameHeader& frameHeader(size_t index) const;
+};
+
+#endif // FRAME_RECORDING_HPP
@@ -4,6 +4,7 @@
 #include <opencv2/opencv.hpp>
 #include <string>
 #include <chrono>
+#include "Headers/FrameContext.hpp"
 
 using namespace cv;
 using namespace std;
@@ -14,6 +15,7 @@ class GreyScaleFilter {
     ~GreyScaleFilter(); 
 
     Mat applyFilter(const Mat& inputFrame);
+    Mat applyFilter(FrameContext& context, const Rect& region); // Region of the frame's shared grey plane
 
   private:
     string windowName = "Greyscale Feed";
@@ -0,0 +1,32 @@
+#ifndef GUIDED_FILTER_HPP
+#define GUIDED_FILTER_HPP
+
+#include <opencv2/opencv.hpp>
+#include <string>
+
+using namespace cv;
+using namespace std;
+
+// Edge-preserving smoothing with each channel as its own guide (He et al., "Guided Image Filtering").
+// Every box mean is read from an integral image, so the cost per pixel does not depend on the
+// radius. Windows are clipped at the image border, and the intermediate coefficients are kept
+// in fixed point so that their window sums are exact: a strip padded by getHalo() rows gives
+// the same pixels as filtering the whole frame.
+class GuidedFilter {
+public:
+    GuidedFilter(int radius = 8, float smoothing = 20.0f);  // Constructor with default window radius and smoothing strength
+    ~GuidedFilter(); // Destructor
+
+    void setRadius(int radius); // Window is (2 * radius + 1) pixels square
+    void setSmoothing(float smoothing); // Variations below about this many grey levels are smoothed away, larger ones kept
+    int getHalo() const { return 2 * windowRadius; }  // Two box means deep
+
+    Mat applyFilter(const Mat& inputFrame); // Apply the guided filter to an 8-bit image
+
+private:
+    int windowRadius;
+    float smoothingLevel;
+    string windowName = "Guided Filter"; // Window name for display
+};
+
+#endif // GUIDED_FILTER_HPP
@@ -0,0 +1,62 @@
+#ifndef IMAGE_KERNELS_HPP
+#define IMAGE_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Hand-written pixel kernels. Sources/Kernels/ImageKernelsImpl.cpp is compiled once per
+// instruction set; the dispatcher picks the best version the CPU supports at startup.
+namespace ImageKernels {
+
+enum class IsaLevel {
+    Generic = 0,    // Compiler defaults (SSE2 on x86-64)
+    SSE42 = 1,
+    AVX2 = 2,
+    AVX512 = 3      // AVX-512 F and BW
+};
+
+IsaLevel detectIsa();           // Best level supported by both the CPU and this build
+IsaLevel activeIsa();           // Level in use; CPMULTI_ISA=generic|sse4.2|avx2|avx512 can lower it
+bool isAvailable(IsaLevel level);   // Built into this binary and supported by the CPU
+const char* isaName(IsaLevel level);
+const char* buildVariant();     // Build type plus LTO, PGO and -march settings
+
+// out = (|gx| + |gy|) / 2 with each magnitude saturated to 8 bits and halves rounded to even,
+// which is what convertScaleAbs twice followed by addWeighted(0.5, 0.5) computes, in one pass.
+// Either gradient may be null and is then treated as zero.
+void gradientMagnitude(const int16_t* gx, const int16_t* gy, uint8_t* out, size_t count);
+// Same kernel at a specific level, for tests and benchmarks; the level must be available
+void gradientMagnitude(IsaLevel level, const int16_t* gx, const int16_t* gy, uint8_t* out, size_t count);
+
+// out = log2(1 + |z|) * scale rounded and saturated to 8 bits, for count interleaved complex
+// values z = (re, im), as a display-ready log-magnitude spectrum. The log and the magnitude are
+// approximated; the result is within one grey level of the exact value whenever scale <= 255.
+void logMagnitude(const float* spectrum, uint8_t* out, size_t count, float scale);
+void logMagnitude(IsaLevel level, const float* spectrum, uint8_t* out, size_t count, float scale);
+
+// 64-bit non-cryptographic content hash in the style of XXH3, identical at every level.
+// Meant for cache keys: equal inputs always match, different ones collide with probability ~2^-64.
+uint64_t hash64(const void* data, size_t length, uint64_t seed = 0);
+uint64_t hash64(IsaLevel level, const void* data, size_t length, uint64_t seed = 0);
+// The same hash over rows of rowBytes each, stride bytes apart: equal to hash64 of the rows
+// stored back to back, so an image view and a contiguous copy of it hash alike
+uint64_t hash64Rows(const void* data, size_t rowBytes, size_t rows, size_t stride, uint64_t seed = 0);
+uint64_t hash64Rows(IsaLevel level, const void* data, size_t rowBytes, size_t rows, size_t stride, uint64_t seed = 0);
+
+// One implementation per instruction set, defined in Sources/Kernels/ImageKernelsImpl.cpp
+#define CPMULTI_DECLARE_KERNELS(isa) \
+    namespace isa { \
+        void gradientMagnitude(const int16_t* gx, const int16_t* gy, uint8_t* out, size_t count); \
+        uint64_t hash64(const void* data, size_t length, uint64_t seed); \
+        uint64_t hash64Rows(const void* data, size_t rowBytes, size_t rows, size_t stride, uint64_t seed); \
+        void logMagnitude(const float* spectrum, uint8_t* out, size_t count, float scale); \
+    }
+CPMULTI_DECLARE_KERNELS(generic)
+CPMULTI_DECLARE_KERNELS(sse42)
+CPMULTI_DECLARE_KERNELS(avx2)
+CPMULTI_DECLARE_KERNELS(avx512)
+#undef CPMULTI_DECLARE_KERNELS
+
+} // namespace ImageKernels
+
+#endif // IMAGE_KERNELS_HPP
@@ -5,11 +5,17 @@
 #include <unordered_map>
 #include "Headers/MultiThreadImageProcessor.hpp"
 #include "Headers/PerformanceVisualization.hpp"
+#include "Headers/BenchmarkRunner.hpp"
+#include "Headers/ScalingAnalysis.hpp"
+#include "Headers/BenchmarkStore.hpp"
+#include "Headers/ImageKernels.hpp"
 #include <iostream>
 #include <filesystem>
 #include <thread>
 #include <iomanip>
 #include <numeric>
+#include <future>
+#include <fstream>
 
 using namespace cv;
 using namespace std;
@@ -17,11 +23,15 @@ using namespace std;
 class KeyHandler {
 public:
     KeyHandler(MultiThreadImageProcessor& processor, string resourcesPath);
+    ~KeyHandler();
     
     bool handleKeyPress(char key, Mat& frame); // Handle key events
     void handleTestCase(const Mat& frame); // Test all filters with different threads
     void handleAllFiltersWithCutLines(const Mat& frame);
     void saveFilteredImage(const Mat& image, const string& filterName, bool isMultiThread);
+    void setArchiveSnapshots(bool enabled); // Keep an asynchronous JPEG copy of processed frames
+    void refreshPlots(); // Call from the UI loop; plots and single-filter results are produced on background threads
+    void handleResolutionSweep(bool quick = false); // Every filter on generated images from 320x240 to 8K, or to 1080p when quick
 
 private:
     MultiThreadImageProcessor& imageProcessor;
@@ -30,18 +40,46 @@ private:
     
     // Store performance data
     unordered_map<string, vector<double>> performanceData;
+    unordered_map<string, vector<BenchmarkSample>> benchmarkSamples;
+
+    BenchmarkRunner benchmarkRunner;
+    BenchmarkOptions benchmarkOptions;
+    BenchmarkStore benchmarkStore;
 
     using FilterFunction = string;
     unordered_map<char, FilterFunction> filterMap;
 
+    // Archival copies of the processed frames are written in the background, one at a time
+    bool archiveSnapshots = true;
+    future<void> pendingArchive;
+
+    // Single-filter requests still running on the pool
+    struct PendingFilter {
+        string filterName;
+        TaskFuture<pair<Mat, double>> result;
+    };
+    vector<PendingFilter> pendingFilters;
+    string benchmarkInput; // Description of the frame the last benchmark ran on
+
+    // What the performance plot shows; 'y' cycles through the views
+    enum class PlotMode { Time, Speedup, Efficiency, ScalingFit };
+    PlotMode plotMode = PlotMode::Time;
+    string lastVisualization = "all";
+
     void setupFilterMap();
     void setupVisualization(const string& filterType = "all");
     void performThreadingTest(const Mat& snapshot, const string& filterName);
     bool processFilter(const Mat& frame, const string& filterName);
     void handleFilterCase(char key, const Mat& frame);
-    Mat loadSnapshot(const string& filename);
+    void showFinishedFilters();
+    void archiveSnapshot(const Mat& frame);
+    string describeFrame(const Mat& frame) const;
     void generatePerformanceGraph();
     void handleVisualizationRequest(const string& filterType = "all");
+    void cyclePlotMode();
+    void applyPlotMode();
+    unordered_map<string, vector<double>> plotDataFor(const unordered_map<string, vector<double>>& timings) const;
+    void reportScalingFits(const unordered_map<string, vector<double>>& timings);
     Scalar getColorForFilter(const string& filterName);
     void showPerformanceStats(const string& filterName, const vector<double>& times);
 };
@@ -0,0 +1,66 @@
+#ifndef LATENCY_GOVERNOR_HPP
+#define LATENCY_GOVERNOR_HPP
+
+#include <string>
+#include <unordered_map>
+#include <array>
+#include <mutex>
+#include <cstdint>
+
+using namespace std;
+
+// Quality steps, from full quality to not processing the frame at all
+enum class DegradationLevel {
+    None = 0,               // Full resolution, full kernel
+    ReducedKernel = 1,      // Smaller kernel or search window
+    ReducedResolution = 2,  // Half resolution, upscaled afterwards
+    SkipFrame = 3           // Frame is not processed
+};
+
+struct DegradationDecision {
+    DegradationLevel level = DegradationLevel::None;
+    double estimateUs = 0;  // Expected processing time at the chosen level
+    double deadlineUs = 0;
+};
+
+// Keeps a rolling latency estimate per filter and quality level, and picks the best quality
+// that is expected to meet the per-frame deadline
+class LatencyGovernor {
+public:
+    LatencyGovernor(double deadlineMs = 33.0, double smoothing = 0.2);
+
+    void setDeadline(double deadlineMs);
+    double getDeadlineMs() const;
+    void setLogging(bool enabled) { logDecisions = enabled; }
+
+    DegradationDecision decide(const string& filterName, bool canReduceKernel, bool canReduceResolution);
+    void record(const string& filterName, DegradationLevel level, double durationUs);
+
+    uint64_t getDecisionCount(DegradationLevel level) const;
+    uint64_t getTotalDecisions() const;
+    void printSummary() const;
+
+    static string levelName(DegradationLevel level);
+
+private:
+    static constexpr int NUM_LEVELS = 4;
+    static constexpr int PROBE_INTERVAL = 30;       // Frames between attempts to move back up a level
+    static constexpr double UPGRADE_MARGIN = 0.8;   // Only move up when comfortably inside the deadline
+
+    struct FilterState {
+        array<double, NUM_LEVELS> estimateUs{};     // 0 while no sample exists
+        DegradationLevel current = DegradationLevel::None;
+        uint64_t frameIndex = 0;
+    };
+
+    double deadlineUs;
+    double smoothing;
+    bool logDecisions = true;
+    unordered_map<string, FilterState> filters;
+    array<uint64_t, NUM_LEVELS> decisionCounts{};
+    mutable mutex governorMutex;
+
+    double estimateFor(const FilterState& state, DegradationLevel level) const;
+};
+
+#endif // LATENCY_GOVERNOR_HPP
@@ -9,7 +9,7 @@ using namespace cv;
 
 class MedianFilter {
 public:
-    MedianFilter(int size = 3);  // Constructor with default kernel size
+    MedianFilter(int size = 3, int minimumSize = 9);  // Constructor; sizes below minimumSize are raised to it
     ~MedianFilter(); // Destructor
 
     void setKernelSize(int size); // Update kernel size
@@ -19,6 +19,7 @@ public:
 
 private:
     int kernelSize;
+    int minimumKernelSize;
     string windowName = "Median Filter"; // Window name for display
 };
 
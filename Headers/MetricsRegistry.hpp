@@ -0,0 +1,108 @@
+#ifndef METRICS_REGISTRY_HPP
+#define METRICS_REGISTRY_HPP
+
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <array>
+#include <thread>
+#include <condition_variable>
+#include <cstdint>
+
+using namespace std;
+
+// Monotonically increasing count
+class Counter {
+public:
+    void increment(uint64_t amount = 1) { value.fetch_add(amount, memory_order_relaxed); }
+    uint64_t get() const { return value.load(memory_order_relaxed); }
+
+private:
+    atomic<uint64_t> value{0};
+};
+
+// Value that can go up and down
+class Gauge {
+public:
+    void set(double newValue) { value.store(newValue, memory_order_relaxed); }
+    double get() const { return value.load(memory_order_relaxed); }
+
+private:
+    atomic<double> value{0.0};
+};
+
+// HDR-style histogram: each power of two is split into 16 linear sub-buckets, so any recorded
+// value is reported within 6.25%. Recording is lock-free and allocation-free.
+class LatencyHistogram {
+public:
+    void record(double valueUs);
+    double percentile(double p) const;     // p in [0, 100]
+    uint64_t count() const { return total.load(memory_order_relaxed); }
+    double sum() const { return sumUs.load(memory_order_relaxed); }
+
+private:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int NUM_BUCKETS = 64 * SUB_BUCKETS;
+
+    array<atomic<uint64_t>, NUM_BUCKETS> buckets{};
+    atomic<uint64_t> total{0};
+    atomic<double> sumUs{0.0};
+
+    static int bucketIndex(uint64_t value);
+    static double bucketValue(int index);
+};
+
+// Named metrics shared by the whole process. Names may carry Prometheus labels,
+// e.g. cpmulti_filter_latency_us{filter="gaussian"}; returned references stay valid.
+class MetricsRegistry {
+public:
+    static MetricsRegistry& instance();
+
+    Counter& counter(const string& name, const string& help = "");
+    Gauge& gauge(const string& name, const string& help = "");
+    LatencyHistogram& histogram(const string& name, const string& help = "");
+
+    string renderPrometheus() const; // Prometheus text exposition format
+
+    // family{label="value"}, with \, " and newlines in the value escaped as the text format requires
+    static string labelled(const string& family, const string& label, const string& value);
+
+private:
+    MetricsRegistry() = default;
+
+    map<string, unique_ptr<Counter>> counters;
+    map<string, unique_ptr<Gauge>> gauges;
+    map<string, unique_ptr<LatencyHistogram>> histograms;
+    map<string, string> helpTexts;      // Keyed by family name, without labels
+    mutable mutex registryMutex;
+
+    void rememberHelp(const string& name, const string& help);
+};
+
+// Periodically writes the registry to a Prometheus text file, e.g. for node_exporter's textfile collector
+class MetricsExporter {
+public:
+    MetricsExporter(const string& path, int intervalMs = 5000);
+    ~MetricsExporter();
+
+    // The writer thread holds this; construct the exporter where it is used
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+    MetricsExporter(MetricsExporter&&) = delete;
+    MetricsExporter& operator=(MetricsExporter&&) = delete;
+
+    bool flush() const;
+
+private:
+    string path;
+    int intervalMs;
+    thread writer;
+    mutex stopMutex;
+    condition_variable stopCondition;
+    bool stopping = false;
+};
+
+#endif // METRICS_REGISTRY_HPP
@@ -0,0 +1,103 @@
+#ifndef MULTI_STREAM_PROCESSOR_HPP
+#define MULTI_STREAM_PROCESSOR_HPP
+
+#include <opencv2/opencv.hpp>
+#include "Headers/MultiThreadImageProcessor.hpp"
+#include "Headers/NativeCapture.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+using namespace cv;
+using namespace std;
+
+// Settings of one camera feed or video file
+struct StreamConfig {
+    string name;
+    string source = "0";            // Camera index or video file path
+    string filterName = "gaussian";
+    int priority = 1;               // Relative share of the thread budget
+    double latencyBudgetMs = 100;   // Frames waiting longer than this are dropped; also the processing deadline
+    int numThreads = 0;             // Threads per frame, 0 splits the budget between streams
+    bool incremental = false;       // Re-filter only the blocks that changed since the previous frame
+    IncrementalOptions incrementalOptions;
+    bool nativeFormat = false;      // Capture the camera's NV12 or YUYV frames and convert to BGR only for colour filters
+};
+
+struct StreamStats {
+    uint64_t framesCaptured = 0;
+    uint64_t framesProcessed = 0;
+    uint64_t framesDropped = 0;     // Overwritten by a newer frame, over the latency budget or skipped
+    uint64_t framesDegraded = 0;    // Processed with a reduced kernel or resolution
+    double lastLatencyMs = 0;       // Capture to processed output
+    double averageLatencyMs = 0;
+    double averageFilteredFraction = 0; // Share of each frame filtered again; 1 without change gating
+};
+
+// Feeds several sources into one shared processor. Frames are scheduled onto the processor's
+// pool with weighted fair queuing and filtered there, so filtering uses at most the pool's
+// threadBudget - 1 workers. Other callers of the same processor run on top of that.
+class MultiStreamProcessor {
+public:
+    MultiStreamProcessor(MultiThreadImageProcessor& processor, int maxFramesInFlight = 0);
+    ~MultiStreamProcessor();
+
+    int addStream(const StreamConfig& config); // Returns the stream id, -1 if the source cannot be opened
+    void start();
+    void stop();
+    bool isRunning() const { return running; }
+
+    bool getLatestOutput(int streamId, Mat& output); // True when a new output is available
+    StreamStats getStats(int streamId) const;
+    StreamConfig getConfig(int streamId) const;
+    const LatencyGovernor& getGovernor(int streamId) const { return streams.at(streamId)->governor; }
+    size_t getStreamCount() const;
+
+private:
+    using Clock = chrono::steady_clock;
+
+    struct Stream {
+        StreamConfig config;
+        NativeCapture capture;
+        PixelFormat format = PixelFormat::BGR;
+        thread captureThread;
+
+        Mat pendingFrame;
+        Clock::time_point pendingSince;
+        bool hasPending = false;
+        bool inFlight = false;      // One frame per stream at a time keeps outputs in order
+        double virtualTime = 0;     // Weighted service received, used for fair scheduling
+
+        Mat latestOutput;
+        bool hasNewOutput = false;
+        StreamStats stats;
+        LatencyGovernor governor;   // Degrades quality when processing would miss the budget
+        IncrementalState incrementalState;  // Previous frame of an incremental stream
+
+        // Live metrics, labelled with the stream name
+        Counter* capturedCounter = nullptr;
+        Counter* droppedCounter = nullptr;
+        Counter* degradedCounter = nullptr;
+        LatencyHistogram* latencyHistogram = nullptr;
+    };
+
+    MultiThreadImageProcessor& processor;
+    vector<unique_ptr<Stream>> streams;
+    mutable mutex streamsMutex;
+    condition_variable idleCondition;
+    atomic<bool> running{false};
+    int framesInFlight = 0;
+    int maxFramesInFlight;
+    Gauge& framesInFlightGauge;
+
+    void captureLoop(int streamId);
+    void scheduleLocked();
+    void processFrame(int streamId, Mat frame, Clock::time_point capturedAt);
+};
+
+#endif // MULTI_STREAM_PROCESSOR_HPP
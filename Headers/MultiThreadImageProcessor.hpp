@@ -4,40 +4,237 @@
 #include <opencv2/opencv.hpp>
 #include <unordered_map>
 #include <string>
+#include <atomic>
+#include <functional>
 #include "Headers/GreyScaleFilter.hpp"
 #include "Headers/GaussianFilter.hpp"
 #include "Headers/MedianFilter.hpp"
 #include "Headers/DenoisingFilter.hpp"
+#include "Headers/GuidedFilter.hpp"
 #include "Headers/CannyFilter.hpp"
 #include "Headers/SobelFilter.hpp"
 #include "Headers/FourierFilter.hpp"
 #include "Headers/ResizeRotateFilter.hpp"
+#include "Headers/ThreadPool.hpp"
+#include "Headers/LatencyGovernor.hpp"
+#include "Headers/TraceRecorder.hpp"
+#include "Headers/MetricsRegistry.hpp"
+#include "Headers/CpuTopology.hpp"
+#include "Headers/ResultCache.hpp"
+#include "Headers/FrameContext.hpp"
 
 using namespace std;
 using namespace cv;
 
+// How a frame is split between workers
+enum class ParallelPolicy {
+    Sequential,     // Whole frame on the calling thread
+    Strips,         // One horizontal strip per thread
+    Tiles           // Square tiles pulled from a shared queue by every thread
+};
+
+// Per-call execution settings. Callers pass their own copy, so concurrent calls never share mutable state.
+struct ExecutionOptions {
+    int numThreads = 1;
+    ParallelPolicy policy = ParallelPolicy::Strips;
+    int overlap = 10;       // Halo in pixels around each strip or tile
+    int tileSize = 128;     // Tile edge in pixels for ParallelPolicy::Tiles
+    bool localCopy = false; // Filter a copy of each padded unit made by its worker, so reads stay on the worker's NUMA node
+};
+
+// What the scheduler is allowed to do with a filter
+struct FilterCapabilities {
+    bool stripParallel = true;  // Output pixels depend only on a bounded input neighbourhood
+    bool preservesSize = true;  // Output has the same dimensions as the input
+    int halo = 0;               // Minimum overlap needed for seam-free stitching
+};
+
+// Change-gated processing of a mostly static feed
+struct IncrementalOptions {
+    int blockSize = 64;             // Edge of a change-detection block in pixels
+    int pixelThreshold = 12;        // A pixel changed when one of its channels moved by more than this
+    int minChangedPixels = 4;       // A block is dirty when more pixels than this changed, which ignores sensor noise
+    int refreshInterval = 30;       // Full refresh every N frames; 0 only refreshes when needed
+    double maxDirtyFraction = 0.6;  // Beyond this share of dirty blocks one full pass is cheaper
+};
+
+// Input and output of the previous frame of one feed. Owned by the caller, one per feed, and
+// reset automatically when the filter, frame size or type changes.
+struct IncrementalState {
+    string filterName;
+    Mat referenceInput;     // Input the cached output was computed from
+    Mat cachedOutput;
+    int framesSinceRefresh = 0;
+};
+
+struct IncrementalStats {
+    int dirtyBlocks = 0;
+    int totalBlocks = 0;
+    bool fullRefresh = false;
+    double filteredFraction = 0;    // Share of the frame's pixels that were filtered again
+};
+
+// One unit of work handed out by the scheduler, as it actually ran
+struct StripRecord {
+    Rect region;            // Part of the output image written by this unit
+    int worker = 0;         // Index of the worker that processed it
+    double startUs = 0;     // Start time relative to the beginning of the run
+    double durationUs = 0;  // Time spent filtering this unit
+};
+
+// Scheduling trace of a single filter run
+struct ScheduleTrace {
+    vector<StripRecord> strips;
+    int numThreads = 0;
+    double totalUs = 0;
+};
+
+// One frame of a batch, as it ran
+struct BatchFrameResult {
+    Mat output;
+    double startUs = 0;     // Start of its first unit, relative to the beginning of the batch
+    double durationUs = 0;  // From its first unit starting to its last unit finishing
+};
+
+// Outputs and timings of a batch, in the order of its frames
+struct BatchResult {
+    vector<BatchFrameResult> frames;
+    double totalUs = 0;
+    double framesPerSecond = 0;
+    double megapixelsPerSecond = 0;
+};
+
 class MultiThreadImageProcessor {
 public:
-    MultiThreadImageProcessor(int numThreads = 4);
+    MultiThreadImageProcessor(int numThreads = 4, int threadBudget = 0, const AffinityOptions& affinity = AffinityOptions());
     ~MultiThreadImageProcessor();
 
+    // applyFilter and applyFilterAdaptive reuse cached results when the result cache is enabled;
+    // applyFilterTimed and the sequential and incremental paths always filter
     Mat applyFilter(const string& filterName, const Mat& inputImage);
-    pair<Mat, double> applyFilterTimed(const string& filterName, const Mat& inputImage);
-    unordered_map<string, Mat> applyAllFiltersWithCutLines(const Mat& inputImage);
+    Mat applyFilter(const string& filterName, const Mat& inputImage, const ExecutionOptions& options);
+    pair<Mat, double> applyFilterTimed(const string& filterName, const Mat& inputImage, ScheduleTrace* trace = nullptr);
+    pair<Mat, double> applyFilterTimed(const string& filterName, const Mat& inputImage, const ExecutionOptions& options, ScheduleTrace* trace = nullptr);
+    // Meet a per-frame deadline by degrading quality when the governor's estimate exceeds it.
+    // Returns an empty Mat when the frame is skipped.
+    pair<Mat, double> applyFilterAdaptive(const string& filterName, const Mat& inputImage, const ExecutionOptions& options,
+                                          LatencyGovernor& governor, DegradationDecision* decision = nullptr);
+    // Re-filter only the blocks that changed since the previous frame, plus their halo, and patch
+    // them into the cached output. Non-stitchable filters always run on the whole frame.
+    pair<Mat, double> applyFilterIncremental(const string& filterName, const Mat& inputImage, const ExecutionOptions& options,
+                                             IncrementalState& state, const IncrementalOptions& incremental = IncrementalOptions(),
+                                             IncrementalStats* stats = nullptr);
+    // Filters that start from the grey plane or its gradients take them from the frame's context, so
+    // several filters applied to one frame convert and differentiate it only once. A camera-native
+    // frame is converted to BGR only for filters that need colour.
+    Mat applyFilter(const string& filterName, FrameContext& context, const ExecutionOptions& options);
+    pair<Mat, double> applyFilterTimed(const string& filterName, FrameContext& context, const ExecutionOptions& options, ScheduleTrace* trace = nullptr);
+    pair<Mat, double> applyFilterAdaptive(const string& filterName, FrameContext& context, const ExecutionOptions& options,
+                                          LatencyGovernor& governor, DegradationDecision* decision = nullptr);
+    unordered_map<string, Mat> applyAllFiltersWithCutLines(const Mat& inputImage, int visualThreads = 0);
+    unordered_map<string, Mat> applyAllFiltersWithCutLines(const Mat& inputImage, const ExecutionOptions& options);
     pair<Mat, double> sequentialFilter(const string& filterName, const Mat& inputImage);
 
+    // Many frames per call, for offline jobs. The filters are looked up and the options resolved once,
+    // and the units of every frame go through one parallelFor: workers move on to the next frame
+    // without a join, and their scratch buffers stay warm. A chain applies its filters in turn; it is
+    // split into strips or tiles, with the sum of their halos, only when every filter can be stitched,
+    // and otherwise runs whole frames in parallel. Frames may differ in size; an empty one gives an empty output.
+    BatchResult applyFilterBatch(const string& filterName, const vector<Mat>& frames, const ExecutionOptions& options);
+    BatchResult applyChainBatch(const vector<string>& chain, const vector<Mat>& frames, const ExecutionOptions& options);
+
+    // Non-blocking variants: the call runs on the pool and its future is ready once every strip has
+    // joined, so the UI keeps running and capture of the next frame can overlap this one. The input
+    // is shared, not copied, and must not be written until the future is ready.
+    TaskFuture<Mat> submitFilter(const string& filterName, const Mat& inputImage, const ExecutionOptions& options);
+    TaskFuture<pair<Mat, double>> submitFilterTimed(const string& filterName, const Mat& inputImage, const ExecutionOptions& options);
+    TaskFuture<pair<Mat, double>> submitSequential(const string& filterName, const Mat& inputImage);
+
+    // Default options used by the overloads without an ExecutionOptions argument
     void setNumThreads(int numThreads);
     int getNumThreads() const;
+    ExecutionOptions getDefaultOptions() const;
+
+    bool hasFilter(const string& filterName) const;
+    // The filter to run when the output is written to an image or video file: an 8-bit variant
+    // with the same content where one exists ("fourier" gives "fourier8"), else filterName itself
+    string getSavableFilter(const string& filterName) const;
+    FilterCapabilities getCapabilities(const string& filterName) const;
+    vector<string> getFilterNames() const;
+
+    // Every call shares one pool of threadBudget - 1 workers. A call from outside the pool also
+    // works on its own thread, so each concurrent outside caller adds one thread to the budget.
+    int getThreadBudget() const { return threadBudget; }
+    ThreadPool& getThreadPool() { return threadPool; }
+
+    // Pool workers are pinned per the affinity policy; capture and display threads belong on getIoCpus()
+    const AffinityOptions& getAffinity() const { return affinity; }
+    vector<int> getIoCpus() const;
+
+    // Results keyed by input content; disabled until given a capacity
+    ResultCache& getResultCache() { return resultCache; }
 
 private:
-    int numThreads;
+    // Filter implementation and its scheduling constraints
+    struct FilterEntry {
+        function<Mat(const Mat&)> apply;
+        FilterCapabilities capabilities;
+        function<Mat(const Mat&)> reducedApply = nullptr;    // Cheaper variant with a smaller kernel, if the filter has one
+        // Same filter on a region of a frame's shared planes, for filters that derive any, and the
+        // derivation of those planes, which runs before the frame is split so every worker helps
+        function<Mat(FrameContext&, const Rect&)> applyInContext = nullptr;
+        function<void(FrameContext&)> prepareContext = nullptr;
+    };
+
+    atomic<int> numThreads;
     const Scalar YELLOW_COLOR;
+    int threadBudget;
+    AffinityOptions affinity;
+    ThreadPool threadPool;
+    ResultCache resultCache;
+
+    // Map for dynamically selecting filters; only written by the constructor
+    unordered_map<string, FilterEntry> filterMap;
+
+    // Submitted calls still running; the destructor waits for them, since they use the filter map
+    mutex submitMutex;
+    condition_variable submitCondition;
+    int submissionsInFlight = 0;
+
+    template <class F>
+    auto submitTracked(F work) -> TaskFuture<decay_t<invoke_result_t<F>>> {
+        {
+            lock_guard<mutex> lock(submitMutex);
+            submissionsInFlight++;
+        }
+        return threadPool.submit([this, work]() mutable {
+            // Counted out even when the work throws
+            struct Finished {
+                MultiThreadImageProcessor* processor;
+                ~Finished() { processor->finishSubmission(); }
+            } finished{this};
+            return work();
+        });
+    }
+    void finishSubmission();
+
+    ExecutionOptions resolveOptions(const FilterEntry& filter, const ExecutionOptions& options) const;
+    Mat filterCached(const string& filterName, const Mat& inputImage, FrameContext* context, const ExecutionOptions& options);
+    pair<Mat, double> filterTimed(const string& filterName, const Mat& inputImage, FrameContext* context, const ExecutionOptions& options, ScheduleTrace* trace);
+    pair<Mat, double> filterAdaptive(const string& filterName, const Mat& inputImage, FrameContext* context, const ExecutionOptions& options,
+                                     LatencyGovernor& governor, DegradationDecision* decision);
+    pair<Mat, double> processFilter(const Mat& inputImage, const FilterEntry& filter, const ExecutionOptions& options, ScheduleTrace* trace,
+                                    FrameContext* context = nullptr);
+    vector<Rect> splitWork(const Size& imageSize, const ExecutionOptions& options) const;
+    Mat filterRegion(const Mat& inputImage, const FilterEntry& filter, const Rect& region, int overlap, const ExecutionOptions& options,
+                     FrameContext* context = nullptr) const;
 
-    // Map for dynamically selecting filters
-    unordered_map<string, function<Mat(const Mat&)>> filterMap;
+    Mat filterChainRegion(const Mat& inputImage, const vector<const FilterEntry*>& chain, const Rect& region, int overlap,
+                          const ExecutionOptions& options) const;
 
-    template<typename FilterType>
-    pair<Mat, double> processFilter(const Mat& inputImage, FilterType& filter);
+    void drawScheduleOverlay(Mat& image, const ScheduleTrace& trace) const;
+    void recordMetrics(const string& filterName, double durationUs) const;
+    string cacheId(const string& filterName, const string& variant, const ExecutionOptions& resolved, const Size& imageSize) const;
 };
 
 #endif // MULTITHREAD_IMAGE_PROCESSOR_HPP
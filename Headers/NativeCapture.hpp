@@ -0,0 +1,47 @@
+#ifndef NATIVE_CAPTURE_HPP
+#define NATIVE_CAPTURE_HPP
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <fstream>
+#include "Headers/FrameContext.hpp"
+#include "Headers/FrameRecording.hpp"
+
+using namespace cv;
+using namespace std;
+
+// Frame source that can hand out frames in the camera's own pixel format instead of BGR.
+// Sources are a camera index, a video file or URL, or a raw recording "<path>.nv12:<width>x<height>"
+// (or .yuyv) that stands in for a camera delivering that format, or a .cpraw recording, whose
+// frames are handed out as views of the mapped file in the format they were recorded in.
+// Cameras whose format cannot be read natively, and video files, fall back to BGR.
+class NativeCapture {
+public:
+    NativeCapture() = default;
+    ~NativeCapture();
+
+    bool open(const string& source, bool native = true);
+    bool read(Mat& frame);          // One frame in format()
+    bool isOpened() const;
+    void release();
+
+    PixelFormat format() const { return pixelFormat; }
+    Size frameSize() const { return size; }
+    double fps() const;
+
+    // BGR frame in a native layout, for raw recordings and tests
+    static Mat encode(const Mat& bgr, PixelFormat format);
+
+private:
+    VideoCapture capture;
+    ifstream rawFile;
+    MappedRecording recording;
+    size_t recordingIndex = 0;
+    PixelFormat pixelFormat = PixelFormat::BGR;
+    Size size;
+
+    bool openRawFile(const string& source);
+    bool normalizeRaw(Mat& frame) const;
+};
+
+#endif // NATIVE_CAPTURE_HPP
@@ -0,0 +1,51 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+
+// Hardware counter totals over one measurement, summed over every thread of the process
+struct CounterSample {
+    bool valid = false;
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t llcMisses = 0;         // Last-level cache misses
+    uint64_t branchMisses = 0;
+
+    double ipc() const { return cycles ? static_cast<double>(instructions) / cycles : 0.0; }
+};
+
+// Reads Linux perf_event_open counters for all threads alive when start() is called.
+// The processor's workers are persistent, so they are all covered. Where counters are
+// unavailable (other OS, perf_event_paranoid, VMs without a PMU) isAvailable() is false
+// and stop() returns an invalid sample. A sample is also invalid when any thread's
+// counters could not be opened or read, since its totals would silently leave work out.
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    bool isAvailable() const { return available; }
+    const string& getUnavailableReason() const { return unavailableReason; }
+
+    void start();
+    CounterSample stop();
+
+    static constexpr int CACHE_LINE_BYTES = 64;
+
+private:
+    static constexpr int NUM_EVENTS = 4;
+
+    bool available = false;
+    string unavailableReason;
+    vector<int> descriptors;        // NUM_EVENTS per thread
+    bool incomplete = false;        // A counter of a live thread failed to open or read
+    bool warnedIncomplete = false;
+
+    void closeAll();
+};
+
+#endif // PERF_COUNTERS_HPP
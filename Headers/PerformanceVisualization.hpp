@@ -8,6 +8,11 @@
 #include <numeric>
 #include <iomanip>
 #include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <deque>
 
 using namespace cv;
 using namespace std;
@@ -25,7 +30,20 @@ public:
         double fontSize = 0.6;
         string title = "Filter Performance vs Thread Count";
         string xLabel = "Number of Threads";
-        string yLabel = "Processing Time (ms)";
+        string yLabel = "Processing Time";
+        string yUnit = "(x1000 us)";
+        double yScaleDivisor = 1000;    // Axis ticks and legend averages are divided by this
+        string valueSuffix = "k";       // Appended to legend averages
+        bool showValues = true;         // Label every point with its value
+        int valuePrecision = 0;         // Decimals of tick and point labels
+        int xTickCount = 10;
+        int xTickStart = 1;
+        int xTickStep = 1;
+        vector<string> xTickLabels;     // Replaces the numeric tick labels when set
+        int xPoints = 0;                // Fixed number of X positions, 0 spreads the samples over the axis
+        bool rightAlign = false;        // With xPoints, shorter series end at the right edge (live charts)
+        string windowName = "Performance Analysis";
+        string outputName = "performance_plot.png";     // Written to the resources path, empty to skip
         bool showLegend = true;
         bool showGrid = true;
         vector<Scalar> colors = {
@@ -40,20 +58,48 @@ public:
         };
     };
 
-    PerformanceVisualization(const string& resPath = "../resources") 
-        : resourcesPath(resPath) {}
+    PerformanceVisualization(const string& resPath = "../resources");
+    ~PerformanceVisualization();
     
     void setConfig(const PlotConfig& config) { plotConfig = config; }
     PlotConfig& getConfig() { return plotConfig; }
     void setResourcePath(const string& path) { resourcesPath = path; }
     
+    // Queue a redraw on the render thread, which also writes the PNG. A request for the same
+    // output that has not started yet is replaced by the newer one, so callers can submit as often as they like.
     void plotPerformance(const unordered_map<string, vector<double>>& performanceData);
+    // Show the newest finished plot of every window. HighGUI must be driven from the UI thread, so it polls this.
+    bool showLatestPlot();
 
 private:
-    PlotConfig plotConfig;
-    Mat plotImage;
+    struct RenderJob {
+        PlotConfig config;
+        unordered_map<string, vector<double>> data;
+        string outputPath;
+    };
+
+    PlotConfig plotConfig;      // Edited by the caller
     string resourcesPath;
 
+    // Only touched by the render thread
+    PlotConfig renderConfig;
+    Mat plotImage;
+    Mat staticLayer;            // Grid, axes, labels and title, reused while they stay the same
+    string staticLayerKey;
+
+    thread renderThread;
+    mutex renderMutex;
+    condition_variable renderCondition;
+    deque<unique_ptr<RenderJob>> pendingJobs;
+    bool stopping = false;
+    unordered_map<string, Mat> latestPlots;    // Newest finished plot of each window, not yet shown
+
+    void renderLoop();
+    Mat render(const RenderJob& job);
+    void drawStaticLayer(double maxScaleValue, int plotWidth, int canvasWidth);
+    void drawSeries(const unordered_map<string, vector<double>>& performanceData, double maxScaleValue, int plotWidth);
+    static double niceScale(double maxValue);
+
     void drawGrid(int plotWidth);
     void drawAxes(double maxTime, int plotWidth);
     
@@ -64,7 +110,7 @@ private:
     void drawLegendOutsideGraph(const unordered_map<string, vector<double>>& performanceData, int originalWidth);
     
     int getXCoordinate(int index, size_t totalPoints, int plotWidth);
-    int getYCoordinate(double value, double maxValue);
+    int getYCoordinate(double value, double maxScaleValue);
 };
 
 #endif // PERFORMANCE_VISUALIZATION_HPP
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef RESULT_CACHE_HPP
+#define RESULT_CACHE_HPP
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <atomic>
+#include "Headers/MetricsRegistry.hpp"
+
+using namespace std;
+using namespace cv;
+
+// Identifies one filter result: what was filtered and every setting that changes the output
+struct CacheKey {
+    uint64_t contentHash = 0;   // Pixels of the input
+    Size size;
+    int type = 0;
+    string filterId;            // Filter name, parameter variant and stitching layout
+
+    bool operator==(const CacheKey& other) const {
+        return contentHash == other.contentHash && size == other.size && type == other.type && filterId == other.filterId;
+    }
+};
+
+struct CacheKeyHash {
+    size_t operator()(const CacheKey& key) const { return static_cast<size_t>(key.contentHash ^ hash<string>()(key.filterId)); }
+};
+
+// Filter outputs of recently seen frames, bounded in bytes and evicted least recently used first.
+// Thread-safe. A capacity of 0 disables the cache; lookups then always miss without hashing.
+class ResultCache {
+public:
+    ResultCache(size_t capacityBytes = 0);
+
+    void setCapacity(size_t capacityBytes);
+    size_t getCapacity() const;
+    bool isEnabled() const { return getCapacity() > 0; }
+
+    static uint64_t hashImage(const Mat& image);   // Content hash of the pixels, independent of the row stride
+    static CacheKey makeKey(const Mat& input, const string& filterId);
+
+    bool lookup(const CacheKey& key, Mat& output); // Output is the caller's own copy
+    void insert(const CacheKey& key, const Mat& output);
+    void clear();
+
+    size_t sizeBytes() const;
+    size_t entryCount() const;
+    uint64_t hits() const { return hitCount.load(); }
+    uint64_t misses() const { return missCount.load(); }
+
+private:
+    struct Entry {
+        CacheKey key;
+        Mat output;
+        size_t bytes = 0;
+    };
+
+    mutable mutex cacheMutex;
+    size_t capacity;
+    size_t usedBytes = 0;
+    list<Entry> entries;                                            // Most recently used first
+    unordered_map<CacheKey, list<Entry>::iterator, CacheKeyHash> index;
+
+    atomic<uint64_t> hitCount{0};
+    atomic<uint64_t> missCount{0};
+
+    // Process-wide metrics, shared by every cache
+    Counter& hitCounter;
+    Counter& missCounter;
+    Counter& evictionCounter;
+    Gauge& bytesGauge;
+
+    void evictLocked();
+};
+
+#endif // RESULT_CACHE_HPP
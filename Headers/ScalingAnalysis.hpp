@@ -0,0 +1,37 @@
+#ifndef SCALING_ANALYSIS_HPP
+#define SCALING_ANALYSIS_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+using namespace std;
+
+// Scalability models fitted to one filter's thread sweep
+struct ScalingFit {
+    string filterName;
+    double amdahlSerial = 0;    // Serial fraction s: S(N) = 1 / (s + (1 - s) / N)
+    double amdahlRmse = 0;
+    double uslSigma = 0;        // Contention: S(N) = N / (1 + sigma (N - 1) + kappa N (N - 1))
+    double uslKappa = 0;        // Coherency (crosstalk) cost
+    double uslRmse = 0;
+    double peakThreads = 0;     // Thread count where the USL curve peaks, infinite when kappa is 0, NaN when sigma >= 1
+    double peakSpeedup = 0;     // NaN when there is no peak
+    double maxSpeedup = 0;      // Amdahl's limit 1 / s
+};
+
+// Speedup, efficiency and model fits for timings indexed by thread count - 1, like performanceData
+class ScalingAnalysis {
+public:
+    static vector<double> speedup(const vector<double>& times);
+    static vector<double> efficiency(const vector<double>& times);
+
+    static ScalingFit fit(const string& filterName, const vector<double>& times);
+    static double amdahlSpeedup(double serialFraction, double threads);
+    static double uslSpeedup(double sigma, double kappa, double threads);
+
+    static void printFits(const vector<ScalingFit>& fits);
+    static bool writeCsv(const string& path, const vector<ScalingFit>& fits);
+};
+
+#endif // SCALING_ANALYSIS_HPP
@@ -2,6 +2,8 @@
 #define SOBELFILTER_HPP
 
 #include <opencv2/opencv.hpp>
+#include "Headers/ImageKernels.hpp"
+#include "Headers/FrameContext.hpp"
 #include <string>
 #include <iostream>
 
@@ -18,6 +20,8 @@ public:
     void setKernelSize(int ksize);
 
     Mat applyFilter(const Mat& inputFrame);
+    // Reuses the frame's shared gradients for first-order 3x3 kernels
+    Mat applyFilter(FrameContext& context, const Rect& region);
 
     string getWindowName() const { return windowName; }
 
@@ -0,0 +1,28 @@
+#ifndef SYNTHETIC_CONTENT_HPP
+#define SYNTHETIC_CONTENT_HPP
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+using namespace cv;
+using namespace std;
+
+// Kinds of generated test images, chosen to stress filters differently
+enum class ContentClass {
+    Flat,       // Uniform grey, no edges or texture
+    Noise,      // Independent uniform noise per pixel and channel
+    Natural,    // 1/f-like multi-octave noise, smooth regions with soft edges
+    HighEdge    // Fine checkerboard crossed by many thin lines
+};
+
+// Deterministic test images for resolution and content sweeps
+class SyntheticContent {
+public:
+    static Mat generate(const Size& size, ContentClass content, uint64_t seed = 42);
+    static string name(ContentClass content);
+    static vector<ContentClass> all();
+};
+
+#endif // SYNTHETIC_CONTENT_HPP
@@ -0,0 +1,163 @@
+#ifndef TASK_FUTURE_HPP
+#define TASK_FUTURE_HPP
+
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define CPMULTI_HAS_COROUTINES 1
+#endif
+
+using namespace std;
+
+// Shared between the work and every future of its result; work without a result stores nothing
+template <class T>
+struct TaskState {
+    using Stored = conditional_t<is_void_v<T>, bool, T>;
+
+    mutex stateMutex;
+    condition_variable readyCondition;
+    bool ready = false;
+    Stored value{};
+    exception_ptr error;
+    vector<function<void()>> continuations;
+
+    void complete() {
+        vector<function<void()>> pending;
+        {
+            lock_guard<mutex> lock(stateMutex);
+            ready = true;
+            pending.swap(continuations);
+        }
+        readyCondition.notify_all();
+        for (auto& continuation : pending) {
+            continuation();
+        }
+    }
+};
+
+// Run work() and publish its result or exception to state
+template <class T, class F>
+void fulfil(TaskState<T>& state, F& work) {
+    try {
+        if constexpr (is_void_v<T>) {
+            work();
+        } else {
+            state.value = work();
+        }
+    } catch (...) {
+        state.error = current_exception();
+    }
+    state.complete();
+}
+
+// Result of work running on the pool. Unlike std::future it can be read any number of times and
+// chained with then(); under C++20 it can also be co_awaited. Continuations and resumed coroutines
+// run on the thread that completes the work, or on the caller when the result is already there.
+// Blocking in get() from inside a pool task can starve the pool; chain with then() instead.
+// A TaskFuture<void> passes nothing to its continuations. Like std::future, using a default-
+// constructed future throws future_error(no_state).
+template <class T>
+class TaskFuture {
+    // Continuations take the result, or nothing when there is none
+    template <class F, class U = T>
+    struct ContinuationResult {
+        using type = decay_t<invoke_result_t<F, U>>;
+    };
+    template <class F>
+    struct ContinuationResult<F, void> {
+        using type = decay_t<invoke_result_t<F>>;
+    };
+
+public:
+    TaskFuture() = default;
+    explicit TaskFuture(shared_ptr<TaskState<T>> state) : state(move(state)) {}
+
+    bool valid() const { return static_cast<bool>(state); }
+
+    bool isReady() const {
+        requireState();
+        lock_guard<mutex> lock(state->stateMutex);
+        return state->ready;
+    }
+
+    void wait() const {
+        requireState();
+        unique_lock<mutex> lock(state->stateMutex);
+        state->readyCondition.wait(lock, [this]() { return state->ready; });
+    }
+
+    // Blocks until the work is done; rethrows what it threw
+    T get() const {
+        wait();
+        if (state->error) rethrow_exception(state->error);
+        if constexpr (!is_void_v<T>) {
+            return state->value;
+        }
+    }
+
+    // Runs continuation(value) once the work is done and returns the future of its result.
+    // An exception of this work or of the continuation is passed down the chain.
+    template <class F>
+    auto then(F continuation) const -> TaskFuture<typename ContinuationResult<F>::type> {
+        using Result = typename ContinuationResult<F>::type;
+        requireState();
+        auto next = make_shared<TaskState<Result>>();
+        auto source = state;
+        whenReady([source, next, continuation]() mutable {
+            if (source->error) {
+                next->error = source->error;
+                next->complete();
+                return;
+            }
+            auto work = [&]() -> Result {
+                if constexpr (is_void_v<T>) {
+                    return continuation();
+                } else {
+                    return continuation(source->value);
+                }
+            };
+            fulfil(*next, work);
+        });
+        return TaskFuture<Result>(next);
+    }
+
+#ifdef CPMULTI_HAS_COROUTINES
+    bool await_ready() const { return isReady(); }
+    bool await_suspend(coroutine_handle<> handle) const {
+        requireState();
+        lock_guard<mutex> lock(state->stateMutex);
+        if (state->ready) return false;     // Finished meanwhile; carry on without suspending
+        state->continuations.push_back([handle]() { handle.resume(); });
+        return true;
+    }
+    T await_resume() const { return get(); }
+#endif
+
+private:
+    shared_ptr<TaskState<T>> state;
+
+    void requireState() const {
+        if (!state) throw future_error(future_errc::no_state);
+    }
+
+    void whenReady(function<void()> continuation) const {
+        {
+            lock_guard<mutex> lock(state->stateMutex);
+            if (!state->ready) {
+                state->continuations.push_back(move(continuation));
+                return;
+            }
+        }
+        continuation();
+    }
+};
+
+#endif // TASK_FUTURE_HPP
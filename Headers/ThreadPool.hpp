@@ -0,0 +1,57 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <queue>
+#include <vector>
+#include <atomic>
+#include "Headers/MetricsRegistry.hpp"
+#include "Headers/TaskFuture.hpp"
+
+using namespace std;
+
+class ThreadPool {
+public:
+    // Worker i is pinned to workerCpus[i % size] when the list is not empty
+    ThreadPool(int numWorkers, const vector<int>& workerCpus = {});
+    ~ThreadPool();
+
+    void enqueue(function<void()> task); // Run a task on the next free worker
+
+    // Run work() on the next free worker; the future holds its result or exception
+    template <class F>
+    auto submit(F work) -> TaskFuture<decay_t<invoke_result_t<F>>> {
+        auto state = make_shared<TaskState<decay_t<invoke_result_t<F>>>>();
+        enqueue([state, work]() mutable { fulfil(*state, work); });
+        return TaskFuture<decay_t<invoke_result_t<F>>>(state);
+    }
+
+    // Run body(index, worker) for every index in [0, count) on at most maxWorkers threads.
+    // The calling thread takes part and never waits on a task that has not started, so
+    // it is safe to call from inside a pool task.
+    void parallelFor(size_t count, int maxWorkers, const function<void(size_t, int)>& body);
+
+    // A thread pinned away from the workers' CPUs passes false, so that its loops leave those
+    // CPUs to capture and display and run on the pool only. Never pass false from a pool task.
+    static void setCallerParticipates(bool participates);
+
+    int size() const { return static_cast<int>(workers.size()); }
+    size_t pendingTasks() const;
+    int pinnedWorkers() const { return pinned.load(); }
+
+private:
+    vector<thread> workers;
+    queue<function<void()>> tasks;
+    mutable mutex queueMutex;
+    condition_variable queueCondition;
+    bool stopping = false;
+    Gauge& queueDepth;              // Exported as cpmulti_pool_queue_depth
+    atomic<int> pinned{0};          // Workers whose affinity was applied
+
+    void workerLoop();
+};
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,86 @@
+#ifndef TRACE_RECORDER_HPP
+#define TRACE_RECORDER_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+using namespace std;
+
+// One completed begin/end pair
+struct TraceEvent {
+    char name[48];
+    const char* category;   // Must be a string literal
+    int64_t startNs;
+    int64_t durationNs;
+};
+
+// Collects events into per-thread ring buffers and exports them as Chrome trace JSON,
+// which chrome://tracing and Perfetto open directly. Recording is compiled in only when
+// CPMULTI_TRACING is defined (cmake -DCPMULTI_ENABLE_TRACING=ON); otherwise the macros
+// below expand to nothing.
+class TraceRecorder {
+public:
+    static TraceRecorder& instance();
+
+    void record(const char* name, const char* category, int64_t startNs, int64_t endNs);
+    void setThreadName(const string& name);
+    int64_t nowNs() const;
+
+    // Best called while the traced threads are idle; events still being written may be missed
+    bool writeChromeTrace(const string& path) const;
+    void clear();
+
+    static constexpr size_t EVENTS_PER_THREAD = 1 << 16;
+
+private:
+    struct ThreadBuffer {
+        vector<TraceEvent> events;
+        atomic<uint64_t> written{0};    // Total events ever written; the ring keeps the newest ones
+        int threadId = 0;
+        string threadName;
+    };
+
+    TraceRecorder();
+    ThreadBuffer& localBuffer();
+
+    chrono::steady_clock::time_point origin;
+    vector<shared_ptr<ThreadBuffer>> buffers;
+    mutable mutex buffersMutex;
+};
+
+// Records the lifetime of a scope as one trace event
+class TraceScope {
+public:
+    TraceScope(const char* scopeName, const char* category)
+        : category(category), startNs(TraceRecorder::instance().nowNs()) {
+        // Copied, so names built from temporary strings stay valid until the scope ends
+        strncpy(name, scopeName, sizeof(name) - 1);
+        name[sizeof(name) - 1] = '\0';
+    }
+    TraceScope(const string& scopeName, const char* category) : TraceScope(scopeName.c_str(), category) {}
+    ~TraceScope() { TraceRecorder::instance().record(name, category, startNs, TraceRecorder::instance().nowNs()); }
+
+private:
+    char name[sizeof(TraceEvent::name)];
+    const char* category;
+    int64_t startNs;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef CPMULTI_TRACING
+#define TRACE_SCOPE(name, category) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name, category)
+#define TRACE_THREAD_NAME(name) TraceRecorder::instance().setThreadName(name)
+#else
+#define TRACE_SCOPE(name, category) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#endif
+
+#endif // TRACE_RECORDER_HPP
@@ -4,10 +4,17 @@
 #include <opencv2/opencv.hpp>
 #include "Headers/MultiThreadImageProcessor.hpp"
 #include "Headers/KeyHandler.hpp"
+#include "Headers/MultiStreamProcessor.hpp"
+#include "Headers/FramePipeline.hpp"
+#include "Headers/FrameRecording.hpp"
+#include "Headers/TraceRecorder.hpp"
+#include "Headers/MetricsRegistry.hpp"
+#include "Headers/PerformanceVisualization.hpp"
 #include <string>
 #include <iostream>
 #include <filesystem>
 #include <thread>
+#include <deque>
 
 using namespace std;
 using namespace cv;
@@ -18,6 +25,10 @@ class WebcamOperations
     WebcamOperations();
     ~WebcamOperations();
     void openWebcam();
+    void openMultiStream(const vector<string>& sources, const string& filterName, bool incremental = false, bool native = false); // Several feeds sharing one processor
+    void runResolutionSweep(bool quick = false); // Headless benchmark on generated images
+    void runReplay(const string& source, const string& filterName, FrameParallelism mode, const string& outputPath = ""); // Filter a recording as fast as possible
+    void runBatch(const string& source, const vector<string>& chain, const string& outputDir = ""); // Filter a folder or recording many frames per call
     void takeSnapShot(const cv::Mat& inputFrame, const std::string& filename);
     void saveSnapShot();
     void closeWebcam();
@@ -30,9 +41,26 @@ class WebcamOperations
     string windowName = "Webcam Feed";
     string snapShotName = "snapshot.jpg";
     string resourcesPath = "../resources";
+    bool showMetricsOverlay = true;
 
     MultiThreadImageProcessor imageProcessor;
     KeyHandler keyHandler;
+
+    // Live fps chart, refreshed once a second
+    static constexpr int THROUGHPUT_HISTORY = 60;
+    PerformanceVisualization throughputChart;
+    deque<double> fpsHistory;
+    bool showThroughputChart = false;
+
+    // Raw recording of the camera feed for reproducible replays, toggled with 'w'
+    FrameRecorder recorder;
+
+    void setupThroughputChart();
+    void pinIoThread();
+    void toggleRecording(const Mat& frame);
+
+    MetricsExporter startExporter();
+    void drawMetricsOverlay(Mat& image, double fps, const LatencyHistogram& latency, uint64_t droppedFrames) const;
 };
 
 #endif // WEBCAMOPERATIONS_H
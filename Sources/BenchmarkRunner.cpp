@@ -0,0 +1,125 @@
+#include "Headers/BenchmarkRunner.hpp"
+#include <iostream>
+#include <iomanip>
+#include <numeric>
+#include <set>
+#include <limits>
+
+BenchmarkRunner::BenchmarkRunner(MultiThreadImageProcessor& processor) : processor(processor) {                          // Constructor
+}
+
+BenchmarkSample BenchmarkRunner::runSample(const string& filterName, const Mat& input, int threads,                       // Time one filter at one thread count
+                                           const BenchmarkOptions& options, Mat* lastOutput) {
+    BenchmarkSample sample;
+    sample.threads = threads;
+
+    ExecutionOptions execution = options.execution;
+    execution.numThreads = threads;
+
+    bool useCounters = options.collectCounters && counters.isAvailable();
+    if (useCounters) counters.start();
+
+    for (int trial = 0; trial < options.trials; trial++) {
+        auto [result, duration] = processor.applyFilterTimed(filterName, input, execution);
+        sample.trialsUs.push_back(duration);
+
+        // Keep the last result for saving
+        if (lastOutput && trial == options.trials - 1) {
+            *lastOutput = result;
+        }
+    }
+
+    if (useCounters) {
+        sample.counters = counters.stop();
+    }
+
+    sample.meanUs = sample.trialsUs.empty() ? 0
+        : accumulate(sample.trialsUs.begin(), sample.trialsUs.end(), 0.0) / sample.trialsUs.size();
+
+    // Every LLC miss pulls one cache line from memory
+    double pixels = static_cast<double>(input.total()) * max(1, options.trials);
+    if (sample.counters.valid && pixels > 0) {
+        sample.bytesPerPixel = sample.counters.llcMisses * static_cast<double>(PerfCounters::CACHE_LINE_BYTES) / pixels;
+    }
+    return sample;
+}
+
+vector<BenchmarkSample> BenchmarkRunner::runThreadSweep(const string& filterName, const Mat& input,                       // Time one filter over a range of thread counts
+                                                        const BenchmarkOptions& options, Mat* sequentialOutput, Mat* fastestOutput) {
+    vector<BenchmarkSample> samples;
+    double fastestUs = numeric_limits<double>::max();
+    for (int threads = options.minThreads; threads <= options.maxThreads; threads++) {
+        Mat output;
+        samples.push_back(runSample(filterName, input, threads, options, &output));
+        printSample(filterName, samples.back());
+
+        if (sequentialOutput && threads == 1) {
+            *sequentialOutput = output;
+        }
+        if (fastestOutput && samples.back().meanUs < fastestUs) {
+            fastestUs = samples.back().meanUs;
+            *fastestOutput = output;
+        }
+    }
+    return samples;
+}
+
+vector<SweepPoint> BenchmarkRunner::runResolutionSweep(const vector<string>& filterNames, const SweepOptions& options) {  // Time every filter across sizes and content
+    vector<SweepPoint> points;
+    BenchmarkOptions sampleOptions;
+    sampleOptions.trials = options.trials;
+    sampleOptions.collectCounters = false;
+    sampleOptions.execution = options.execution;
+
+    for (ContentClass content : options.contents) {
+        // Once a filter is too slow at one size it is skipped for every larger one
+        set<string> tooSlow;
+
+        for (const Size& size : options.resolutions) {
+            Mat input = SyntheticContent::generate(size, content);
+            double megapixels = size.area() / 1e6;
+
+            for (const auto& filterName : filterNames) {
+                if (tooSlow.count(filterName)) continue;
+
+                for (int threads : options.threadCounts) {
+                    BenchmarkSample sample = runSample(filterName, input, threads, sampleOptions);
+
+                    SweepPoint point;
+                    point.filterName = filterName;
+                    point.content = content;
+                    point.size = size;
+                    point.threads = threads;
+                    point.meanUs = sample.meanUs;
+                    point.usPerMegapixel = sample.meanUs / megapixels;
+                    points.push_back(point);
+
+                    cout << filterName << " " << SyntheticContent::name(content) << " " << size.width << "x" << size.height
+                         << " with " << threads << " threads: " << sample.meanUs << " us (" << point.usPerMegapixel << " us/MP)" << endl;
+
+                    if (sample.meanUs > options.maxRunSeconds * 1e6) {
+                        cout << filterName << " exceeded " << options.maxRunSeconds << " s, skipping larger "
+                             << SyntheticContent::name(content) << " images." << endl;
+                        tooSlow.insert(filterName);
+                    }
+                }
+            }
+        }
+    }
+    return points;
+}
+
+void BenchmarkRunner::printSample(const string& filterName, const BenchmarkSample& sample) {                             // Print wall time and, when available, counter metrics
+    cout << filterName << " processing time with " << sample.threads
+         << " threads: " << sample.meanUs << " us";
+
+    if (sample.counters.valid) {
+        cout << fixed << setprecision(2)
+             << " | IPC " << sample.counters.ipc()
+             << ", " << sample.bytesPerPixel << " B/px"
+             << ", " << sample.counters.branchMisses / max(1.0, static_cast<double>(sample.trialsUs.size())) << " branch misses/trial";
+        cout.unsetf(ios::floatfield);
+        cout << setprecision(6);
+    }
+    cout << endl;
+}
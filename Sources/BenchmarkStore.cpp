@@ -0,0 +1,332 @@
+#include "Headers/BenchmarkStore.hpp"
+#include "Headers/ImageKernels.hpp"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <ctime>
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+#include <thread>
+#include <filesystem>
+#include <map>
+
+#ifndef CPMULTI_GIT_HASH
+#define CPMULTI_GIT_HASH "unknown"
+#endif
+#ifndef CPMULTI_COMPILER_FLAGS
+#define CPMULTI_COMPILER_FLAGS "unknown"
+#endif
+
+static const char* COLUMNS = "run_id\tgit_hash\tcompiler\tcompiler_flags\tcpu\topencv\tthread_policy\thardware_threads\tinput\tfilter\tthreads\ttrials_us\tisa\tbuild_variant";
+
+static string policyName(ParallelPolicy policy) {
+    switch (policy) {
+        case ParallelPolicy::Sequential: return "sequential";
+        case ParallelPolicy::Strips: return "strips";
+        case ParallelPolicy::Tiles: return "tiles";
+    }
+    return "unknown";
+}
+
+static string readCpuModel() {
+    ifstream cpuinfo("/proc/cpuinfo");
+    string line;
+    while (getline(cpuinfo, line)) {
+        if (line.rfind("model name", 0) == 0) {
+            size_t colon = line.find(':');
+            if (colon != string::npos) return line.substr(line.find_first_not_of(' ', colon + 1));
+        }
+    }
+    return "unknown";
+}
+
+RunMetadata RunMetadata::collect(const ExecutionOptions& execution, const string& input) {                              // Describe this build, machine and configuration
+    RunMetadata metadata;
+
+    auto now = chrono::system_clock::now();
+    time_t seconds = chrono::system_clock::to_time_t(now);
+    auto millis = chrono::duration_cast<chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+    tm utc{};
+    gmtime_r(&seconds, &utc);
+    stringstream runId;
+    runId << put_time(&utc, "%Y-%m-%dT%H:%M:%S") << "." << setw(3) << setfill('0') << millis << "Z";
+    metadata.runId = runId.str();
+
+    metadata.gitHash = CPMULTI_GIT_HASH;
+#if defined(__clang__)
+    metadata.compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    metadata.compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    metadata.compiler = "msvc " + to_string(_MSC_VER);
+#else
+    metadata.compiler = "unknown";
+#endif
+    metadata.compilerFlags = CPMULTI_COMPILER_FLAGS;
+    metadata.cpuModel = readCpuModel();
+    metadata.opencvVersion = CV_VERSION;
+    metadata.threadPolicy = policyName(execution.policy) + " overlap=" + to_string(execution.overlap) +
+                            " tile=" + to_string(execution.tileSize);
+    metadata.hardwareThreads = static_cast<int>(thread::hardware_concurrency());
+    metadata.input = input;
+    metadata.isa = ImageKernels::isaName(ImageKernels::activeIsa());
+    metadata.buildVariant = ImageKernels::buildVariant();
+    return metadata;
+}
+
+BenchmarkStore::BenchmarkStore(const string& path) : path(path) {                                                       // Constructor
+}
+
+string BenchmarkStore::sanitize(const string& field) {                                                                  // Keep fields on one line and inside their column
+    string clean = field;
+    replace_if(clean.begin(), clean.end(), [](char c) { return c == '\t' || c == '\n' || c == '\r'; }, ' ');
+    return clean;
+}
+
+bool BenchmarkStore::append(const RunMetadata& metadata, const unordered_map<string, vector<BenchmarkSample>>& samples) {  // Add one run to the end of the store
+    bool isNew = !filesystem::exists(path) || filesystem::file_size(path) == 0;
+    ofstream out(path, ios::app);
+    if (!out) {
+        cerr << "Error: Unable to open benchmark store " << path << endl;
+        return false;
+    }
+    if (isNew) {
+        out << COLUMNS << "\n";
+    }
+
+    // Filters in a fixed order keep runs easy to diff by eye
+    vector<string> filterNames;
+    for (const auto& [filterName, _] : samples) filterNames.push_back(filterName);
+    sort(filterNames.begin(), filterNames.end());
+
+    string prefix = sanitize(metadata.runId) + "\t" + sanitize(metadata.gitHash) + "\t" + sanitize(metadata.compiler) + "\t" +
+                    sanitize(metadata.compilerFlags) + "\t" + sanitize(metadata.cpuModel) + "\t" + sanitize(metadata.opencvVersion) + "\t" +
+                    sanitize(metadata.threadPolicy) + "\t" + to_string(metadata.hardwareThreads) + "\t" + sanitize(metadata.input);
+    out << setprecision(10);
+    for (const auto& filterName : filterNames) {
+        for (const auto& sample : samples.at(filterName)) {
+            out << prefix << "\t" << sanitize(filterName) << "\t" << sample.threads << "\t";
+            for (size_t i = 0; i < sample.trialsUs.size(); i++) {
+                out << (i ? "," : "") << sample.trialsUs[i];
+            }
+            out << "\t" << sanitize(metadata.isa) << "\t" << sanitize(metadata.buildVariant) << "\n";
+        }
+    }
+    return static_cast<bool>(out);
+}
+
+vector<StoredResult> BenchmarkStore::load() const {                                                                     // Read every stored row
+    vector<StoredResult> results;
+    ifstream in(path);
+    string line;
+    while (getline(in, line)) {
+        if (line.empty() || line.rfind("run_id\t", 0) == 0) continue;
+
+        vector<string> fields;
+        stringstream row(line);
+        string field;
+        while (getline(row, field, '\t')) fields.push_back(field);
+        if (fields.size() < 12) {
+            cerr << "Warning: Skipping malformed benchmark row in " << path << endl;
+            continue;
+        }
+
+        StoredResult result;
+        result.metadata.runId = fields[0];
+        result.metadata.gitHash = fields[1];
+        result.metadata.compiler = fields[2];
+        result.metadata.compilerFlags = fields[3];
+        result.metadata.cpuModel = fields[4];
+        result.metadata.opencvVersion = fields[5];
+        result.metadata.threadPolicy = fields[6];
+        result.metadata.hardwareThreads = atoi(fields[7].c_str());
+        result.metadata.input = fields[8];
+        result.filterName = fields[9];
+        result.threads = atoi(fields[10].c_str());
+
+        stringstream trials(fields[11]);
+        while (getline(trials, field, ',')) {
+            if (!field.empty()) result.trialsUs.push_back(atof(field.c_str()));
+        }
+        // Rows written before kernels were dispatched per instruction set have no ISA or variant
+        result.metadata.isa = fields.size() > 12 ? fields[12] : "unknown";
+        result.metadata.buildVariant = fields.size() > 13 ? fields[13] : "unknown";
+        results.push_back(move(result));
+    }
+    return results;
+}
+
+vector<string> BenchmarkStore::listRuns() const {                                                                       // Distinct run ids in file order
+    vector<string> runs;
+    for (const auto& result : load()) {
+        if (find(runs.begin(), runs.end(), result.metadata.runId) == runs.end()) {
+            runs.push_back(result.metadata.runId);
+        }
+    }
+    return runs;
+}
+
+// Regularized incomplete beta function I_x(a, b), continued fraction from Numerical Recipes
+static double incompleteBeta(double a, double b, double x) {
+    if (x <= 0) return 0;
+    if (x >= 1) return 1;
+    if (x > (a + 1) / (a + b + 2)) return 1 - incompleteBeta(b, a, 1 - x);
+
+    double front = exp(lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) + b * log(1 - x)) / a;
+    double c = 1, d = 1 - (a + b) * x / (a + 1);
+    d = 1 / (fabs(d) < 1e-30 ? 1e-30 : d);
+    double result = d;
+    for (int m = 1; m <= 200; m++) {
+        for (int step = 0; step < 2; step++) {
+            double numerator = (step == 0)
+                ? m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m))
+                : -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1));
+            d = 1 + numerator * d;
+            d = 1 / (fabs(d) < 1e-30 ? 1e-30 : d);
+            c = 1 + numerator / c;
+            if (fabs(c) < 1e-30) c = 1e-30;
+            result *= c * d;
+            if (step == 1 && fabs(c * d - 1) < 1e-12) return front * result;
+        }
+    }
+    return front * result;
+}
+
+double BenchmarkStore::welchPValue(const vector<double>& a, const vector<double>& b) {                                  // Probability of a difference this large by chance
+    if (a.size() < 2 || b.size() < 2) return 1.0;
+
+    auto meanVariance = [](const vector<double>& values) {
+        double mean = accumulate(values.begin(), values.end(), 0.0) / values.size();
+        double squares = 0;
+        for (double value : values) squares += (value - mean) * (value - mean);
+        return make_pair(mean, squares / (values.size() - 1));
+    };
+    auto [meanA, varianceA] = meanVariance(a);
+    auto [meanB, varianceB] = meanVariance(b);
+
+    double errorA = varianceA / a.size();
+    double errorB = varianceB / b.size();
+    double standardError = sqrt(errorA + errorB);
+    if (standardError == 0) return (meanA == meanB) ? 1.0 : 0.0;
+
+    double t = (meanA - meanB) / standardError;
+    double df = pow(errorA + errorB, 2) /
+                (errorA * errorA / (a.size() - 1) + errorB * errorB / (b.size() - 1));
+    return incompleteBeta(df / 2, 0.5, df / (df + t * t));
+}
+
+// Run id or the latest run built from a git hash starting with the given text
+static string resolveRun(const vector<StoredResult>& results, const vector<string>& runs, const string& selector, const string& exclude) {
+    for (auto run = runs.rbegin(); run != runs.rend(); ++run) {
+        if (*run == exclude) continue;
+        if (*run == selector) return *run;
+        for (const auto& result : results) {
+            if (result.metadata.runId == *run && result.metadata.gitHash.rfind(selector, 0) == 0) return *run;
+        }
+    }
+    return "";
+}
+
+int BenchmarkStore::compare(const ComparisonOptions& options) const {                                                   // Report regressions and improvements between two runs
+    vector<StoredResult> results = load();
+    vector<string> runs = listRuns();
+    if (runs.size() < 2) {
+        cerr << "Error: The benchmark store " << path << " needs at least two runs to compare." << endl;
+        return 2;
+    }
+
+    string candidate = options.candidateRun.empty() ? runs.back() : resolveRun(results, runs, options.candidateRun, "");
+    string baseline;
+    if (options.baselineRun.empty()) {
+        auto position = find(runs.begin(), runs.end(), candidate);
+        if (position != runs.end() && position != runs.begin()) baseline = *prev(position);
+    } else {
+        baseline = resolveRun(results, runs, options.baselineRun, candidate);
+    }
+    if (candidate.empty() || baseline.empty()) {
+        cerr << "Error: Could not find both runs to compare." << endl;
+        return 2;
+    }
+
+    // Rows of each run, keyed by filter and thread count
+    map<string, map<int, const StoredResult*>> baseRows, candidateRows;
+    const RunMetadata* baseMetadata = nullptr;
+    const RunMetadata* candidateMetadata = nullptr;
+    for (const auto& result : results) {
+        if (result.metadata.runId == baseline) {
+            baseRows[result.filterName][result.threads] = &result;
+            baseMetadata = &result.metadata;
+        } else if (result.metadata.runId == candidate) {
+            candidateRows[result.filterName][result.threads] = &result;
+            candidateMetadata = &result.metadata;
+        }
+    }
+
+    cout << "Baseline:  " << baseline << " (" << baseMetadata->gitHash << ", " << baseMetadata->threadPolicy << ")\n"
+         << "Candidate: " << candidate << " (" << candidateMetadata->gitHash << ", " << candidateMetadata->threadPolicy << ")\n";
+    if (baseMetadata->cpuModel != candidateMetadata->cpuModel || baseMetadata->hardwareThreads != candidateMetadata->hardwareThreads) {
+        cout << "Warning: The runs were measured on different CPUs.\n";
+    }
+    if (baseMetadata->compiler != candidateMetadata->compiler || baseMetadata->compilerFlags != candidateMetadata->compilerFlags) {
+        cout << "Note: Compiler or flags differ between the runs.\n";
+    }
+    if (baseMetadata->isa != candidateMetadata->isa || baseMetadata->buildVariant != candidateMetadata->buildVariant) {
+        cout << "Note: Build variant or kernel ISA differ (" << baseMetadata->buildVariant << "/" << baseMetadata->isa << " vs "
+             << candidateMetadata->buildVariant << "/" << candidateMetadata->isa << ").\n";
+    }
+    if (baseMetadata->input != candidateMetadata->input) {
+        cout << "Warning: The runs used different inputs (" << baseMetadata->input << " vs " << candidateMetadata->input << ").\n";
+    }
+
+    cout << "\n" << left << setw(12) << "Filter" << right << setw(9) << "Threads" << setw(14) << "Baseline us"
+         << setw(14) << "Candidate us" << setw(10) << "Change" << setw(10) << "p" << "  Verdict\n";
+
+    int regressions = 0;
+    auto mean = [](const vector<double>& values) {
+        return values.empty() ? 0.0 : accumulate(values.begin(), values.end(), 0.0) / values.size();
+    };
+    for (const auto& [filterName, byThreads] : baseRows) {
+        // Compare at the baseline's best thread count, which is the configuration that matters in practice
+        auto best = min_element(byThreads.begin(), byThreads.end(), [&](const auto& x, const auto& y) {
+            return mean(x.second->trialsUs) < mean(y.second->trialsUs);
+        });
+        int threads = best->first;
+
+        auto candidateFilter = candidateRows.find(filterName);
+        if (candidateFilter == candidateRows.end() || !candidateFilter->second.count(threads)) {
+            cout << left << setw(12) << filterName << right << setw(9) << threads << "  missing in candidate\n";
+            continue;
+        }
+
+        const vector<double>& baseTrials = best->second->trialsUs;
+        const vector<double>& candidateTrials = candidateFilter->second.at(threads)->trialsUs;
+        double baseMean = mean(baseTrials);
+        double candidateMean = mean(candidateTrials);
+        double change = (baseMean > 0) ? (candidateMean - baseMean) / baseMean * 100.0 : 0;
+        double p = welchPValue(baseTrials, candidateTrials);
+        bool significant = p < options.alpha;
+
+        string verdict = "unchanged";
+        if (fabs(change) > options.thresholdPercent) {
+            if (!significant) {
+                verdict = "within noise";
+            } else if (change > 0) {
+                verdict = "REGRESSION";
+                regressions++;
+            } else {
+                verdict = "improvement";
+            }
+        }
+
+        cout << left << setw(12) << filterName << right << setw(9) << threads << fixed << setprecision(1)
+             << setw(14) << baseMean << setw(14) << candidateMean << setw(9) << showpos << change << "%" << noshowpos
+             << setprecision(3) << setw(10) << p << "  " << verdict << "\n";
+        cout.unsetf(ios::floatfield);
+    }
+
+    cout << "\n" << regressions << " significant regression(s) beyond " << options.thresholdPercent << "%." << endl;
+    return regressions > 0 ? 1 : 0;
+}
@@ -3,9 +3,6 @@
 CannyFilter::CannyFilter(double t1, double t2) : threshold1(t1), threshold2(t2) {}          // Constructor
 
 CannyFilter::~CannyFilter() {                                                               // Destructor
-    #ifdef __APPLE__
-        destroyWindow(windowName);
-    #endif
 }                                                              
 
 void CannyFilter::setThresholds(double t1, double t2) {                                     // Set thresholds for Canny edge detection
@@ -30,3 +27,16 @@ Mat CannyFilter::applyFilter(const Mat& inputFrame) {
 
     return edges;
 }
+
+Mat CannyFilter::applyFilter(FrameContext& context, const Rect& region) {                   // Canny edge detection on the frame's shared gradients
+    if (context.empty()) {
+        cerr << "Error: Empty input frame provided to CannyFilter." << endl;
+        return Mat();
+    }
+
+    // Same derivatives Canny would compute from the grey plane, so only the hysteresis runs here
+    Mat edges;
+    Canny(context.gradientX()(region), context.gradientY()(region), edges, threshold1, threshold2);
+
+    return edges;
+}
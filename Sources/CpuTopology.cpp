@@ -0,0 +1,203 @@
+#include "Headers/CpuTopology.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <thread>
+#include <cstdlib>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Parse a kernel CPU list such as "0-3,8,10-11"
+static vector<int> parseCpuList(const string& list) {
+    vector<int> cpus;
+    stringstream in(list);
+    string range;
+    while (getline(in, range, ',')) {
+        if (range.empty()) continue;
+        size_t dash = range.find('-');
+        int first = atoi(range.c_str());
+        int last = (dash == string::npos) ? first : atoi(range.c_str() + dash + 1);
+        for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+static string readLine(const string& path) {
+    ifstream in(path);
+    string line;
+    getline(in, line);
+    return line;
+}
+
+AffinityOptions AffinityOptions::fromEnvironment() {                                                                    // Settings for the app without changing its command line
+    AffinityOptions options;
+    if (const char* policy = getenv("CPMULTI_AFFINITY")) {
+        string value = policy;
+        if (value == "compact") options.policy = AffinityPolicy::Compact;
+        else if (value == "scatter") options.policy = AffinityPolicy::Scatter;
+        else if (value != "none") cerr << "Warning: Unknown CPMULTI_AFFINITY '" << value << "', threads are not pinned." << endl;
+    }
+    if (const char* reserved = getenv("CPMULTI_RESERVED_CORES")) {
+        options.reservedCores = max(0, atoi(reserved));
+    }
+    return options;
+}
+
+const CpuTopology& CpuTopology::instance() {                                                                            // Read once; the topology does not change while running
+    static const CpuTopology topology;
+    return topology;
+}
+
+CpuTopology::CpuTopology() {                                                                                            // Constructor reading sysfs
+#ifdef __linux__
+    const string cpuRoot = "/sys/devices/system/cpu/";
+    map<pair<int, int>, int> coreIndex;     // (package, core_id) -> physical core
+    for (int cpu : parseCpuList(readLine(cpuRoot + "online"))) {
+        string topologyDir = cpuRoot + "cpu" + to_string(cpu) + "/topology/";
+        LogicalCpu logical;
+        logical.id = cpu;
+        logical.package = max(0, atoi(readLine(topologyDir + "physical_package_id").c_str()));
+        int coreId = atoi(readLine(topologyDir + "core_id").c_str());
+        auto key = make_pair(logical.package, coreId);
+        auto it = coreIndex.find(key);
+        if (it == coreIndex.end()) {
+            it = coreIndex.emplace(key, static_cast<int>(coreIndex.size())).first;
+        }
+        logical.core = it->second;
+        logicalCpus.push_back(logical);
+    }
+
+    // NUMA nodes list their CPUs; machines without NUMA have no node directory at all
+    const string nodeRoot = "/sys/devices/system/node/";
+    map<int, int> nodeOfCpu;
+    if (filesystem::exists(nodeRoot)) {
+        for (const auto& entry : filesystem::directory_iterator(nodeRoot)) {
+            string name = entry.path().filename().string();
+            if (name.rfind("node", 0) != 0 || name.size() == 4 || !isdigit(static_cast<unsigned char>(name[4]))) continue;
+            int node = atoi(name.c_str() + 4);
+            for (int cpu : parseCpuList(readLine(entry.path().string() + "/cpulist"))) nodeOfCpu[cpu] = node;
+            nodes = max(nodes, node + 1);
+        }
+    }
+    for (auto& logical : logicalCpus) {
+        auto it = nodeOfCpu.find(logical.id);
+        logical.node = (it != nodeOfCpu.end()) ? it->second : 0;
+    }
+#endif
+
+    // Fallback: one core per hardware thread
+    if (logicalCpus.empty()) {
+        int count = max(1, static_cast<int>(thread::hardware_concurrency()));
+        for (int cpu = 0; cpu < count; cpu++) {
+            logicalCpus.push_back({cpu, cpu, 0, 0, 0});
+        }
+    }
+
+    // Number the hardware threads of each core in CPU id order
+    sort(logicalCpus.begin(), logicalCpus.end(), [](const LogicalCpu& a, const LogicalCpu& b) { return a.id < b.id; });
+    map<int, int> threadsSeen;
+    for (auto& logical : logicalCpus) {
+        logical.smtIndex = threadsSeen[logical.core]++;
+    }
+    cores = static_cast<int>(threadsSeen.size());
+}
+
+vector<int> CpuTopology::ioCpus(const AffinityOptions& options) const {                                                 // Every hardware thread of the reserved cores
+    vector<int> cpus;
+    if (cores <= 1 || options.reservedCores <= 0) {
+        for (const auto& logical : logicalCpus) cpus.push_back(logical.id);
+        return cpus;
+    }
+    // Reserve the lowest-numbered cores on node 0, where the OS usually handles device interrupts
+    set<int> reserved;
+    for (const auto& logical : logicalCpus) {
+        if (static_cast<int>(reserved.size()) >= min(options.reservedCores, cores - 1)) break;
+        if (logical.node == 0) reserved.insert(logical.core);
+    }
+    for (const auto& logical : logicalCpus) {
+        if (reserved.count(logical.core)) cpus.push_back(logical.id);
+    }
+    return cpus;
+}
+
+vector<int> CpuTopology::workerCpus(const AffinityOptions& options) const {                                             // Pinning order of the pool workers
+    if (options.policy == AffinityPolicy::None) return {};
+
+    vector<int> io = ioCpus(options);
+    vector<LogicalCpu> available;
+    for (const auto& logical : logicalCpus) {
+        if (cores <= 1 || find(io.begin(), io.end(), logical.id) == io.end()) available.push_back(logical);
+    }
+
+    // Rank of each core within its node, so scatter can alternate nodes core by core
+    map<int, int> coreRank;
+    map<int, int> coresOnNode;
+    for (const auto& logical : available) {
+        if (logical.smtIndex == 0 && !coreRank.count(logical.core)) coreRank[logical.core] = coresOnNode[logical.node]++;
+    }
+
+    if (options.policy == AffinityPolicy::Compact) {
+        sort(available.begin(), available.end(), [](const LogicalCpu& a, const LogicalCpu& b) {
+            return make_tuple(a.node, a.core, a.smtIndex) < make_tuple(b.node, b.core, b.smtIndex);
+        });
+    } else {
+        sort(available.begin(), available.end(), [&](const LogicalCpu& a, const LogicalCpu& b) {
+            return make_tuple(a.smtIndex, coreRank[a.core], a.node) < make_tuple(b.smtIndex, coreRank[b.core], b.node);
+        });
+    }
+
+    vector<int> cpus;
+    for (const auto& logical : available) cpus.push_back(logical.id);
+    return cpus;
+}
+
+int CpuTopology::nodeOf(int cpu) const {
+    for (const auto& logical : logicalCpus) {
+        if (logical.id == cpu) return logical.node;
+    }
+    return 0;
+}
+
+string CpuTopology::describe() const {
+    stringstream out;
+    out << logicalCpus.size() << " logical CPUs, " << cores << " cores, " << nodes << " NUMA node" << (nodes == 1 ? "" : "s");
+    return out.str();
+}
+
+bool CpuTopology::pinCurrentThread(const vector<int>& cpus) {                                                           // Set the affinity mask of the calling thread
+#ifdef __linux__
+    if (cpus.empty()) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+int CpuTopology::currentCpu() {
+#ifdef __linux__
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+const char* CpuTopology::policyName(AffinityPolicy policy) {
+    switch (policy) {
+        case AffinityPolicy::None: return "none";
+        case AffinityPolicy::Compact: return "compact";
+        case AffinityPolicy::Scatter: return "scatter";
+    }
+    return "unknown";
+}
@@ -1,20 +1,23 @@
 #include "Headers/DenoisingFilter.hpp"
 #include <iostream>
 
-DenoisingFilter::DenoisingFilter(float strength) {                                                                  // Constructor                                      
+DenoisingFilter::DenoisingFilter(float strength, int templateWindow, int searchWindow) {                             // Constructor                                      
     setStrength(strength);
+    setWindowSizes(templateWindow, searchWindow);
 }
 
 DenoisingFilter::~DenoisingFilter() {                                                                               // Destructor
-    #ifdef __APPLE__
-        destroyWindow(windowName);
-    #endif
 }
 
 void DenoisingFilter::setStrength(float strength) {                                                                 // Update the denoising strength
     hStrength = max(1.0f, min(strength, 30.0f));
 }
 
+void DenoisingFilter::setWindowSizes(int templateWindow, int searchWindow) {                                         // Update the template and search window sizes
+    templateWindowSize = max(3, templateWindow);
+    searchWindowSize = max(templateWindowSize, searchWindow);
+}
+
 Mat DenoisingFilter::applyFilter(const Mat& inputFrame) {                                                           // Apply denoising filter to the input frame
     if (inputFrame.empty()) {
         cerr << "Error: Empty input frame provided to DenoisingFilter." << endl;
@@ -22,7 +25,7 @@ Mat DenoisingFilter::applyFilter(const Mat& inputFrame) {
     }
 
     Mat denoisedFrame;
-    fastNlMeansDenoisingColored(inputFrame, denoisedFrame, hStrength, hStrength, 7, 10);
+    fastNlMeansDenoisingColored(inputFrame, denoisedFrame, hStrength, hStrength, templateWindowSize, searchWindowSize);
 
     // Ensure the output has the same number of channels as the input
     if (denoisedFrame.channels() != inputFrame.channels()) {
@@ -7,9 +7,6 @@ FaceDetection::FaceDetection() {
 }
 
 FaceDetection::~FaceDetection() {
-  #ifdef __APPLE__
-        destroyWindow(windowName);
-    #endif
 }
 
 Mat FaceDetection::applyFilter(const Mat& inputFrame) {
@@ -1,11 +1,9 @@
 #include "Headers/FourierFilter.hpp"
+#include "Headers/ImageKernels.hpp"
 
-FourierFilter::FourierFilter() {}                                                           // Constructor
+FourierFilter::FourierFilter(SpectrumOutput output) : output(output) {}                     // Constructor
 
 FourierFilter::~FourierFilter() {                                                           // Destructor              
-    #ifdef __APPLE__
-        destroyWindow(windowName);
-    #endif
 }
 
 Mat FourierFilter::applyFilter(const Mat& inputFrame) {                                     // Apply Fourier transform to the input frame by converting it to grayscale and displaying the magnitude spectrum
@@ -19,7 +17,24 @@ Mat FourierFilter::applyFilter(const Mat& inputFrame) {
     if (inputFrame.channels() == 3)
         cvtColor(inputFrame, gray, COLOR_BGR2GRAY);
     else
-        gray = inputFrame.clone();
+        gray = inputFrame;
+
+    return magnitudeSpectrum(gray);
+}
+
+Mat FourierFilter::applyFilter(FrameContext& context) {                                     // Spectrum of the frame's shared grey plane
+    if (context.empty()) {
+        cerr << "Error: Empty input frame provided to FourierFilter." << endl;
+        return Mat();
+    }
+
+    return magnitudeSpectrum(context.grey());
+}
+
+Mat FourierFilter::magnitudeSpectrum(const Mat& gray) {                                     // Centred log-magnitude spectrum scaled to [0,1]
+    if (output == SpectrumOutput::Bytes) {
+        return byteSpectrum(gray);
+    }
 
     // Instead of padding to an optimal size, work with the original image.
     Mat floatImg;
@@ -68,3 +83,34 @@ Mat FourierFilter::applyFilter(const Mat& inputFrame) {
 
     return magI;
 }
+
+Mat FourierFilter::byteSpectrum(const Mat& gray) {                                          // Centred log-magnitude spectrum as 8-bit grey
+    Mat floatImg;
+    gray.convertTo(floatImg, CV_32F);
+    Mat complexI;
+    dft(floatImg, complexI, DFT_COMPLEX_OUTPUT);
+
+    // Odd dimensions lose their last row or column, as in the float spectrum
+    int width = complexI.cols & ~1;
+    int height = complexI.rows & ~1;
+    if (width == 0 || height == 0) {
+        return Mat();
+    }
+
+    // The DC term is the sum of the pixels, which no other magnitude can exceed for a grey image
+    float dc = complexI.at<Vec2f>(0, 0)[0];
+    float scale = (dc > 0) ? 255.0f / log2(1.0f + dc) : 0.0f;
+
+    // The quadrant swap is folded into the addressing: output row y, column x reads the
+    // spectrum at ((y + cy) mod height, (x + cx) mod width), in two contiguous halves per row
+    int cx = width / 2;
+    int cy = height / 2;
+    Mat spectrum(height, width, CV_8U);
+    for (int y = 0; y < height; y++) {
+        const float* source = complexI.ptr<float>((y + cy) % height);
+        uint8_t* target = spectrum.ptr<uint8_t>(y);
+        ImageKernels::logMagnitude(source + 2 * cx, target, cx, scale);
+        ImageKernels::logMagnitude(source, target + cx, cx, scale);
+    }
+    return spectrum;
+}
@@ -0,0 +1,97 @@
+#include "Headers/FrameContext.hpp"
+#include "Headers/TraceRecorder.hpp"
+
+// Rows per band when a plane is computed on the pool
+static constexpr int BAND_ROWS = 64;
+
+FrameContext::FrameContext(const Mat& frame, ThreadPool* pool, int maxWorkers)                                          // Constructor sharing the frame data
+    : FrameContext(frame, PixelFormat::BGR, pool, maxWorkers) {
+}
+
+FrameContext::FrameContext(const Mat& raw, PixelFormat format, ThreadPool* pool, int maxWorkers)                        // Constructor for a camera-native frame
+    : raw(raw), pixelFormat(format), frameSize(frameSizeOf(raw, format)), pool(pool), maxWorkers(max(1, maxWorkers)) {
+}
+
+Size FrameContext::frameSizeOf(const Mat& raw, PixelFormat format) {                                                    // Picture size of a raw buffer
+    return format == PixelFormat::NV12 ? Size(raw.cols, raw.rows * 2 / 3) : Size(raw.cols, raw.rows);
+}
+
+const char* FrameContext::formatName(PixelFormat format) {                                                              // Name used in logs
+    switch (format) {
+        case PixelFormat::NV12: return "NV12";
+        case PixelFormat::YUYV: return "YUYV";
+        default: return "BGR";
+    }
+}
+
+void FrameContext::forEachBand(int rows, const function<void(const Range&)>& body) {                                    // Split a plane into row bands
+    int bands = (rows + BAND_ROWS - 1) / BAND_ROWS;
+    if (!pool || maxWorkers == 1 || bands <= 1) {
+        body(Range(0, rows));
+        return;
+    }
+    pool->parallelFor(bands, maxWorkers, [&](size_t band, int) {
+        body(Range(static_cast<int>(band) * BAND_ROWS, min(rows, (static_cast<int>(band) + 1) * BAND_ROWS)));
+    });
+}
+
+const Mat& FrameContext::frame() {                                                                                      // Colour frame for colour filters and display
+    call_once(sourceOnce, [this]() {
+        if (pixelFormat == PixelFormat::BGR) {
+            source = raw;
+            return;
+        }
+        // Chroma rows are shared between luma rows, so the conversion is not split into bands
+        TRACE_SCOPE("convert to BGR", "context");
+        cvtColor(raw, source, pixelFormat == PixelFormat::NV12 ? COLOR_YUV2BGR_NV12 : COLOR_YUV2BGR_YUYV);
+    });
+    return source;
+}
+
+const Mat& FrameContext::grey() {                                                                                       // Luma of the frame
+    call_once(greyOnce, [this]() {
+        if (pixelFormat == PixelFormat::NV12) {
+            greyPlane = raw.rowRange(0, frameSize.height);
+            return;
+        }
+        if (raw.channels() == 1) {
+            greyPlane = raw;
+            return;
+        }
+        TRACE_SCOPE("derive grey", "context");
+        greyPlane.create(frameSize, CV_8UC1);
+        int code = pixelFormat == PixelFormat::YUYV ? COLOR_YUV2GRAY_YUYV : raw.channels() == 4 ? COLOR_BGRA2GRAY : COLOR_BGR2GRAY;
+        forEachBand(raw.rows, [this, code](const Range& rows) {
+            cvtColor(raw.rowRange(rows), greyPlane.rowRange(rows), code);
+        });
+    });
+    return greyPlane;
+}
+
+// A band of a larger image reads its neighbours' rows for the kernel support, so banded
+// results are identical to filtering the whole plane at once
+const Mat& FrameContext::gradientX() {                                                                                  // Horizontal derivative
+    call_once(gradientXOnce, [this]() {
+        const Mat& gray = grey();
+        TRACE_SCOPE("derive gradient x", "context");
+        gradientXPlane.create(gray.size(), CV_16SC1);
+        forEachBand(gray.rows, [&](const Range& rows) {
+            Mat band = gradientXPlane.rowRange(rows);
+            Sobel(gray.rowRange(rows), band, CV_16S, 1, 0, 3, 1, 0, BORDER_REPLICATE);
+        });
+    });
+    return gradientXPlane;
+}
+
+const Mat& FrameContext::gradientY() {                                                                                  // Vertical derivative
+    call_once(gradientYOnce, [this]() {
+        const Mat& gray = grey();
+        TRACE_SCOPE("derive gradient y", "context");
+        gradientYPlane.create(gray.size(), CV_16SC1);
+        forEachBand(gray.rows, [&](const Range& rows) {
+            Mat band = gradientYPlane.rowRange(rows);
+            Sobel(gray.rowRange(rows), band, CV_16S, 0, 1, 3, 1, 0, BORDER_REPLICATE);
+        });
+    });
+    return gradientYPlane;
+}
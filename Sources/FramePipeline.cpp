@@ -0,0 +1,202 @@
+#include "Headers/FramePipeline.hpp"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+FramePipeline::FramePipeline(MultiThreadImageProcessor& processor, const string& filterName, const FramePipelineOptions& options)   // Constructor
+    : processor(processor), filterName(filterName), options(options) {
+}
+
+FramePipeline::~FramePipeline() {                                                                                       // Destructor
+    finish();
+    unique_lock<mutex> lock(pipelineMutex);
+    slotCondition.wait(lock, [this]() { return framesInFlight == 0; });
+}
+
+// push() and finish() are called by one producer; pop() may run on any thread
+void FramePipeline::push(const Mat& frame) {                                                                            // Queue a frame for filtering
+    uint64_t sequence;
+    Clock::time_point pushedAt;
+    {
+        unique_lock<mutex> lock(pipelineMutex);
+        if (finishing) {
+            cerr << "Error: Frame pushed after the pipeline was finished." << endl;
+            return;
+        }
+        slotCondition.wait(lock, [this]() { return !planned || framesInFlight < plan.framesInFlight; });
+        sequence = nextSequence++;
+        framesInFlight++;
+        pushedAt = Clock::now();
+        if (stats.framesPushed++ == 0) {
+            firstPush = pushedAt;
+        }
+    }
+
+    // The first frame is filtered on the caller by one thread; its cost decides the plan
+    if (!planned) {
+        ExecutionOptions sequential = processor.getDefaultOptions();
+        sequential.numThreads = 1;
+        sequential.policy = ParallelPolicy::Sequential;
+        Mat output;
+        double durationUs = 0;
+        try {
+            tie(output, durationUs) = processor.applyFilterTimed(filterName, frame, sequential);
+        } catch (const exception& e) {
+            cerr << "Error: Filtering frame " << sequence << " failed: " << e.what() << endl;
+        }
+        FramePipelinePlan chosen = choosePlan(processor.getCapabilities(filterName), frame.size(), durationUs / 1000.0,
+                                              processor.getThreadBudget(), options);
+        {
+            lock_guard<mutex> lock(pipelineMutex);
+            plan = chosen;
+            planned = true;
+        }
+        complete(sequence, pushedAt, output, durationUs);
+        return;
+    }
+
+    ExecutionOptions perFrame = frameOptions();
+    processor.getThreadPool().enqueue([this, sequence, pushedAt, frame, perFrame]() {
+        Mat output;
+        double durationUs = 0;
+        try {
+            tie(output, durationUs) = processor.applyFilterTimed(filterName, frame, perFrame);
+        } catch (const exception& e) {
+            cerr << "Error: Filtering frame " << sequence << " failed: " << e.what() << endl;
+        }
+        complete(sequence, pushedAt, output, durationUs);
+    });
+}
+
+ExecutionOptions FramePipeline::frameOptions() const {                                                                  // Options each frame is filtered with
+    ExecutionOptions perFrame = processor.getDefaultOptions();
+    perFrame.numThreads = plan.threadsPerFrame;
+    perFrame.policy = (plan.threadsPerFrame > 1) ? ParallelPolicy::Strips : ParallelPolicy::Sequential;
+    return perFrame;
+}
+
+void FramePipeline::complete(uint64_t sequence, Clock::time_point pushedAt, Mat output, double filterUs) {              // Hand a finished frame to the reorder buffer
+    lock_guard<mutex> lock(pipelineMutex);
+    framesInFlight--;
+    reorderBuffer[sequence] = {move(output), pushedAt, filterUs / 1000.0};
+
+    // Release every frame that no longer waits for an earlier one
+    Clock::time_point now = Clock::now();
+    while (!reorderBuffer.empty() && reorderBuffer.begin()->first == nextRelease) {
+        Finished& next = reorderBuffer.begin()->second;
+        totalFilterMs += next.filterMs;
+        totalLatencyMs += chrono::duration<double, milli>(now - next.pushedAt).count();
+        releasedOutputs.push_back(move(next.output));
+        reorderBuffer.erase(reorderBuffer.begin());
+        nextRelease++;
+        stats.framesEmitted++;
+        lastRelease = now;
+    }
+    stats.maxReorderDepth = max(stats.maxReorderDepth, reorderBuffer.size());
+
+    // Notified under the lock, so the destructor cannot return while this thread still uses the conditions
+    slotCondition.notify_all();
+    outputCondition.notify_all();
+}
+
+bool FramePipeline::pop(Mat& output) {                                                                                  // Wait for the next output in order
+    unique_lock<mutex> lock(pipelineMutex);
+    outputCondition.wait(lock, [this]() { return !releasedOutputs.empty() || (finishing && nextRelease == nextSequence); });
+    if (releasedOutputs.empty()) return false;
+    output = move(releasedOutputs.front());
+    releasedOutputs.pop_front();
+    return true;
+}
+
+bool FramePipeline::tryPop(Mat& output) {                                                                               // Take the next output in order if it was released
+    lock_guard<mutex> lock(pipelineMutex);
+    if (releasedOutputs.empty()) return false;
+    output = move(releasedOutputs.front());
+    releasedOutputs.pop_front();
+    return true;
+}
+
+void FramePipeline::finish() {                                                                                          // Mark the end of the sequence
+    lock_guard<mutex> lock(pipelineMutex);
+    finishing = true;
+    outputCondition.notify_all();
+}
+
+FramePipelinePlan FramePipeline::getPlan() const {                                                                      // Division of the budget, once the first frame ran
+    lock_guard<mutex> lock(pipelineMutex);
+    return plan;
+}
+
+FramePipelineStats FramePipeline::getStats() const {                                                                    // Throughput and latency so far
+    lock_guard<mutex> lock(pipelineMutex);
+    FramePipelineStats current = stats;
+    if (current.framesEmitted == 0) return current;
+
+    double seconds = chrono::duration<double>(lastRelease - firstPush).count();
+    current.throughputFps = (seconds > 0) ? current.framesEmitted / seconds : 0;
+    current.averageFilterMs = totalFilterMs / current.framesEmitted;
+    current.averageLatencyMs = totalLatencyMs / current.framesEmitted;
+    current.addedLatencyMs = max(0.0, current.averageLatencyMs - current.averageFilterMs);
+    return current;
+}
+
+void FramePipeline::printSummary() const {                                                                              // Print the plan, throughput and latency
+    FramePipelinePlan current = getPlan();
+    FramePipelineStats totals = getStats();
+    cout << "Frame pipeline '" << filterName << "': " << modeName(current.mode) << ", " << current.framesInFlight << " frames in flight x "
+         << current.threadsPerFrame << " threads (first frame " << fixed << setprecision(1) << current.frameCostMs << " ms on one thread)" << endl;
+    cout << "  " << totals.framesEmitted << " frames at " << totals.throughputFps << " fps, filtering " << totals.averageFilterMs
+         << " ms, latency " << totals.averageLatencyMs << " ms (+" << totals.addedLatencyMs << " ms queued or reordered), up to "
+         << totals.maxReorderDepth << " frames held back" << defaultfloat << endl;
+}
+
+// Strips are only worth it while each one still takes minStripMs and spans minStripRows. The budget
+// beyond that goes to running more frames at once; filters that need the whole frame only get that.
+FramePipelinePlan FramePipeline::choosePlan(const FilterCapabilities& capabilities, const Size& frameSize, double frameCostMs,
+                                            int threadBudget, const FramePipelineOptions& options) {                    // Divide the budget between frames and strips
+    int budget = max(1, threadBudget);
+    int usefulStrips = 1;
+    if (capabilities.stripParallel && options.minStripMs > 0) {
+        usefulStrips = static_cast<int>(frameCostMs / options.minStripMs);
+        usefulStrips = min(usefulStrips, frameSize.height / max(1, options.minStripRows));
+        usefulStrips = clamp(usefulStrips, 1, budget);
+    }
+
+    FramePipelinePlan chosen;
+    chosen.frameCostMs = frameCostMs;
+    chosen.mode = options.mode;
+    if (chosen.mode == FrameParallelism::Auto) {
+        chosen.mode = (usefulStrips >= budget) ? FrameParallelism::IntraFrame
+                    : (usefulStrips == 1) ? FrameParallelism::InterFrame : FrameParallelism::Hybrid;
+    }
+
+    switch (chosen.mode) {
+        case FrameParallelism::IntraFrame:
+            chosen.threadsPerFrame = capabilities.stripParallel ? budget : 1;
+            chosen.framesInFlight = 1;
+            break;
+        case FrameParallelism::InterFrame:
+            chosen.threadsPerFrame = 1;
+            chosen.framesInFlight = budget;
+            break;
+        default:
+            // Asked for explicitly, hybrid still splits each frame at least in two and runs at least two frames
+            chosen.threadsPerFrame = capabilities.stripParallel ? clamp(usefulStrips, min(2, budget), max(min(2, budget), budget / 2)) : 1;
+            chosen.framesInFlight = max(1, budget / chosen.threadsPerFrame);
+            break;
+    }
+    if (options.framesInFlight > 0) {
+        chosen.framesInFlight = options.framesInFlight;
+    }
+    return chosen;
+}
+
+string FramePipeline::modeName(FrameParallelism mode) {                                                                 // Readable name of a mode
+    switch (mode) {
+        case FrameParallelism::Auto: return "auto";
+        case FrameParallelism::IntraFrame: return "intra-frame";
+        case FrameParallelism::InterFrame: return "inter-frame";
+        case FrameParallelism::Hybrid: return "hybrid";
+    }
+    return "unknown";
+}
@@ -0,0 +1,269 @@
+#include "Headers/FrameRecording.hpp"
+#include "Headers/TraceRecorder.hpp"
+#include <iostream>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CPMULTI_HAS_MMAP 1
+#endif
+
+static_assert(sizeof(RecordingHeader) <= FrameRecorder::PAGE_BYTES, "The file header must fit in the first page");
+static_assert(sizeof(RecordingFrameHeader) <= FrameRecorder::SLOT_DATA_OFFSET, "A frame header must fit before its pixels");
+
+FrameRecorder::FrameRecorder(size_t maxQueuedFrames) : maxQueuedFrames(max<size_t>(1, maxQueuedFrames)) {               // Constructor
+}
+
+FrameRecorder::~FrameRecorder() {                                                                                       // Destructor
+    close();
+}
+
+size_t FrameRecorder::slotBytesFor(const Size& frameSize, int type) {                                                   // Page-aligned slot for one frame
+    size_t bytes = SLOT_DATA_OFFSET + static_cast<size_t>(frameSize.area()) * CV_ELEM_SIZE(type);
+    return (bytes + PAGE_BYTES - 1) / PAGE_BYTES * PAGE_BYTES;
+}
+
+bool FrameRecorder::open(const string& path, const Size& frameSize, int type, PixelFormat format) {                     // Start a recording
+    close();
+    if (frameSize.width <= 0 || frameSize.height <= 0) {
+        cerr << "Error: A recording needs a nonzero frame size." << endl;
+        return false;
+    }
+    file.open(path, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        cerr << "Error: Unable to create recording '" << path << "'" << endl;
+        return false;
+    }
+
+    header = RecordingHeader();
+    memcpy(header.magic, RecordingHeader::MAGIC, sizeof(header.magic));
+    header.headerBytes = static_cast<uint32_t>(PAGE_BYTES);
+    header.slotBytes = slotBytesFor(frameSize, type);
+    header.width = frameSize.width;
+    header.height = frameSize.height;
+    header.type = type;
+    header.format = static_cast<int32_t>(format);
+
+    // The header page is rewritten with the frame count on close
+    vector<char> page(PAGE_BYTES, 0);
+    memcpy(page.data(), &header, sizeof(header));
+    file.write(page.data(), static_cast<streamsize>(page.size()));
+
+    this->path = path;
+    closing = false;
+    written = 0;
+    dropped = 0;
+    writeFailed = false;
+    startedAt = Clock::now();
+    recording = true;
+    writerThread = thread(&FrameRecorder::writerLoop, this);
+    return true;
+}
+
+bool FrameRecorder::append(const Mat& frame) {                                                                          // Queue a copy of a frame for writing
+    if (!recording) return false;
+    if (writeFailed || frame.cols != header.width || frame.rows != header.height || frame.type() != header.type) {
+        dropped++;
+        return false;
+    }
+
+    uint64_t timestampUs = static_cast<uint64_t>(chrono::duration_cast<chrono::microseconds>(Clock::now() - startedAt).count());
+    {
+        lock_guard<mutex> lock(queueMutex);
+        if (queue.size() >= maxQueuedFrames) {
+            dropped++;
+            return false;
+        }
+    }
+    // Copied outside the lock; the capture loop reuses its buffer for the next frame
+    QueuedFrame queued{frame.clone(), timestampUs};
+    {
+        lock_guard<mutex> lock(queueMutex);
+        if (writeFailed) {
+            dropped++;
+            return false;
+        }
+        queue.push_back(move(queued));
+    }
+    queueCondition.notify_one();
+    return true;
+}
+
+void FrameRecorder::writerLoop() {                                                                                      // Write queued frames until closed
+    TRACE_THREAD_NAME("recorder");
+    size_t dataBytes = static_cast<size_t>(header.width) * header.height * CV_ELEM_SIZE(header.type);
+    vector<char> padding(header.slotBytes - SLOT_DATA_OFFSET - dataBytes, 0);
+
+    while (true) {
+        QueuedFrame next;
+        {
+            unique_lock<mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this]() { return closing || !queue.empty(); });
+            if (queue.empty()) return;
+            next = move(queue.front());
+            queue.pop_front();
+        }
+
+        TRACE_SCOPE("record", "io");
+        char slotHeader[SLOT_DATA_OFFSET] = {};
+        RecordingFrameHeader frameHeader;
+        frameHeader.timestampUs = next.timestampUs;
+        frameHeader.width = next.pixels.cols;
+        frameHeader.height = next.pixels.rows;
+        frameHeader.type = next.pixels.type();
+        frameHeader.format = header.format;
+        frameHeader.dataBytes = dataBytes;
+        memcpy(slotHeader, &frameHeader, sizeof(frameHeader));
+
+        file.write(slotHeader, sizeof(slotHeader));
+        file.write(reinterpret_cast<const char*>(next.pixels.data), static_cast<streamsize>(dataBytes));
+        file.write(padding.data(), static_cast<streamsize>(padding.size()));
+        if (!file) {
+            cerr << "Error: Writing to recording '" << path << "' failed." << endl;
+            lock_guard<mutex> lock(queueMutex);
+            writeFailed = true;
+            dropped += queue.size();
+            queue.clear();
+            return;
+        }
+        written++;
+    }
+}
+
+bool FrameRecorder::close() {                                                                                           // Flush the queue and finish the file
+    if (!recording) return true;
+    {
+        lock_guard<mutex> lock(queueMutex);
+        closing = true;
+    }
+    queueCondition.notify_one();
+    writerThread.join();
+
+    header.frameCount = written;
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+    queue.clear();
+    recording = false;
+
+    if (writeFailed) {
+        cerr << "Error: Recording '" << path << "' is incomplete; writing stopped after " << written << " frames." << endl;
+        return false;
+    }
+    return true;
+}
+
+MappedRecording::~MappedRecording() {                                                                                   // Destructor
+    close();
+}
+
+bool MappedRecording::open(const string& path, bool readahead) {                                                        // Map a recording and check its header
+    close();
+#ifdef CPMULTI_HAS_MMAP
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        cerr << "Error: Unable to open recording '" << path << "'" << endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(descriptor, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(RecordingHeader))) {
+        cerr << "Error: '" << path << "' is too short to be a recording." << endl;
+        ::close(descriptor);
+        return false;
+    }
+    mappedBytes = static_cast<size_t>(info.st_size);
+    void* address = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+    ::close(descriptor);    // The mapping keeps the file alive
+    if (address == MAP_FAILED) {
+        cerr << "Error: Unable to map recording '" << path << "'" << endl;
+        mappedBytes = 0;
+        return false;
+    }
+    base = static_cast<uint8_t*>(address);
+    mapped = true;
+    if (readahead) {
+        madvise(base, mappedBytes, MADV_SEQUENTIAL);
+        madvise(base, mappedBytes, MADV_WILLNEED);
+    }
+#else
+    // No mmap here: the file is read once, and frames are still views into that one buffer
+    (void)readahead;
+    ifstream file(path, ios::binary | ios::ate);
+    if (!file.is_open()) {
+        cerr << "Error: Unable to open recording '" << path << "'" << endl;
+        return false;
+    }
+    fallbackBuffer.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(fallbackBuffer.data()), static_cast<streamsize>(fallbackBuffer.size()));
+    if (fallbackBuffer.size() < sizeof(RecordingHeader)) {
+        cerr << "Error: '" << path << "' is too short to be a recording." << endl;
+        fallbackBuffer.clear();
+        return false;
+    }
+    base = fallbackBuffer.data();
+    mappedBytes = fallbackBuffer.size();
+#endif
+
+    memcpy(&header, base, sizeof(header));
+    bool valid = memcmp(header.magic, RecordingHeader::MAGIC, sizeof(header.magic)) == 0 && header.version == RecordingHeader::VERSION &&
+                 header.width > 0 && header.height > 0 && header.headerBytes <= mappedBytes &&
+                 header.slotBytes >= FrameRecorder::slotBytesFor(Size(header.width, header.height), header.type);
+    if (!valid) {
+        cerr << "Error: '" << path << "' is not a recording this version can read." << endl;
+        close();
+        return false;
+    }
+
+    size_t wholeSlots = (mappedBytes - header.headerBytes) / header.slotBytes;
+    frames = (header.frameCount > 0) ? min<size_t>(header.frameCount, wholeSlots) : wholeSlots;
+    return true;
+}
+
+void MappedRecording::close() {                                                                                         // Unmap the file
+#ifdef CPMULTI_HAS_MMAP
+    if (mapped && base) {
+        munmap(base, mappedBytes);
+    }
+#endif
+    fallbackBuffer.clear();
+    base = nullptr;
+    mappedBytes = 0;
+    mapped = false;
+    frames = 0;
+    header = RecordingHeader();
+}
+
+const RecordingFrameHeader& MappedRecording::frameHeader(size_t index) const {                                          // Header at the start of a slot
+    return *reinterpret_cast<const RecordingFrameHeader*>(base + header.headerBytes + index * header.slotBytes);
+}
+
+Mat MappedRecording::frame(size_t index) const {                                                                        // View of a frame's pixels, without a copy
+    if (!base || index >= frames) return Mat();
+    // Slots have a fixed stride, so a frame of another size or type can only be a damaged slot
+    const RecordingFrameHeader& frameInfo = frameHeader(index);
+    if (frameInfo.width != header.width || frameInfo.height != header.height || frameInfo.type != header.type) {
+        cerr << "Error: Frame " << index << " of the recording is damaged." << endl;
+        return Mat();
+    }
+    uint8_t* pixels = base + header.headerBytes + index * header.slotBytes + FrameRecorder::SLOT_DATA_OFFSET;
+    return Mat(frameInfo.height, frameInfo.width, frameInfo.type, pixels);
+}
+
+uint64_t MappedRecording::timestampUs(size_t index) const {                                                             // Capture time of a frame
+    return (base && index < frames) ? frameHeader(index).timestampUs : 0;
+}
+
+void MappedRecording::prefetch(size_t first, size_t count) const {                                                      // Start reading frames in ahead of use
+#ifdef CPMULTI_HAS_MMAP
+    if (!mapped || first >= frames) return;
+    count = min(count, frames - first);
+    madvise(base + header.headerBytes + first * header.slotBytes, count * header.slotBytes, MADV_WILLNEED);
+#else
+    (void)first;
+    (void)count;
+#endif
+}
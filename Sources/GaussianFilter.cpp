@@ -6,9 +6,6 @@ GaussianFilter::GaussianFilter(int size, double sigma)
 }
 
 GaussianFilter::~GaussianFilter() {                                                                     // Destructor
-    #ifdef __APPLE__
-        destroyWindow(windowName);
-    #endif
 }
 
 void GaussianFilter::setKernelSize(int size) {                                                         // Set the kernel size for the Gaussian filter (must be odd)
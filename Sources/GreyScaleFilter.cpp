@@ -4,9 +4,6 @@ GreyScaleFilter::GreyScaleFilter() {                                          //
 }
 
 GreyScaleFilter::~GreyScaleFilter() {                                                                        // Destructor                    
-    #ifdef __APPLE__
-        destroyWindow(windowName);
-    #endif
 }
 
 Mat GreyScaleFilter::applyFilter(const Mat& inputFrame) {                                                   // Apply greyscale filter to the input frame
@@ -20,3 +17,12 @@ Mat GreyScaleFilter::applyFilter(const Mat& inputFrame) {
 
     return grayFrame; // Return the processed greyscale frame
 }
+
+Mat GreyScaleFilter::applyFilter(FrameContext& context, const Rect& region) {                               // Greyscale of a region, converted once per frame
+    if (context.empty()) {
+        cerr << "Error: Empty input frame provided to GreyScaleFilter." << endl;
+        return Mat();
+    }
+
+    return context.grey()(region);
+}
@@ -0,0 +1,144 @@
+#include "Headers/GuidedFilter.hpp"
+#include <iostream>
+
+// Coefficients are rounded to multiples of 1/65536 before they are summed, so every window sum
+// is an integer well inside a double's 53-bit mantissa and does not depend on where the image starts
+static const double FIXED_ONE = 65536.0;
+
+// The four integrals take about 90 MB at 720p, so each thread keeps its buffers between calls.
+// Strips stay well under the cap; buffers for anything larger are released after the call, so a
+// whole-frame run on every worker does not leave budget x 90 MB behind.
+static const size_t MAX_RETAINED_BYTES = size_t(32) << 20;
+
+static Mat reusedBuffer(Mat& storage, int rows, int cols, int type) {
+    if (storage.type() != type || storage.rows < rows || storage.cols < cols) {
+        storage.create(max(rows, storage.rows), max(cols, storage.cols), type);
+    }
+    return storage(Rect(0, 0, cols, rows));
+}
+
+GuidedFilter::GuidedFilter(int radius, float smoothing) {                                                           // Constructor
+    setRadius(radius);
+    setSmoothing(smoothing);
+}
+
+GuidedFilter::~GuidedFilter() {                                                                                     // Destructor
+}
+
+void GuidedFilter::setRadius(int radius) {                                                                          // Update the window radius
+    windowRadius = max(1, radius);
+}
+
+void GuidedFilter::setSmoothing(float smoothing) {                                                                  // Update the smoothing strength in grey levels
+    smoothingLevel = max(1.0f, smoothing);
+}
+
+Mat GuidedFilter::applyFilter(const Mat& inputFrame) {                                                              // Apply the guided filter to the input frame
+    if (inputFrame.empty()) {
+        cerr << "Error: Empty input frame provided to GuidedFilter." << endl;
+        return Mat();
+    }
+    if (inputFrame.depth() != CV_8U) {
+        cerr << "Error: GuidedFilter needs an 8-bit image." << endl;
+        return Mat();
+    }
+
+    const int rows = inputFrame.rows;
+    const int cols = inputFrame.cols;
+    const int channels = inputFrame.channels();
+    const double epsilon = static_cast<double>(smoothingLevel) * smoothingLevel;
+
+    // Sums of I and I^2, then of the coefficients a and b; row y + 1 holds the sums over rows [0, y]
+    static thread_local Mat sumStorage, squaredStorage, storageA, storageB;
+    const int integralType = CV_64FC(channels);
+    Mat sum = reusedBuffer(sumStorage, rows + 1, cols + 1, integralType);
+    Mat squaredSum = reusedBuffer(squaredStorage, rows + 1, cols + 1, integralType);
+    Mat sumA = reusedBuffer(storageA, rows + 1, cols + 1, integralType);
+    Mat sumB = reusedBuffer(storageB, rows + 1, cols + 1, integralType);
+    integral(inputFrame, sum, squaredSum, CV_64F, CV_64F);   // Fills the views in place, they already have the right size and type
+    sumA.row(0).setTo(Scalar::all(0));
+    sumB.row(0).setTo(Scalar::all(0));
+
+    // Window bounds of every column, clipped at the borders, as integral columns
+    vector<int> left(cols), right(cols);
+    for (int x = 0; x < cols; x++) {
+        left[x] = max(0, x - windowRadius) * channels;
+        right[x] = min(cols, x + windowRadius + 1) * channels;
+    }
+
+    // Pass 1: per-pixel a = var / (var + eps) and b = mean * (1 - a), accumulated straight into their integrals
+    vector<double> runningA(channels), runningB(channels);
+    for (int y = 0; y < rows; y++) {
+        int top = max(0, y - windowRadius);
+        int bottom = min(rows, y + windowRadius + 1);
+        const double* sumTop = sum.ptr<double>(top);
+        const double* sumBottom = sum.ptr<double>(bottom);
+        const double* squaredTop = squaredSum.ptr<double>(top);
+        const double* squaredBottom = squaredSum.ptr<double>(bottom);
+        const double* previousA = sumA.ptr<double>(y);
+        const double* previousB = sumB.ptr<double>(y);
+        double* rowA = sumA.ptr<double>(y + 1);
+        double* rowB = sumB.ptr<double>(y + 1);
+        fill(runningA.begin(), runningA.end(), 0.0);
+        fill(runningB.begin(), runningB.end(), 0.0);
+        fill(rowA, rowA + channels, 0.0);
+        fill(rowB, rowB + channels, 0.0);
+
+        for (int x = 0; x < cols; x++) {
+            double count = static_cast<double>((bottom - top) * (right[x] - left[x]) / channels);
+            for (int c = 0; c < channels; c++) {
+                int l = left[x] + c;
+                int r = right[x] + c;
+                double mean = (sumBottom[r] - sumBottom[l] - sumTop[r] + sumTop[l]) / count;
+                double meanSquare = (squaredBottom[r] - squaredBottom[l] - squaredTop[r] + squaredTop[l]) / count;
+                double variance = max(0.0, meanSquare - mean * mean);
+                double a = round(variance / (variance + epsilon) * FIXED_ONE);
+                double b = round(mean * (FIXED_ONE - a));
+
+                int at = (x + 1) * channels + c;
+                runningA[c] += a;
+                runningB[c] += b;
+                rowA[at] = previousA[at] + runningA[c];
+                rowB[at] = previousB[at] + runningB[c];
+            }
+        }
+    }
+
+    // Pass 2: q = mean(a) * I + mean(b), with both means over the same clipped window
+    Mat outputFrame(inputFrame.size(), inputFrame.type());
+    for (int y = 0; y < rows; y++) {
+        int top = max(0, y - windowRadius);
+        int bottom = min(rows, y + windowRadius + 1);
+        const double* aTop = sumA.ptr<double>(top);
+        const double* aBottom = sumA.ptr<double>(bottom);
+        const double* bTop = sumB.ptr<double>(top);
+        const double* bBottom = sumB.ptr<double>(bottom);
+        const uint8_t* source = inputFrame.ptr<uint8_t>(y);
+        uint8_t* target = outputFrame.ptr<uint8_t>(y);
+
+        for (int x = 0; x < cols; x++) {
+            double scale = 1.0 / ((bottom - top) * (right[x] - left[x]) / channels * FIXED_ONE);
+            for (int c = 0; c < channels; c++) {
+                int l = left[x] + c;
+                int r = right[x] + c;
+                double windowA = aBottom[r] - aBottom[l] - aTop[r] + aTop[l];
+                double windowB = bBottom[r] - bBottom[l] - bTop[r] + bTop[l];
+                target[x * channels + c] = saturate_cast<uint8_t>((windowA * source[x * channels + c] + windowB) * scale);
+            }
+        }
+    }
+
+    size_t retainedBytes = 0;
+    for (const Mat* storage : {&sumStorage, &squaredStorage, &storageA, &storageB}) {
+        retainedBytes += storage->total() * storage->elemSize();
+    }
+    if (retainedBytes > MAX_RETAINED_BYTES) {
+        // The views above keep the memory alive until they go out of scope
+        sumStorage.release();
+        squaredStorage.release();
+        storageA.release();
+        storageB.release();
+    }
+
+    return outputFrame;
+}
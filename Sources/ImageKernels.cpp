@@ -0,0 +1,158 @@
+#include "Headers/ImageKernels.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <iostream>
+
+using namespace std;
+
+#ifndef CPMULTI_BUILD_VARIANT
+#define CPMULTI_BUILD_VARIANT "default"
+#endif
+
+namespace ImageKernels {
+
+// Kernel table for one instruction set
+struct KernelTable {
+    IsaLevel level;
+    void (*gradientMagnitude)(const int16_t*, const int16_t*, uint8_t*, size_t);
+    uint64_t (*hash64Rows)(const void*, size_t, size_t, size_t, uint64_t);
+    void (*logMagnitude)(const float*, uint8_t*, size_t, float);
+};
+
+static bool cpuSupports(IsaLevel level) {                                                                               // Ask the CPU, not the compiler
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    switch (level) {
+        case IsaLevel::Generic: return true;
+        case IsaLevel::SSE42: return __builtin_cpu_supports("sse4.2");
+        case IsaLevel::AVX2: return __builtin_cpu_supports("avx2");
+        case IsaLevel::AVX512: return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+    }
+    return false;
+#else
+    return level == IsaLevel::Generic;
+#endif
+}
+
+static bool builtWith(IsaLevel level) {                                                                                 // Whether CMake compiled this level
+    switch (level) {
+        case IsaLevel::Generic: return true;
+#ifdef CPMULTI_HAVE_SSE42
+        case IsaLevel::SSE42: return true;
+#endif
+#ifdef CPMULTI_HAVE_AVX2
+        case IsaLevel::AVX2: return true;
+#endif
+#ifdef CPMULTI_HAVE_AVX512
+        case IsaLevel::AVX512: return true;
+#endif
+        default: return false;
+    }
+}
+
+static KernelTable tableFor(IsaLevel level) {                                                                          // Function pointers of one level
+    switch (level) {
+#ifdef CPMULTI_HAVE_AVX512
+        case IsaLevel::AVX512: return {level, avx512::gradientMagnitude, avx512::hash64Rows, avx512::logMagnitude};
+#endif
+#ifdef CPMULTI_HAVE_AVX2
+        case IsaLevel::AVX2: return {level, avx2::gradientMagnitude, avx2::hash64Rows, avx2::logMagnitude};
+#endif
+#ifdef CPMULTI_HAVE_SSE42
+        case IsaLevel::SSE42: return {level, sse42::gradientMagnitude, sse42::hash64Rows, sse42::logMagnitude};
+#endif
+        default: return {IsaLevel::Generic, generic::gradientMagnitude, generic::hash64Rows, generic::logMagnitude};
+    }
+}
+
+IsaLevel detectIsa() {                                                                                                  // Highest level available here
+    for (IsaLevel level : {IsaLevel::AVX512, IsaLevel::AVX2, IsaLevel::SSE42}) {
+        if (isAvailable(level)) return level;
+    }
+    return IsaLevel::Generic;
+}
+
+static IsaLevel parseIsa(const char* name, IsaLevel fallback) {
+    if (!name) return fallback;
+    string value = name;
+    if (value == "generic") return IsaLevel::Generic;
+    if (value == "sse4.2" || value == "sse42") return IsaLevel::SSE42;
+    if (value == "avx2") return IsaLevel::AVX2;
+    if (value == "avx512") return IsaLevel::AVX512;
+    cerr << "Warning: Unknown CPMULTI_ISA '" << value << "', using " << isaName(fallback) << "." << endl;
+    return fallback;
+}
+
+static const KernelTable& activeTable() {                                                                               // Chosen once, on first use
+    static const KernelTable table = []() {
+        IsaLevel best = detectIsa();
+        IsaLevel requested = parseIsa(getenv("CPMULTI_ISA"), best);
+        // An override can only lower the level; running unsupported instructions would crash
+        if (static_cast<int>(requested) > static_cast<int>(best)) {
+            cerr << "Warning: CPMULTI_ISA=" << isaName(requested) << " is not available, using " << isaName(best) << "." << endl;
+            requested = best;
+        }
+        while (!builtWith(requested)) {
+            requested = static_cast<IsaLevel>(static_cast<int>(requested) - 1);
+        }
+        return tableFor(requested);
+    }();
+    return table;
+}
+
+bool isAvailable(IsaLevel level) {
+    return builtWith(level) && cpuSupports(level);
+}
+
+IsaLevel activeIsa() {
+    return activeTable().level;
+}
+
+const char* isaName(IsaLevel level) {
+    switch (level) {
+        case IsaLevel::Generic: return "generic";
+        case IsaLevel::SSE42: return "sse4.2";
+        case IsaLevel::AVX2: return "avx2";
+        case IsaLevel::AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+const char* buildVariant() {
+    return CPMULTI_BUILD_VARIANT;
+}
+
+void gradientMagnitude(const int16_t* gx, const int16_t* gy, uint8_t* out, size_t count) {
+    activeTable().gradientMagnitude(gx, gy, out, count);
+}
+
+void gradientMagnitude(IsaLevel level, const int16_t* gx, const int16_t* gy, uint8_t* out, size_t count) {
+    tableFor(isAvailable(level) ? level : IsaLevel::Generic).gradientMagnitude(gx, gy, out, count);
+}
+
+uint64_t hash64(const void* data, size_t length, uint64_t seed) {
+    return activeTable().hash64Rows(data, length, 1, length, seed);
+}
+
+uint64_t hash64(IsaLevel level, const void* data, size_t length, uint64_t seed) {
+    return tableFor(isAvailable(level) ? level : IsaLevel::Generic).hash64Rows(data, length, 1, length, seed);
+}
+
+uint64_t hash64Rows(const void* data, size_t rowBytes, size_t rows, size_t stride, uint64_t seed) {
+    return activeTable().hash64Rows(data, rowBytes, rows, stride, seed);
+}
+
+uint64_t hash64Rows(IsaLevel level, const void* data, size_t rowBytes, size_t rows, size_t stride, uint64_t seed) {
+    return tableFor(isAvailable(level) ? level : IsaLevel::Generic).hash64Rows(data, rowBytes, rows, stride, seed);
+}
+
+void logMagnitude(const float* spectrum, uint8_t* out, size_t count, float scale) {
+    activeTable().logMagnitude(spectrum, out, count, scale);
+}
+
+void logMagnitude(IsaLevel level, const float* spectrum, uint8_t* out, size_t count, float scale) {
+    tableFor(isAvailable(level) ? level : IsaLevel::Generic).logMagnitude(spectrum, out, count, scale);
+}
+
+} // namespace ImageKernels
@@ -0,0 +1,204 @@
+#include "Headers/ImageKernels.hpp"
+#include <cstring>
+
+// Compiled once per instruction set by CMake, which sets CPMULTI_KERNEL_NAMESPACE and the
+// matching -m flags. The loops are written so the compiler vectorizes them at every level.
+#ifndef CPMULTI_KERNEL_NAMESPACE
+#define CPMULTI_KERNEL_NAMESPACE generic
+#endif
+
+namespace ImageKernels {
+namespace CPMULTI_KERNEL_NAMESPACE {
+
+static inline int saturatedAbs(int16_t value) {
+    int magnitude = value < 0 ? -value : value;
+    return magnitude > 255 ? 255 : magnitude;
+}
+
+static inline uint8_t averageRoundEven(int a, int b) {
+    int sum = a + b;
+    int half = sum >> 1;
+    return static_cast<uint8_t>(half + (sum & half & 1));
+}
+
+void gradientMagnitude(const int16_t* __restrict gx, const int16_t* __restrict gy, uint8_t* __restrict out, size_t count) {
+    if (gx && gy) {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = averageRoundEven(saturatedAbs(gx[i]), saturatedAbs(gy[i]));
+        }
+    } else if (gx || gy) {
+        const int16_t* __restrict gradient = gx ? gx : gy;
+        for (size_t i = 0; i < count; i++) {
+            out[i] = averageRoundEven(saturatedAbs(gradient[i]), 0);
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = 0;
+        }
+    }
+}
+
+// Bit-level approximations that vectorize at every level, unlike sqrtf and log2f, which the
+// compiler keeps scalar because they may set errno. One Newton step leaves sqrt within 0.2%;
+// the polynomial fits log2 over each mantissa octave to within 2e-4.
+static inline float approximateSqrt(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bits = 0x5F3759DFu - (bits >> 1);
+    float inverse;
+    memcpy(&inverse, &bits, sizeof(inverse));
+    inverse *= 1.5f - 0.5f * value * inverse * inverse;
+    return value * inverse;
+}
+
+static inline float approximateLog2(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    float exponent = static_cast<float>(static_cast<int>(bits >> 23) - 127);
+    bits = (bits & 0x007FFFFFu) | 0x3F800000u;
+    float mantissa;
+    memcpy(&mantissa, &bits, sizeof(mantissa));
+    float t = mantissa - 1.0f;
+    return exponent + t * (1.43854679f + t * (-0.678081486f + t * (0.323630368f - 0.0842850926f * t)));
+}
+
+void logMagnitude(const float* __restrict spectrum, uint8_t* __restrict out, size_t count, float scale) {
+    for (size_t i = 0; i < count; i++) {
+        float re = spectrum[2 * i];
+        float im = spectrum[2 * i + 1];
+        float level = approximateLog2(1.0f + approximateSqrt(re * re + im * im)) * scale + 0.5f;
+        level = level < 0.0f ? 0.0f : (level > 255.0f ? 255.0f : level);
+        out[i] = static_cast<uint8_t>(static_cast<int>(level));
+    }
+}
+
+// Content hash in the style of XXH3: eight 64-bit lanes take one 64-byte stripe per step, each
+// stripe keyed by its position within a block of 16, and the lanes are scrambled after every block.
+// The lane loop is what gets vectorized (32x32->64 multiplies); the result is the same at every level.
+static constexpr uint64_t PRIME32_1 = 0x9E3779B1ULL;
+static constexpr uint64_t PRIME32_2 = 0x85EBCA77ULL;
+static constexpr uint64_t PRIME32_3 = 0xC2B2AE3DULL;
+static constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+static constexpr uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+static constexpr int LANES = 8;
+static constexpr int STRIPE_BYTES = 64;
+static constexpr int STRIPES_PER_BLOCK = 16;
+
+// Key material: lanes read keys [stripe, stripe + 8), the scramble reads the last eight
+struct HashSecret {
+    uint64_t keys[STRIPES_PER_BLOCK + LANES];
+};
+
+static constexpr HashSecret makeSecret() {
+    HashSecret secret{};
+    uint64_t state = PRIME64_5;
+    for (int i = 0; i < STRIPES_PER_BLOCK + LANES; i++) {
+        // splitmix64
+        state += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        secret.keys[i] = z ^ (z >> 31);
+    }
+    return secret;
+}
+
+static constexpr HashSecret SECRET = makeSecret();
+
+static inline void accumulateStripe(uint64_t* __restrict acc, const uint8_t* stripe, const uint64_t* __restrict keys) {
+    for (int i = 0; i < LANES; i++) {
+        uint64_t value;
+        memcpy(&value, stripe + 8 * i, sizeof(value));
+        uint64_t keyed = value ^ keys[i];
+        acc[i ^ 1] += value;
+        acc[i] += (keyed & 0xFFFFFFFFULL) * (keyed >> 32);
+    }
+}
+
+static inline void scramble(uint64_t* __restrict acc, const uint64_t* __restrict keys) {
+    for (int i = 0; i < LANES; i++) {
+        uint64_t lane = acc[i];
+        lane ^= lane >> 47;
+        lane ^= keys[i];
+        acc[i] = lane * PRIME32_1;
+    }
+}
+
+static inline uint64_t foldedMultiply(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+    __uint128_t product = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+    uint64_t low = a * b;
+    uint64_t high = (a >> 32) * (b >> 32) + (((a & 0xFFFFFFFFULL) * (b >> 32)) >> 32) + (((a >> 32) * (b & 0xFFFFFFFFULL)) >> 32);
+    return low ^ high;
+#endif
+}
+
+uint64_t hash64(const void* data, size_t length, uint64_t seed) {
+    return hash64Rows(data, length, 1, length, seed);
+}
+
+// Rows are fed as one stream: a stripe that straddles two rows is gathered into a small buffer,
+// and every whole stripe is read in place, so the value is that of the rows stored back to back
+uint64_t hash64Rows(const void* data, size_t rowBytes, size_t rows, size_t stride, uint64_t seed) {
+    uint64_t acc[LANES] = {PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3, PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1};
+    uint64_t keys[STRIPES_PER_BLOCK + LANES];
+    for (int i = 0; i < STRIPES_PER_BLOCK + LANES; i++) {
+        keys[i] = SECRET.keys[i] + seed;
+    }
+
+    size_t stripes = 0;
+    auto consume = [&](const uint8_t* stripe) {
+        int inBlock = static_cast<int>(stripes % STRIPES_PER_BLOCK);
+        accumulateStripe(acc, stripe, keys + inBlock);
+        if (inBlock == STRIPES_PER_BLOCK - 1) {
+            scramble(acc, keys + STRIPES_PER_BLOCK);
+        }
+        stripes++;
+    };
+
+    // The tail is zero-padded into one more stripe; the length below tells paddings apart
+    uint8_t pending[STRIPE_BYTES] = {};
+    size_t pendingBytes = 0;
+    for (size_t row = 0; row < rows; row++) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data) + row * stride;
+        size_t offset = 0;
+        if (pendingBytes > 0) {
+            size_t room = STRIPE_BYTES - pendingBytes;
+            size_t take = rowBytes < room ? rowBytes : room;
+            memcpy(pending + pendingBytes, bytes, take);
+            pendingBytes += take;
+            offset = take;
+            if (pendingBytes < STRIPE_BYTES) continue;
+            consume(pending);
+            pendingBytes = 0;
+        }
+        for (; offset + STRIPE_BYTES <= rowBytes; offset += STRIPE_BYTES) {
+            consume(bytes + offset);
+        }
+        memcpy(pending, bytes + offset, rowBytes - offset);
+        pendingBytes = rowBytes - offset;
+    }
+    if (pendingBytes > 0) {
+        memset(pending + pendingBytes, 0, STRIPE_BYTES - pendingBytes);
+        accumulateStripe(acc, pending, keys + STRIPES_PER_BLOCK - 1);
+    }
+
+    size_t length = rowBytes * rows;
+
+    uint64_t result = length * PRIME64_1 + seed;
+    for (int i = 0; i < LANES; i += 2) {
+        result += foldedMultiply(acc[i] ^ keys[i + 1], acc[i + 1] ^ keys[i + 2]);
+    }
+    result ^= result >> 37;
+    result *= 0x165667919E3779F9ULL;
+    return result ^ (result >> 32);
+}
+
+} // namespace CPMULTI_KERNEL_NAMESPACE
+} // namespace ImageKernels
@@ -1,19 +1,33 @@
 #include "Headers/KeyHandler.hpp"
 
+// Filters covered by the benchmark suites
+static const vector<string> BENCHMARK_FILTERS = {"greyscale", "gaussian", "median", "denoising", "guided", "canny", "sobel", "fourier", "rotate"};
+
 KeyHandler::KeyHandler(MultiThreadImageProcessor& processor, string resourcesPath)                                      // Constructor setting up the filter map and visualization
-    : imageProcessor(processor), resourcesPath(resourcesPath) {
+    : imageProcessor(processor), resourcesPath(resourcesPath), benchmarkRunner(processor),
+      benchmarkStore(resourcesPath + "/benchmark_results.tsv") {
     setupFilterMap();
     setupVisualization();
 }
 
+KeyHandler::~KeyHandler() {                                                                                             // Destructor waiting for pending snapshot archives and filters
+    if (pendingArchive.valid()) {
+        pendingArchive.wait();
+    }
+    for (auto& pending : pendingFilters) {
+        pending.result.wait();
+    }
+}
+
 void KeyHandler::setupFilterMap() {                                                                                     // Set up the filter map with key-value pairs
     filterMap['g'] = "greyscale";
     filterMap['i'] = "gaussian";
     filterMap['o'] = "median";
     filterMap['p'] = "denoising";
+    filterMap['u'] = "guided";
     filterMap['c'] = "canny";
     filterMap['k'] = "sobel";
-    filterMap['l'] = "fourier";
+    filterMap['l'] = "fourier8";    // 8-bit spectrum, shown and saved as is
     filterMap['m'] = "resize";
     filterMap['n'] = "rotate";
     filterMap['x'] = "cut_lines";
@@ -26,6 +40,7 @@ void KeyHandler::setupFilterMap() {
     filterMap['6'] = "visualize_sobel";
     filterMap['7'] = "visualize_fourier";
     filterMap['8'] = "visualize_rotate";
+    filterMap['9'] = "visualize_guided";
 }
 
 void KeyHandler::setupVisualization(const string& filterType) {                                                          // Set up the visualization configuration
@@ -65,8 +80,18 @@ bool KeyHandler::handleKeyPress(char key, Mat& frame) {
         return true;
     }
 
+    if (key == 'y') {
+        cyclePlotMode();
+        return true;
+    }
+
+    if (key == 'r') {
+        handleResolutionSweep();
+        return true;
+    }
+
     // Individual filter visualizations
-    if (key >= '1' && key <= '8') {
+    if (key >= '1' && key <= '9') {
         string filter;
         switch(key) {
             case '1': filter = "greyscale"; break;
@@ -77,6 +102,7 @@ bool KeyHandler::handleKeyPress(char key, Mat& frame) {
             case '6': filter = "sobel"; break;
             case '7': filter = "fourier"; break;
             case '8': filter = "rotate"; break;
+            case '9': filter = "guided"; break;
             default: break;
         }
         handleVisualizationRequest(filter);
@@ -91,36 +117,87 @@ bool KeyHandler::handleKeyPress(char key, Mat& frame) {
 }
 
 void KeyHandler::handleFilterCase(const char key, const Mat& frame) {
-    imwrite(resourcesPath + "/snapshot.jpg", frame);
-    Mat savedSnapshot = loadSnapshot("snapshot.jpg");
-    if (savedSnapshot.empty()) return;
+    if (frame.empty()) {
+        cerr << "Error: Empty frame provided" << endl;
+        return;
+    }
+    archiveSnapshot(frame);
 
     auto it = filterMap.find(key);
     if (it != filterMap.end()) {
         string filterName = it->second;
-        auto [resultFrame, duration] = imageProcessor.sequentialFilter(filterName, savedSnapshot);
-        
-        if (!resultFrame.empty()) {
-            namedWindow(filterName + " Feed", WINDOW_NORMAL);
-            resizeWindow(filterName + " Feed", 800, 600);
-            imshow(filterName + " Feed", resultFrame);
-            cout << filterName << " processing time (sequential): " << duration << " us" << endl;
-            
-            // Save the filtered image
-            saveFilteredImage(resultFrame, filterName, false);
+        bool running = any_of(pendingFilters.begin(), pendingFilters.end(), [&](const PendingFilter& pending) {
+            return pending.filterName == filterName;
+        });
+        if (running) {
+            cout << filterName << " is still running on the previous frame." << endl;
+            return;
         }
+
+        // The feed keeps updating while the filter runs on the pool; the result is shown by
+        // showFinishedFilters. The capture buffer is reused for the next frame, so the filter
+        // gets its own copy.
+        pendingFilters.push_back({filterName, imageProcessor.submitSequential(filterName, frame.clone())});
     } else {
         cerr << "Error: Unknown filter key '" << key << "'" << endl;
     }
 }
 
+void KeyHandler::showFinishedFilters() {                                                                                        // Display the filters that finished since the last call
+    for (auto pending = pendingFilters.begin(); pending != pendingFilters.end();) {
+        if (!pending->result.isReady()) {
+            ++pending;
+            continue;
+        }
+
+        try {
+            auto [resultFrame, duration] = pending->result.get();
+            if (!resultFrame.empty()) {
+                namedWindow(pending->filterName + " Feed", WINDOW_NORMAL);
+                resizeWindow(pending->filterName + " Feed", 800, 600);
+                imshow(pending->filterName + " Feed", resultFrame);
+                cout << pending->filterName << " processing time (sequential): " << duration << " us" << endl;
+                // Saved here rather than on the pool, so it never races a benchmark writing the same file
+                saveFilteredImage(resultFrame, pending->filterName, false);
+            }
+        } catch (const exception& e) {
+            cerr << "Error: " << pending->filterName << " failed: " << e.what() << endl;
+        }
+        pending = pendingFilters.erase(pending);
+    }
+}
+
+
+void KeyHandler::setArchiveSnapshots(bool enabled) {                                                                        // Enable or disable the asynchronous snapshot archive
+    archiveSnapshots = enabled;
+}
+
+void KeyHandler::archiveSnapshot(const Mat& frame) {                                                                        // Write a copy of the frame to disk without blocking the caller
+    if (!archiveSnapshots) return;
 
-Mat KeyHandler::loadSnapshot(const string& filename) {                                                                      // Load the snapshot image from the file
-    Mat snapshot = imread(resourcesPath + "/" + filename);
-    if (snapshot.empty()) {
-        cerr << "Error: Unable to load snapshot image." << endl;
+    // Every snapshot goes to the same file, so a key pressed while the last one is still being
+    // written is not archived rather than racing it
+    if (pendingArchive.valid() && pendingArchive.wait_for(chrono::seconds(0)) != future_status::ready) {
+        cout << "Previous snapshot is still being written; this one is not archived." << endl;
+        return;
     }
-    return snapshot;
+
+    // The capture buffer is reused for the next frame, so the writer gets its own copy
+    Mat archiveCopy = frame.clone();
+    string fullPath = resourcesPath + "/snapshot.jpg";
+    pendingArchive = async(launch::async, [archiveCopy, fullPath]() {
+        TRACE_SCOPE("archive snapshot", "io");
+        if (!imwrite(fullPath, archiveCopy)) {
+            cerr << "Error: Unable to archive the snapshot." << endl;
+        }
+    });
+}
+
+string KeyHandler::describeFrame(const Mat& frame) const {                                                                  // Describe the exact frame handed to the processor
+    stringstream ss;
+    ss << "in-memory frame " << frame.cols << "x" << frame.rows
+       << ", " << frame.channels() << " channel(s), " << frame.elemSize1() * 8 << "-bit, uncompressed";
+    return ss.str();
 }
 
 bool KeyHandler::processFilter(const Mat& frame, const string& filterName) {                                                // Process the filter and display the result
@@ -132,38 +209,64 @@ bool KeyHandler::processFilter(const Mat& frame, const string& filterName) {
         cout << filterName << " processing time with " << imageProcessor.getNumThreads() 
              << " threads: " << duration << " us" << endl;
 
-        saveFilteredImage(resultFrame, filterName, true);
+        string savable = imageProcessor.getSavableFilter(filterName);
+        saveFilteredImage(savable == filterName ? resultFrame : imageProcessor.applyFilter(savable, frame), filterName, true);
         return true;
     }
     return false;
 }
 
 void KeyHandler::handleTestCase(const Mat& frame) {                                                                         // Handle the test case for all filters with different threads
-    imwrite(resourcesPath + "/snapshot.jpg", frame);
-    Mat savedSnapshot = loadSnapshot("snapshot.jpg");
-    if (savedSnapshot.empty()) return;
+    if (frame.empty()) {
+        cerr << "Error: Empty frame provided" << endl;
+        return;
+    }
+    archiveSnapshot(frame);
+
+    // Benchmark the live frame itself rather than a JPEG-decoded copy of it
+    benchmarkInput = describeFrame(frame);
 
-    vector<string> filters = {"greyscale", "gaussian", "median", "denoising", "canny", "sobel", "fourier", "rotate"};
+    const vector<string>& filters = BENCHMARK_FILTERS;
     performanceData.clear();
+    benchmarkSamples.clear();
     
     cout << "\nStarting performance tests...\n";
+    cout << "Benchmark input: " << benchmarkInput << endl;
+    cout << "Build: " << ImageKernels::buildVariant() << ", kernels: " << ImageKernels::isaName(ImageKernels::activeIsa()) << endl;
+    if (benchmarkOptions.collectCounters && !benchmarkRunner.countersAvailable()) {
+        cout << "Hardware counters unavailable (" << benchmarkRunner.getCountersUnavailableReason()
+             << "), reporting wall time only." << endl;
+    }
+    setupVisualization("all");
+    applyPlotMode();
     for (const auto& filterName : filters) {
         cout << "\nTesting " << filterName << " Filter:" << endl;
         
         // Show each filter result before moving to the next one
-        auto [resultFrame, duration] = imageProcessor.applyFilterTimed(filterName, savedSnapshot);
+        auto [resultFrame, duration] = imageProcessor.applyFilterTimed(filterName, frame);
         if (!resultFrame.empty()) {
             namedWindow(filterName + " Feed", WINDOW_NORMAL);
             resizeWindow(filterName + " Feed", 800, 600);
             imshow(filterName + " Feed", resultFrame);
+            refreshPlots();
             waitKey(500);
         }
         
-        performThreadingTest(savedSnapshot, filterName);
+        performThreadingTest(frame, filterName);
+
+        // The plot grows by one series per filter; it is rendered while the next filter runs
+        performanceViz.plotPerformance(plotDataFor(performanceData));
     }
 
     generatePerformanceGraph();
-    cout << "\nPerformance testing completed. Use these keys for visualization:\n"
+    reportScalingFits(performanceData);
+
+    // Every run is appended, so builds can be compared later with --compare
+    RunMetadata metadata = RunMetadata::collect(imageProcessor.getDefaultOptions(), benchmarkInput);
+    if (benchmarkStore.append(metadata, benchmarkSamples)) {
+        cout << "Results stored as run " << metadata.runId << " (" << metadata.gitHash << ")." << endl;
+    }
+    cout << "\nPerformance testing completed on " << benchmarkInput << ". Use these keys for visualization:\n"
         << "  'v' - View all filters\n"
         << "  '1' - Greyscale filter only\n"
         << "  '2' - Gaussian filter only\n"
@@ -172,7 +275,9 @@ void KeyHandler::handleTestCase(const Mat& frame) {
         << "  '5' - Canny filter only\n"
         << "  '6' - Sobel filter only\n"
         << "  '7' - Fourier filter only\n"
-        << "  '8' - Rotate filter only\n";
+        << "  '8' - Rotate filter only\n"
+        << "  '9' - Guided filter only\n"
+        << "  'y' - Cycle time / speedup / efficiency / scaling fit views\n";
 
     waitKey(1);
 }
@@ -182,44 +287,27 @@ void KeyHandler::performThreadingTest(const Mat& snapshot, const string& filterN
     vector<double>& timings = performanceData[filterName];
     timings.clear();
 
-    for (int threads = 1; threads <= 10; threads++) {
-        imageProcessor.setNumThreads(threads);
-        
-        const int numTrials = 3;
-        double totalDuration = 0;
-        Mat resultFrame;
-        
-        for (int trial = 0; trial < numTrials; trial++) {
-            auto [result, duration] = imageProcessor.applyFilterTimed(filterName, snapshot);
-            totalDuration += duration;
-            
-            // Keep the last result for saving
-            if (trial == numTrials - 1) {
-                resultFrame = result;
-            }
-        }
-        
-        double avgDuration = totalDuration / numTrials;
-        timings.push_back(avgDuration);
-        
-        cout << filterName << " processing time with " << threads 
-             << " threads: " << avgDuration << " us" << endl;
-        
-        // Save only the optimal thread version at the end of the test
-        if (threads == 1) {
-            // Save sequential version
-            saveFilteredImage(resultFrame, filterName, false);
-        } 
+    // Each thread count gets its own options so the processor defaults are left untouched
+    BenchmarkOptions options = benchmarkOptions;
+    options.execution = imageProcessor.getDefaultOptions();
+
+    // The sweep keeps the sequential output and the one at the optimal thread count, so nothing is filtered again to save them
+    Mat sequentialFrame, optimalFrame;
+    vector<BenchmarkSample>& samples = benchmarkSamples[filterName];
+    samples = benchmarkRunner.runThreadSweep(filterName, snapshot, options, &sequentialFrame, &optimalFrame);
+    for (const auto& sample : samples) {
+        timings.push_back(sample.meanUs);
     }
-    
-    // Find optimal thread count and save that version
-    auto minElement = min_element(timings.begin(), timings.end());
-    int optimalThreads = distance(timings.begin(), minElement) + 1;
-    
-    // Apply the filter with optimal threads once more and save it
-    imageProcessor.setNumThreads(optimalThreads);
-    auto [optimalResult, _] = imageProcessor.applyFilterTimed(filterName, snapshot);
-    saveFilteredImage(optimalResult, filterName, true);
+
+    // The timed filter's own output is saved unless it is not 8-bit, like the float Fourier
+    // spectrum; then its 8-bit variant filters the same frame for the saved images
+    string savable = imageProcessor.getSavableFilter(filterName);
+    if (savable != filterName) {
+        sequentialFrame = imageProcessor.applyFilter(savable, snapshot);
+        optimalFrame = sequentialFrame;
+    }
+    saveFilteredImage(sequentialFrame, filterName, false);
+    saveFilteredImage(optimalFrame, filterName, true);
 
     showPerformanceStats(filterName, timings);
 }
@@ -239,7 +327,23 @@ void KeyHandler::showPerformanceStats(const string& filterName, const vector<dou
          << "  Average time: " << fixed << setprecision(2) << mean << " us\n"
          << "  Best time: " << min_time << " us (with " << optimal_threads << " threads)\n"
          << "  Worst time: " << max_time << " us\n"
-         << "  Performance range: " << (max_time - min_time) << " us\n\n";
+         << "  Performance range: " << (max_time - min_time) << " us\n";
+    auto samples = benchmarkSamples.find(filterName);
+    if (samples != benchmarkSamples.end() && optimal_threads <= static_cast<int>(samples->second.size())) {
+        const BenchmarkSample& best = samples->second[optimal_threads - 1];
+        if (best.counters.valid) {
+            cout << "  IPC at best: " << best.counters.ipc() << ", memory traffic: " << best.bytesPerPixel << " B/px\n";
+        }
+    }
+    if (!benchmarkInput.empty()) {
+        cout << "  Input: " << benchmarkInput << "\n";
+    }
+    cout << "\n";
+}
+
+void KeyHandler::refreshPlots() {                                                                                               // Show plots and filter results finished in the background
+    performanceViz.showLatestPlot();
+    showFinishedFilters();
 }
 
 void KeyHandler::generatePerformanceGraph() {                                                                                   // Generate the performance graph for all filters             
@@ -253,18 +357,169 @@ void KeyHandler::handleVisualizationRequest(const string& filterType) {
     }
 
     setupVisualization(filterType);
+    applyPlotMode();
+    lastVisualization = filterType;
 
     if (filterType != "all") {
         unordered_map<string, vector<double>> singleFilterData;
         if (performanceData.find(filterType) != performanceData.end()) {
             singleFilterData[filterType] = performanceData[filterType];
-            performanceViz.plotPerformance(singleFilterData);
+            performanceViz.plotPerformance(plotDataFor(singleFilterData));
             showPerformanceStats(filterType, performanceData[filterType]);
+            if (plotMode == PlotMode::ScalingFit) {
+                reportScalingFits(singleFilterData);
+            }
         } else {
             cout << "No data available for filter: " << filterType << endl;
         }
     } else {
-        performanceViz.plotPerformance(performanceData);
+        performanceViz.plotPerformance(plotDataFor(performanceData));
+        if (plotMode == PlotMode::ScalingFit) {
+            reportScalingFits(performanceData);
+        }
+    }
+}
+
+void KeyHandler::handleResolutionSweep(bool quick) {                                                                             // Time every filter across resolutions and content classes
+    SweepOptions options;
+    options.execution = imageProcessor.getDefaultOptions();
+    int hardwareThreads = max(1, static_cast<int>(thread::hardware_concurrency()));
+    options.threadCounts = {1};
+    if (hardwareThreads > 1) {
+        options.threadCounts.push_back(hardwareThreads);
+    }
+    if (quick) {
+        // Short enough to run as the PGO training workload, large enough to reach every code path
+        options.resolutions.erase(remove_if(options.resolutions.begin(), options.resolutions.end(),
+                                            [](const Size& size) { return size.area() > 1920 * 1080; }),
+                                  options.resolutions.end());
+        options.trials = 1;
+    }
+
+    cout << "\nBuild: " << ImageKernels::buildVariant() << ", kernels: " << ImageKernels::isaName(ImageKernels::activeIsa()) << endl;
+    cout << "Starting resolution sweep (" << options.resolutions.size() << " sizes, " << options.contents.size()
+         << " content classes)...\n";
+    vector<SweepPoint> points = benchmarkRunner.runResolutionSweep(BENCHMARK_FILTERS, options);
+
+    // Raw data for further analysis
+    string csvPath = resourcesPath + "/resolution_sweep.csv";
+    ofstream csv(csvPath);
+    if (csv) {
+        csv << "filter,content,width,height,threads,mean_us,us_per_megapixel\n";
+        for (const auto& point : points) {
+            csv << point.filterName << "," << SyntheticContent::name(point.content) << "," << point.size.width << ","
+                << point.size.height << "," << point.threads << "," << point.meanUs << "," << point.usPerMegapixel << "\n";
+        }
+        cout << "Sweep results saved to " << csvPath << endl;
+    } else {
+        cerr << "Error: Unable to write " << csvPath << endl;
+    }
+
+    // One plot per filter: time per megapixel against resolution, a series per content class and thread count
+    vector<string> resolutionLabels;
+    for (const auto& size : options.resolutions) {
+        resolutionLabels.push_back(to_string(size.width) + "x" + to_string(size.height));
+    }
+    for (const auto& filterName : BENCHMARK_FILTERS) {
+        unordered_map<string, vector<double>> series;
+        for (const auto& point : points) {
+            if (point.filterName != filterName) continue;
+            series[SyntheticContent::name(point.content) + " x" + to_string(point.threads)].push_back(point.usPerMegapixel);
+        }
+        if (series.empty()) continue;
+
+        PerformanceVisualization::PlotConfig config;
+        config.title = filterName + " Time per Megapixel";
+        config.xLabel = "Resolution";
+        config.yLabel = "Time per MP";
+        config.yUnit = "(us/MP)";
+        config.yScaleDivisor = 1;
+        config.valueSuffix = " us/MP";
+        config.showValues = false;
+        config.xTickLabels = resolutionLabels;
+        config.xTickCount = static_cast<int>(resolutionLabels.size());
+        config.xPoints = static_cast<int>(resolutionLabels.size());
+        config.windowName = "Resolution Sweep";
+        config.outputName = "resolution_sweep_" + filterName + ".png";
+        performanceViz.setConfig(config);
+        performanceViz.plotPerformance(series);
+    }
+    // Each filter has its own output, so no plot replaces another in the render queue
+    cout << "Resolution sweep completed; plots are being written to " << resourcesPath << "/resolution_sweep_<filter>.png." << endl;
+}
+
+void KeyHandler::cyclePlotMode() {                                                                                              // Switch to the next scaling view and redraw
+    static const char* names[] = {"time", "speedup", "efficiency", "scaling fit"};
+    plotMode = static_cast<PlotMode>((static_cast<int>(plotMode) + 1) % 4);
+    cout << "Plot mode: " << names[static_cast<int>(plotMode)] << endl;
+    handleVisualizationRequest(lastVisualization);
+}
+
+void KeyHandler::applyPlotMode() {                                                                                              // Adjust axes and labels to the current view
+    if (plotMode == PlotMode::Time) return;
+
+    PerformanceVisualization::PlotConfig& config = performanceViz.getConfig();
+    config.yScaleDivisor = 1;
+    config.valuePrecision = 1;
+    if (plotMode == PlotMode::Efficiency) {
+        config.title += " - Parallel Efficiency";
+        config.yLabel = "Efficiency";
+        config.yUnit = "(%)";
+        config.valueSuffix = "%";
+        config.valuePrecision = 0;
+    } else {
+        config.title += (plotMode == PlotMode::Speedup) ? " - Speedup" : " - USL Fit";
+        config.yLabel = "Speedup";
+        config.yUnit = "(x 1 thread)";
+        config.valueSuffix = "x";
+    }
+
+    // Single-filter plots have one colour; the fitted curve gets grey
+    if (plotMode == PlotMode::ScalingFit && config.colors.size() == 1) {
+        config.colors.push_back(Scalar(128, 128, 128));
+    }
+}
+
+unordered_map<string, vector<double>> KeyHandler::plotDataFor(const unordered_map<string, vector<double>>& timings) const {     // Turn timings into the series of the current view
+    unordered_map<string, vector<double>> series;
+    for (const auto& [filterName, times] : timings) {
+        switch (plotMode) {
+            case PlotMode::Time:
+                series[filterName] = times;
+                break;
+            case PlotMode::Speedup:
+                series[filterName] = ScalingAnalysis::speedup(times);
+                break;
+            case PlotMode::Efficiency:
+                series[filterName] = ScalingAnalysis::efficiency(times);
+                for (double& value : series[filterName]) value *= 100.0;
+                break;
+            case PlotMode::ScalingFit: {
+                // Measured speedup next to the fitted USL curve
+                series[filterName] = ScalingAnalysis::speedup(times);
+                ScalingFit fit = ScalingAnalysis::fit(filterName, times);
+                vector<double>& curve = series[filterName + " USL"];
+                for (size_t i = 0; i < times.size(); i++) {
+                    curve.push_back(ScalingAnalysis::uslSpeedup(fit.uslSigma, fit.uslKappa, static_cast<double>(i + 1)));
+                }
+                break;
+            }
+        }
+    }
+    return series;
+}
+
+void KeyHandler::reportScalingFits(const unordered_map<string, vector<double>>& timings) {                                     // Print and save Amdahl and USL fits
+    vector<ScalingFit> fits;
+    for (const auto& [filterName, times] : timings) {
+        fits.push_back(ScalingAnalysis::fit(filterName, times));
+    }
+    sort(fits.begin(), fits.end(), [](const ScalingFit& a, const ScalingFit& b) { return a.filterName < b.filterName; });
+
+    ScalingAnalysis::printFits(fits);
+    string path = resourcesPath + "/scaling_fit.csv";
+    if (ScalingAnalysis::writeCsv(path, fits)) {
+        cout << "Scaling fit saved to " << path << endl;
     }
 }
 
@@ -274,13 +529,16 @@ void KeyHandler::handleAllFiltersWithCutLines(const Mat& frame) {
         return;
     }
 
-    // Save current frame
-    imwrite(resourcesPath + "/snapshot.jpg", frame);
-    Mat savedSnapshot = loadSnapshot("snapshot.jpg");
-    if (savedSnapshot.empty()) return;
+    archiveSnapshot(frame);
+
+    // Show the real scheduler; fall back to one worker per core when running single-threaded
+    int visualThreads = imageProcessor.getNumThreads();
+    if (visualThreads <= 1) {
+        visualThreads = max(2, static_cast<int>(thread::hardware_concurrency()));
+    }
 
     // Process all filters with thread visualization
-    auto results = imageProcessor.applyAllFiltersWithCutLines(savedSnapshot);
+    auto results = imageProcessor.applyAllFiltersWithCutLines(frame, visualThreads);
 
     // Display results
     for (const auto& [filterName, resultFrame] : results) {
@@ -300,6 +558,7 @@ Scalar KeyHandler::getColorForFilter(const string& filterName) {
     if (filterName == "gaussian")  return Scalar(0, 0, 255);    // Red
     if (filterName == "median")    return Scalar(255, 0, 0);    // Blue
     if (filterName == "denoising") return Scalar(0, 255, 0);    // Green
+    if (filterName == "guided")    return Scalar(0, 128, 0);    // Dark green
     if (filterName == "canny")     return Scalar(255, 128, 0);  // Orange
     if (filterName == "sobel")     return Scalar(0, 255, 255);  // Yellow
     if (filterName == "fourier")   return Scalar(255, 0, 255);  // Magenta
@@ -319,6 +578,7 @@ void KeyHandler::saveFilteredImage(const Mat& image, const string& filterName, b
     string fullPath = resourcesPath + "/" + filename;
     
     // Always replace existing file with the same name
+    TRACE_SCOPE("save " + filename, "io");
     if (imwrite(fullPath, image)) {
         cout << "Filtered image saved as: " << fullPath << endl;
     } else {
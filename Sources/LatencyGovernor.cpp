@@ -0,0 +1,116 @@
+#include "Headers/LatencyGovernor.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+
+LatencyGovernor::LatencyGovernor(double deadlineMs, double smoothing)                                                     // Constructor
+    : deadlineUs(deadlineMs * 1000.0), smoothing(smoothing) {
+}
+
+void LatencyGovernor::setDeadline(double deadlineMs) {                                                                    // Set the per-frame deadline
+    lock_guard<mutex> lock(governorMutex);
+    deadlineUs = deadlineMs * 1000.0;
+}
+
+double LatencyGovernor::getDeadlineMs() const {                                                                           // Get the per-frame deadline
+    lock_guard<mutex> lock(governorMutex);
+    return deadlineUs / 1000.0;
+}
+
+double LatencyGovernor::estimateFor(const FilterState& state, DegradationLevel level) const {                             // Measured estimate, or a guess derived from full quality
+    int index = static_cast<int>(level);
+    if (state.estimateUs[index] > 0) return state.estimateUs[index];
+
+    double fullQuality = state.estimateUs[static_cast<int>(DegradationLevel::None)];
+    switch (level) {
+        case DegradationLevel::ReducedKernel: return fullQuality * 0.5;
+        case DegradationLevel::ReducedResolution: return fullQuality * 0.3;
+        default: return fullQuality;
+    }
+}
+
+DegradationDecision LatencyGovernor::decide(const string& filterName, bool canReduceKernel, bool canReduceResolution) {   // Pick the best quality expected to meet the deadline
+    lock_guard<mutex> lock(governorMutex);
+    FilterState& state = filters[filterName];
+    state.frameIndex++;
+
+    vector<DegradationLevel> ladder = {DegradationLevel::None};
+    if (canReduceKernel) ladder.push_back(DegradationLevel::ReducedKernel);
+    if (canReduceResolution) ladder.push_back(DegradationLevel::ReducedResolution);
+
+    // Highest quality level that fits; moving up needs some headroom to avoid flapping
+    DegradationLevel chosen = DegradationLevel::SkipFrame;
+    size_t chosenStep = ladder.size();
+    for (size_t step = 0; step < ladder.size(); step++) {
+        double budget = (ladder[step] < state.current) ? deadlineUs * UPGRADE_MARGIN : deadlineUs;
+        if (estimateFor(state, ladder[step]) <= budget) {
+            chosen = ladder[step];
+            chosenStep = step;
+            break;
+        }
+    }
+
+    if (logDecisions && chosen != state.current) {
+        cout << "[latency] " << filterName << ": " << levelName(state.current) << " -> " << levelName(chosen)
+             << " (full quality estimate " << fixed << setprecision(0) << estimateFor(state, DegradationLevel::None)
+             << " us, deadline " << deadlineUs << " us)" << endl;
+    }
+    state.current = chosen;
+
+    // Nothing fits: process every other frame at the cheapest level so the estimate keeps updating
+    if (chosen == DegradationLevel::SkipFrame && state.frameIndex % 2 == 0) {
+        chosenStep = ladder.size() - 1;
+        chosen = ladder[chosenStep];
+    }
+
+    // Periodically try one level up, otherwise a degraded filter never gets measured at full quality again
+    if (chosen != DegradationLevel::SkipFrame && chosenStep > 0 && state.frameIndex % PROBE_INTERVAL == 0) {
+        chosen = ladder[chosenStep - 1];
+    }
+    decisionCounts[static_cast<int>(chosen)]++;
+
+    return {chosen, estimateFor(state, chosen), deadlineUs};
+}
+
+void LatencyGovernor::record(const string& filterName, DegradationLevel level, double durationUs) {                      // Fold a measured duration into the rolling estimate
+    if (level == DegradationLevel::SkipFrame) return;
+
+    lock_guard<mutex> lock(governorMutex);
+    double& estimate = filters[filterName].estimateUs[static_cast<int>(level)];
+    estimate = (estimate > 0) ? estimate + smoothing * (durationUs - estimate) : durationUs;
+}
+
+uint64_t LatencyGovernor::getDecisionCount(DegradationLevel level) const {                                               // Number of frames handled at a level
+    lock_guard<mutex> lock(governorMutex);
+    return decisionCounts[static_cast<int>(level)];
+}
+
+uint64_t LatencyGovernor::getTotalDecisions() const {                                                                     // Number of frames seen
+    lock_guard<mutex> lock(governorMutex);
+    uint64_t total = 0;
+    for (uint64_t count : decisionCounts) total += count;
+    return total;
+}
+
+void LatencyGovernor::printSummary() const {                                                                              // Print how often each quality level was used
+    uint64_t total = getTotalDecisions();
+    if (total == 0) return;
+
+    cout << "Latency budget " << fixed << setprecision(1) << getDeadlineMs() << " ms, " << total << " frames:" << endl;
+    for (int level = 0; level < NUM_LEVELS; level++) {
+        uint64_t count = getDecisionCount(static_cast<DegradationLevel>(level));
+        cout << "  " << levelName(static_cast<DegradationLevel>(level)) << ": " << count
+             << " (" << setprecision(1) << 100.0 * count / total << "%)" << endl;
+    }
+}
+
+string LatencyGovernor::levelName(DegradationLevel level) {                                                               // Readable name of a level
+    switch (level) {
+        case DegradationLevel::None: return "full quality";
+        case DegradationLevel::ReducedKernel: return "reduced kernel";
+        case DegradationLevel::ReducedResolution: return "reduced resolution";
+        case DegradationLevel::SkipFrame: return "skip frame";
+    }
+    return "unknown";
+}
@@ -4,20 +4,17 @@
 using namespace cv;
 using namespace std;
 
-MedianFilter::MedianFilter(int size) {
+MedianFilter::MedianFilter(int size, int minimumSize) : minimumKernelSize(max(3, minimumSize)) {
     setKernelSize(size);
 }
 
 MedianFilter::~MedianFilter() {
-    #ifdef __APPLE__
-        destroyWindow(windowName);
-    #endif
 }
 
 void MedianFilter::setKernelSize(int size) {
-    // Ensure kernel size is **odd** and at least **3**
+    // Ensure kernel size is **odd** and at least the minimum (**9** unless a caller asks for less)
     if (size % 2 == 0) size++; // If even, make it odd
-    kernelSize = max(9, size);
+    kernelSize = max(minimumKernelSize | 1, size);
 }
 
 Mat MedianFilter::applyFilter(const Mat& inputFrame) {
@@ -0,0 +1,170 @@
+#include "Headers/MetricsRegistry.hpp"
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <cmath>
+#include <cstdio>
+
+int LatencyHistogram::bucketIndex(uint64_t value) {                                                                     // Power of two plus the next 4 bits select the bucket
+    if (value < SUB_BUCKETS) return static_cast<int>(value);
+
+    int exponent = 63 - __builtin_clzll(value);
+    int subBucket = static_cast<int>((value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + subBucket;
+}
+
+double LatencyHistogram::bucketValue(int index) {                                                                       // Midpoint of the values mapped to a bucket
+    if (index < SUB_BUCKETS) return index;
+
+    int exponent = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    int subBucket = index % SUB_BUCKETS;
+    double width = ldexp(1.0, exponent - SUB_BUCKET_BITS);
+    return ldexp(1.0, exponent) + (subBucket + 0.5) * width;
+}
+
+void LatencyHistogram::record(double valueUs) {                                                                         // Add one sample
+    uint64_t value = valueUs > 0 ? static_cast<uint64_t>(valueUs) : 0;
+    buckets[min(bucketIndex(value), NUM_BUCKETS - 1)].fetch_add(1, memory_order_relaxed);
+    total.fetch_add(1, memory_order_relaxed);
+
+    // No fetch_add for atomic<double> before C++20
+    double current = sumUs.load(memory_order_relaxed);
+    while (!sumUs.compare_exchange_weak(current, current + valueUs, memory_order_relaxed)) {}
+}
+
+double LatencyHistogram::percentile(double p) const {                                                                   // Value below which p percent of the samples fall
+    uint64_t samples = count();
+    if (samples == 0) return 0;
+
+    uint64_t target = static_cast<uint64_t>(ceil(samples * min(100.0, max(0.0, p)) / 100.0));
+    target = max<uint64_t>(1, target);
+    uint64_t seen = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+        seen += buckets[i].load(memory_order_relaxed);
+        if (seen >= target) return bucketValue(i);
+    }
+    return bucketValue(NUM_BUCKETS - 1);
+}
+
+MetricsRegistry& MetricsRegistry::instance() {                                                                          // Process-wide registry
+    static MetricsRegistry registry;
+    return registry;
+}
+
+void MetricsRegistry::rememberHelp(const string& name, const string& help) {                                           // Store the HELP text of a metric family
+    if (help.empty()) return;
+    helpTexts[name.substr(0, name.find('{'))] = help;
+}
+
+Counter& MetricsRegistry::counter(const string& name, const string& help) {                                            // Find or create a counter
+    lock_guard<mutex> lock(registryMutex);
+    auto& slot = counters[name];
+    if (!slot) slot = make_unique<Counter>();
+    rememberHelp(name, help);
+    return *slot;
+}
+
+Gauge& MetricsRegistry::gauge(const string& name, const string& help) {                                                // Find or create a gauge
+    lock_guard<mutex> lock(registryMutex);
+    auto& slot = gauges[name];
+    if (!slot) slot = make_unique<Gauge>();
+    rememberHelp(name, help);
+    return *slot;
+}
+
+LatencyHistogram& MetricsRegistry::histogram(const string& name, const string& help) {                                 // Find or create a latency histogram
+    lock_guard<mutex> lock(registryMutex);
+    auto& slot = histograms[name];
+    if (!slot) slot = make_unique<LatencyHistogram>();
+    rememberHelp(name, help);
+    return *slot;
+}
+
+string MetricsRegistry::labelled(const string& family, const string& label, const string& value) {                      // Metric name with one escaped label
+    string escaped;
+    for (char c : value) {
+        if (c == '\\') escaped += "\\\\";
+        else if (c == '"') escaped += "\\\"";
+        else if (c == '\n') escaped += "\\n";
+        else escaped += c;
+    }
+    return family + "{" + label + "=\"" + escaped + "\"}";
+}
+
+// Insert an extra label into a possibly labelled metric name
+static string withLabel(const string& name, const string& suffix, const string& label) {
+    size_t brace = name.find('{');
+    string family = name.substr(0, brace) + suffix;
+    if (label.empty()) {
+        return (brace == string::npos) ? family : family + name.substr(brace);
+    }
+    if (brace == string::npos) return family + "{" + label + "}";
+    return family + "{" + label + "," + name.substr(brace + 1);
+}
+
+string MetricsRegistry::renderPrometheus() const {                                                                      // Render every metric in the text exposition format
+    lock_guard<mutex> lock(registryMutex);
+    stringstream out;
+    string lastFamily;
+
+    auto header = [&](const string& name, const char* type) {
+        string family = name.substr(0, name.find('{'));
+        if (family == lastFamily) return;
+        lastFamily = family;
+        auto help = helpTexts.find(family);
+        if (help != helpTexts.end()) out << "# HELP " << family << " " << help->second << "\n";
+        out << "# TYPE " << family << " " << type << "\n";
+    };
+
+    for (const auto& [name, metric] : counters) {
+        header(name, "counter");
+        out << name << " " << metric->get() << "\n";
+    }
+    for (const auto& [name, metric] : gauges) {
+        header(name, "gauge");
+        out << name << " " << metric->get() << "\n";
+    }
+    // Histograms are exported as summaries; the sub-bucket layout would mean a thousand series each
+    for (const auto& [name, metric] : histograms) {
+        header(name, "summary");
+        for (const char* quantile : {"0.5", "0.9", "0.99"}) {
+            out << withLabel(name, "", string("quantile=\"") + quantile + "\"") << " "
+                << metric->percentile(stod(quantile) * 100) << "\n";
+        }
+        out << withLabel(name, "_sum", "") << " " << metric->sum() << "\n";
+        out << withLabel(name, "_count", "") << " " << metric->count() << "\n";
+    }
+    return out.str();
+}
+
+MetricsExporter::MetricsExporter(const string& path, int intervalMs) : path(path), intervalMs(intervalMs) {            // Constructor starting the writer thread
+    writer = thread([this]() {
+        unique_lock<mutex> lock(stopMutex);
+        while (!stopCondition.wait_for(lock, chrono::milliseconds(this->intervalMs), [this]() { return stopping; })) {
+            flush();
+        }
+    });
+}
+
+MetricsExporter::~MetricsExporter() {                                                                                   // Destructor writing one last snapshot
+    {
+        lock_guard<mutex> lock(stopMutex);
+        stopping = true;
+    }
+    stopCondition.notify_all();
+    writer.join();
+    flush();
+}
+
+bool MetricsExporter::flush() const {                                                                                   // Write the registry, replacing the file atomically
+    string temporaryPath = path + ".tmp";
+    {
+        ofstream out(temporaryPath);
+        if (!out) {
+            cerr << "Error: Unable to write metrics to " << temporaryPath << endl;
+            return false;
+        }
+        out << MetricsRegistry::instance().renderPrometheus();
+    }
+    return rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
@@ -0,0 +1,257 @@
+#include "Headers/MultiStreamProcessor.hpp"
+#include <iostream>
+#include <limits>
+
+MultiStreamProcessor::MultiStreamProcessor(MultiThreadImageProcessor& processor, int maxFramesInFlight)                    // Constructor
+    : processor(processor),
+      maxFramesInFlight(maxFramesInFlight > 0 ? maxFramesInFlight : processor.getThreadBudget()),
+      framesInFlightGauge(MetricsRegistry::instance().gauge("cpmulti_frames_in_flight", "Stream frames queued or running on the pool")) {
+}
+
+MultiStreamProcessor::~MultiStreamProcessor() {                                                                             // Destructor
+    stop();
+}
+
+int MultiStreamProcessor::addStream(const StreamConfig& config) {                                                           // Open a source and register it
+    if (running) {
+        cerr << "Error: Streams must be added before the processor starts." << endl;
+        return -1;
+    }
+    if (!processor.hasFilter(config.filterName)) {
+        cerr << "Error: Unknown filter name '" << config.filterName << "'" << endl;
+        return -1;
+    }
+
+    auto stream = make_unique<Stream>();
+    stream->config = config;
+    stream->config.priority = max(1, config.priority);
+    stream->governor.setDeadline(config.latencyBudgetMs);
+
+    if (!stream->capture.open(config.source, config.nativeFormat)) {
+        cerr << "Error: Unable to open stream source '" << config.source << "'" << endl;
+        return -1;
+    }
+    stream->format = stream->capture.format();
+    if (stream->config.name.empty()) {
+        stream->config.name = "Stream " + to_string(streams.size());
+    }
+    if (stream->format != PixelFormat::BGR) {
+        cout << stream->config.name << ": capturing " << FrameContext::formatName(stream->format) << " frames." << endl;
+    }
+
+    MetricsRegistry& registry = MetricsRegistry::instance();
+    auto named = [&](const string& family) { return MetricsRegistry::labelled(family, "stream", stream->config.name); };
+    stream->capturedCounter = &registry.counter(named("cpmulti_stream_frames_captured_total"), "Frames read from the source");
+    stream->droppedCounter = &registry.counter(named("cpmulti_stream_frames_dropped_total"), "Frames replaced, expired or skipped");
+    stream->degradedCounter = &registry.counter(named("cpmulti_stream_frames_degraded_total"), "Frames processed at reduced quality");
+    stream->latencyHistogram = &registry.histogram(named("cpmulti_stream_latency_us"), "Capture to output latency in microseconds");
+
+    lock_guard<mutex> lock(streamsMutex);
+    streams.push_back(move(stream));
+    return static_cast<int>(streams.size()) - 1;
+}
+
+void MultiStreamProcessor::start() {                                                                                        // Start one capture thread per stream
+    if (running || streams.empty()) return;
+    running = true;
+    for (size_t i = 0; i < streams.size(); i++) {
+        streams[i]->captureThread = thread(&MultiStreamProcessor::captureLoop, this, static_cast<int>(i));
+    }
+}
+
+void MultiStreamProcessor::stop() {                                                                                         // Stop capturing and wait for frames in flight
+    if (!running) return;
+    running = false;
+    for (auto& stream : streams) {
+        if (stream->captureThread.joinable()) {
+            stream->captureThread.join();
+        }
+    }
+
+    unique_lock<mutex> lock(streamsMutex);
+    idleCondition.wait(lock, [this]() { return framesInFlight == 0; });
+    for (auto& stream : streams) {
+        stream->capture.release();
+    }
+}
+
+void MultiStreamProcessor::captureLoop(int streamId) {                                                                      // Grab frames and hand the newest one to the scheduler
+    Stream& stream = *streams[streamId];
+    Mat frame;
+    TRACE_THREAD_NAME("capture " + stream.config.name);
+    // Decoding shares the reserved cores with display rather than stealing time from pinned workers
+    if (processor.getAffinity().policy != AffinityPolicy::None) {
+        CpuTopology::pinCurrentThread(processor.getIoCpus());
+    }
+
+    while (running) {
+        bool captured;
+        {
+            TRACE_SCOPE("capture", "io");
+            captured = stream.capture.read(frame);
+        }
+        if (!captured || frame.empty()) {
+            cerr << "Error: No frame available from " << stream.config.name << "." << endl;
+            break;
+        }
+
+        lock_guard<mutex> lock(streamsMutex);
+        stream.stats.framesCaptured++;
+        stream.capturedCounter->increment();
+
+        // Only the newest frame is kept; an unprocessed older one is dropped
+        if (stream.hasPending) {
+            stream.stats.framesDropped++;
+            stream.droppedCounter->increment();
+        }
+        stream.pendingFrame = frame.clone();
+        stream.pendingSince = Clock::now();
+        stream.hasPending = true;
+        scheduleLocked();
+    }
+}
+
+void MultiStreamProcessor::scheduleLocked() {                                                                              // Pick the next frames to run; streamsMutex must be held
+    auto now = Clock::now();
+
+    while (framesInFlight < maxFramesInFlight) {
+        // Weighted fair queuing: the stream that received the least weighted service goes first
+        Stream* next = nullptr;
+        int nextId = -1;
+        for (size_t i = 0; i < streams.size(); i++) {
+            Stream& candidate = *streams[i];
+            if (!candidate.hasPending || candidate.inFlight) continue;
+
+            // Frames that already missed their latency budget are not worth processing
+            double waitedMs = chrono::duration<double, milli>(now - candidate.pendingSince).count();
+            if (waitedMs > candidate.config.latencyBudgetMs) {
+                candidate.hasPending = false;
+                candidate.pendingFrame.release();
+                candidate.stats.framesDropped++;
+                candidate.droppedCounter->increment();
+                continue;
+            }
+
+            if (!next || candidate.virtualTime < next->virtualTime ||
+                (candidate.virtualTime == next->virtualTime && candidate.config.priority > next->config.priority)) {
+                next = &candidate;
+                nextId = static_cast<int>(i);
+            }
+        }
+        if (!next) return;
+
+        Mat frame = next->pendingFrame;
+        Clock::time_point capturedAt = next->pendingSince;
+        next->pendingFrame = Mat();
+        next->hasPending = false;
+        next->inFlight = true;
+        framesInFlight++;
+        framesInFlightGauge.set(framesInFlight);
+
+        processor.getThreadPool().enqueue([this, nextId, frame, capturedAt]() {
+            processFrame(nextId, frame, capturedAt);
+        });
+    }
+}
+
+void MultiStreamProcessor::processFrame(int streamId, Mat frame, Clock::time_point capturedAt) {                          // Filter one frame on a pool worker
+    Stream& stream = *streams[streamId];
+
+    // Without an explicit setting each stream gets an equal share of the budget
+    ExecutionOptions options = processor.getDefaultOptions();
+    options.numThreads = (stream.config.numThreads > 0)
+        ? stream.config.numThreads
+        : max(1, processor.getThreadBudget() / static_cast<int>(streams.size()));
+
+    // Native frames stay in the camera's format unless the filter needs colour
+    FrameContext context(frame, stream.format, &processor.getThreadPool(), options.numThreads);
+    Mat output;
+    double durationUs = 0;
+    DegradationDecision decision;
+    double filteredFraction = 1.0;
+    try {
+        if (stream.config.incremental) {
+            // The cost of a gated frame follows how much of it changed, which the governor cannot predict,
+            // so incremental streams are not degraded. Only one frame per stream is in flight, so the state is ours.
+            IncrementalStats incrementalStats;
+            tie(output, durationUs) = processor.applyFilterIncremental(stream.config.filterName, context.frame(), options, stream.incrementalState,
+                                                                       stream.config.incrementalOptions, &incrementalStats);
+            filteredFraction = incrementalStats.filteredFraction;
+        } else {
+            tie(output, durationUs) = processor.applyFilterAdaptive(stream.config.filterName, context, options, stream.governor, &decision);
+        }
+    } catch (const exception& e) {
+        cerr << "Error: Processing failed on " << stream.config.name << ": " << e.what() << endl;
+    }
+    double latencyMs = chrono::duration<double, milli>(Clock::now() - capturedAt).count();
+
+    lock_guard<mutex> lock(streamsMutex);
+    stream.inFlight = false;
+    framesInFlight--;
+    framesInFlightGauge.set(framesInFlight);
+
+    if (decision.level == DegradationLevel::SkipFrame) {
+        stream.stats.framesDropped++;
+        stream.droppedCounter->increment();
+    } else if (decision.level != DegradationLevel::None) {
+        stream.stats.framesDegraded++;
+        stream.degradedCounter->increment();
+    }
+
+    if (!output.empty()) {
+        stream.latestOutput = output;
+        stream.hasNewOutput = true;
+        stream.stats.framesProcessed++;
+        stream.stats.lastLatencyMs = latencyMs;
+        stream.stats.averageLatencyMs += (latencyMs - stream.stats.averageLatencyMs) / stream.stats.framesProcessed;
+        stream.stats.averageFilteredFraction += (filteredFraction - stream.stats.averageFilteredFraction) / stream.stats.framesProcessed;
+        stream.latencyHistogram->record(latencyMs * 1000.0);
+    }
+
+    // Charge the stream for the work it used, scaled down by its priority
+    stream.virtualTime += (durationUs / 1000.0) / stream.config.priority;
+
+    // Keep idle streams from banking credit: nobody starts further behind than the busiest waiting stream
+    double minVirtualTime = numeric_limits<double>::max();
+    for (const auto& other : streams) {
+        if (other->hasPending || other->inFlight) {
+            minVirtualTime = min(minVirtualTime, other->virtualTime);
+        }
+    }
+    if (minVirtualTime != numeric_limits<double>::max()) {
+        for (auto& other : streams) {
+            if (!other->hasPending && !other->inFlight) {
+                other->virtualTime = max(other->virtualTime, minVirtualTime);
+            }
+        }
+    }
+
+    scheduleLocked();
+    idleCondition.notify_all();
+}
+
+bool MultiStreamProcessor::getLatestOutput(int streamId, Mat& output) {                                                     // Fetch the newest processed frame of a stream
+    lock_guard<mutex> lock(streamsMutex);
+    if (streamId < 0 || streamId >= static_cast<int>(streams.size())) return false;
+
+    Stream& stream = *streams[streamId];
+    if (!stream.hasNewOutput) return false;
+    output = stream.latestOutput;
+    stream.hasNewOutput = false;
+    return true;
+}
+
+StreamStats MultiStreamProcessor::getStats(int streamId) const {                                                            // Counters of a stream
+    lock_guard<mutex> lock(streamsMutex);
+    return streams.at(streamId)->stats;
+}
+
+StreamConfig MultiStreamProcessor::getConfig(int streamId) const {                                                          // Settings of a stream
+    lock_guard<mutex> lock(streamsMutex);
+    return streams.at(streamId)->config;
+}
+
+size_t MultiStreamProcessor::getStreamCount() const {                                                                       // Number of registered streams
+    lock_guard<mutex> lock(streamsMutex);
+    return streams.size();
+}
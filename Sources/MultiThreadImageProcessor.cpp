@@ -1,126 +1,692 @@
 #include "Headers/MultiThreadImageProcessor.hpp"
 #include <iostream>
 #include <thread>
+#include <iomanip>
+#include <sstream>
+#include <mutex>
+#include <algorithm>
 
 using namespace cv;
 using namespace std;
 
-MultiThreadImageProcessor::MultiThreadImageProcessor(int numThreads) : numThreads(numThreads) {
-    // Initialize filter map with corresponding filter functions
-    filterMap["greyscale"] = [this](const Mat& img) { return applyFilterTimed("greyscale", img).first; };
-    filterMap["gaussian"] = [this](const Mat& img) { return applyFilterTimed("gaussian", img).first; };
-    filterMap["median"] = [this](const Mat& img) { return applyFilterTimed("median", img).first; };
-    filterMap["denoising"] = [this](const Mat& img) { return applyFilterTimed("denoising", img).first; };
-    filterMap["canny"] = [this](const Mat& img) { return applyFilterTimed("canny", img).first; };
-    filterMap["sobel"] = [this](const Mat& img) { return applyFilterTimed("sobel", img).first; };
-    filterMap["fourier"] = [this](const Mat& img) { return applyFilterTimed("fourier", img).first; };
-    filterMap["resize"] = [this](const Mat& img) { return applyFilterTimed("resize", img).first; };
-    filterMap["rotate"] = [this](const Mat& img) { return applyFilterTimed("rotate", img).first; };
+// One caller works alongside the pool, so the pool holds one thread less than the budget. Several
+// callers outside the pool each bring their own thread on top of it.
+static int resolveThreadBudget(int threadBudget) {
+    if (threadBudget > 0) return threadBudget;
+    return max(1, static_cast<int>(thread::hardware_concurrency()));
 }
 
-MultiThreadImageProcessor::~MultiThreadImageProcessor() {}
+MultiThreadImageProcessor::MultiThreadImageProcessor(int numThreads, int threadBudget, const AffinityOptions& affinity)
+    : numThreads(numThreads), YELLOW_COLOR(0, 255, 255), threadBudget(resolveThreadBudget(threadBudget)), affinity(affinity),
+      threadPool(max(1, resolveThreadBudget(threadBudget) - 1), CpuTopology::instance().workerCpus(affinity)) {
+    // Initialize filter map with corresponding filter functions. Each call builds its own filter
+    // object, so strips and concurrent callers never share filter state.
+    filterMap["greyscale"] = {[](const Mat& img) { GreyScaleFilter filter; return filter.applyFilter(img); }, {true, true, 0}};
+    filterMap["gaussian"] = {[](const Mat& img) { GaussianFilter filter; return filter.applyFilter(img); }, {true, true, 8}};
+    filterMap["median"] = {[](const Mat& img) { MedianFilter filter(9); return filter.applyFilter(img); }, {true, true, 5},
+                           [](const Mat& img) { MedianFilter filter(5, 5); return filter.applyFilter(img); }};
+    filterMap["denoising"] = {[](const Mat& img) { DenoisingFilter filter; return filter.applyFilter(img); }, {true, true, 10},
+                              [](const Mat& img) { DenoisingFilter filter(10.0, 5, 7); return filter.applyFilter(img); }};
+    filterMap["guided"] = {[](const Mat& img) { GuidedFilter filter(8); return filter.applyFilter(img); }, {true, true, 16},
+                           [](const Mat& img) { GuidedFilter filter(4); return filter.applyFilter(img); }};
+    filterMap["canny"] = {[](const Mat& img) { CannyFilter filter; return filter.applyFilter(img); }, {true, true, 10}};
+    filterMap["sobel"] = {[](const Mat& img) { SobelFilter filter(1, 0, 3); return filter.applyFilter(img); }, {true, true, 2}};
+
+    // The spectrum and the geometric transforms depend on the whole frame
+    filterMap["fourier"] = {[](const Mat& img) { FourierFilter filter; return filter.applyFilter(img); }, {false, true, 0}};
+    filterMap["fourier8"] = {[](const Mat& img) { FourierFilter filter(SpectrumOutput::Bytes); return filter.applyFilter(img); }, {false, true, 0}};
+    filterMap["resize"] = {[](const Mat& img) { ResizeRotateFilter filter(0.5, 0.0); return filter.applyFilter(img); }, {false, false, 0}};
+    filterMap["rotate"] = {[](const Mat& img) { ResizeRotateFilter filter(1.0, 180.0); return filter.applyFilter(img); }, {false, false, 0}};
+
+    // Filters built on the grey plane or its gradients share them through a FrameContext
+    filterMap["greyscale"].applyInContext = [](FrameContext& context, const Rect& region) { GreyScaleFilter filter; return filter.applyFilter(context, region); };
+    filterMap["greyscale"].prepareContext = [](FrameContext& context) { context.grey(); };
+    filterMap["canny"].applyInContext = [](FrameContext& context, const Rect& region) { CannyFilter filter; return filter.applyFilter(context, region); };
+    filterMap["canny"].prepareContext = [](FrameContext& context) { context.gradientX(); context.gradientY(); };
+    filterMap["sobel"].applyInContext = [](FrameContext& context, const Rect& region) { SobelFilter filter(1, 0, 3); return filter.applyFilter(context, region); };
+    filterMap["sobel"].prepareContext = [](FrameContext& context) { context.gradientX(); };
+    filterMap["fourier"].applyInContext = [](FrameContext& context, const Rect&) { FourierFilter filter; return filter.applyFilter(context); };
+    filterMap["fourier"].prepareContext = [](FrameContext& context) { context.grey(); };
+    filterMap["fourier8"].applyInContext = [](FrameContext& context, const Rect&) { FourierFilter filter(SpectrumOutput::Bytes); return filter.applyFilter(context); };
+    filterMap["fourier8"].prepareContext = [](FrameContext& context) { context.grey(); };
+}
+
+MultiThreadImageProcessor::~MultiThreadImageProcessor() {
+    unique_lock<mutex> lock(submitMutex);
+    submitCondition.wait(lock, [this]() { return submissionsInFlight == 0; });
+}
+
+TaskFuture<Mat> MultiThreadImageProcessor::submitFilter(const string& filterName, const Mat& inputImage, const ExecutionOptions& options) {
+    return submitTracked([this, filterName, inputImage, options]() { return applyFilter(filterName, inputImage, options); });
+}
+
+TaskFuture<pair<Mat, double>> MultiThreadImageProcessor::submitFilterTimed(const string& filterName, const Mat& inputImage, const ExecutionOptions& options) {
+    return submitTracked([this, filterName, inputImage, options]() { return applyFilterTimed(filterName, inputImage, options); });
+}
+
+TaskFuture<pair<Mat, double>> MultiThreadImageProcessor::submitSequential(const string& filterName, const Mat& inputImage) {
+    return submitTracked([this, filterName, inputImage]() { return sequentialFilter(filterName, inputImage); });
+}
+
+void MultiThreadImageProcessor::finishSubmission() {
+    {
+        lock_guard<mutex> lock(submitMutex);
+        submissionsInFlight--;
+    }
+    submitCondition.notify_all();
+}
 
 // Apply filter dynamically based on filter name
 Mat MultiThreadImageProcessor::applyFilter(const string& filterName, const Mat& inputImage) {
-    auto [result, _] = applyFilterTimed(filterName, inputImage);
+    return applyFilter(filterName, inputImage, getDefaultOptions());
+}
+
+Mat MultiThreadImageProcessor::applyFilter(const string& filterName, const Mat& inputImage, const ExecutionOptions& options) {
+    return filterCached(filterName, inputImage, nullptr, options);
+}
+
+Mat MultiThreadImageProcessor::applyFilter(const string& filterName, FrameContext& context, const ExecutionOptions& options) {
+    return filterCached(filterName, Mat(), &context, options);
+}
+
+// With a context, inputImage is unused: the frame is taken from the context, and only converted
+// to BGR when the filter cannot work from its planes
+Mat MultiThreadImageProcessor::filterCached(const string& filterName, const Mat& inputImage, FrameContext* context, const ExecutionOptions& options) {
+    // Untimed calls may be served from the result cache; applyFilterTimed always filters, so measurements stay honest
+    auto it = filterMap.find(filterName);
+    const Mat& captured = context ? context->native() : inputImage;
+    if (!resultCache.isEnabled() || captured.empty() || it == filterMap.end()) {
+        return filterTimed(filterName, inputImage, context, options, nullptr).first;
+    }
+
+    // Native frames are hashed as captured, which is cheaper than hashing their BGR conversion
+    Size frameSize = context ? context->size() : inputImage.size();
+    CacheKey key = ResultCache::makeKey(captured, cacheId(filterName, "full", resolveOptions(it->second, options), frameSize));
+    Mat result;
+    if (resultCache.lookup(key, result)) {
+        return result;
+    }
+    result = filterTimed(filterName, inputImage, context, options, nullptr).first;
+    resultCache.insert(key, result);
     return result;
 }
 
+// Everything besides the input pixels that determines a result: the filter, its parameter
+// variant and, when the frame is split, the layout, since stitched edges may differ slightly
+string MultiThreadImageProcessor::cacheId(const string& filterName, const string& variant, const ExecutionOptions& resolved, const Size& imageSize) const {
+    vector<Rect> units = splitWork(imageSize, resolved);
+    if (units.size() == 1) {
+        return filterName + "/" + variant + "/whole";
+    }
+    return filterName + "/" + variant + "/" + (resolved.policy == ParallelPolicy::Tiles ? "tiles" : "strips") +
+           to_string(units.size()) + "/overlap" + to_string(resolved.overlap);
+}
+
 // Apply filter with timing measurements
-pair<Mat, double> MultiThreadImageProcessor::applyFilterTimed(const string& filterName, const Mat& inputImage) {
-    if (inputImage.empty()) {
+pair<Mat, double> MultiThreadImageProcessor::applyFilterTimed(const string& filterName, const Mat& inputImage, ScheduleTrace* trace) {
+    return applyFilterTimed(filterName, inputImage, getDefaultOptions(), trace);
+}
+
+pair<Mat, double> MultiThreadImageProcessor::applyFilterTimed(const string& filterName, const Mat& inputImage, const ExecutionOptions& options, ScheduleTrace* trace) {
+    return filterTimed(filterName, inputImage, nullptr, options, trace);
+}
+
+pair<Mat, double> MultiThreadImageProcessor::applyFilterTimed(const string& filterName, FrameContext& context, const ExecutionOptions& options, ScheduleTrace* trace) {
+    return filterTimed(filterName, Mat(), &context, options, trace);
+}
+
+pair<Mat, double> MultiThreadImageProcessor::filterTimed(const string& filterName, const Mat& inputImage, FrameContext* context,
+                                                         const ExecutionOptions& options, ScheduleTrace* trace) {
+    if (context ? context->empty() : inputImage.empty()) {
         cout << "Error: Empty image provided for processing" << endl;
         return {Mat(), 0};
     }
 
-    // Dynamically apply the correct filter
-    if (filterName == "greyscale") {
-        GreyScaleFilter greyScaleFilter;
-        return processFilter(inputImage, greyScaleFilter);
-    } else if (filterName == "gaussian") {
-        GaussianFilter gaussianFilter;
-        return processFilter(inputImage, gaussianFilter);
-    } else if (filterName == "median") {
-        MedianFilter medianFilter;
-        return processFilter(inputImage, medianFilter);
-    } else if (filterName == "denoising") {
-        DenoisingFilter denoisingFilter;
-        return processFilter(inputImage, denoisingFilter);
-    } else if (filterName == "canny") {
-        CannyFilter cannyFilter;
-        return processFilter(inputImage, cannyFilter);
-    } else if (filterName == "sobel") {
-        SobelFilter sobelFilter(1, 0, 3);
-        return processFilter(inputImage, sobelFilter);
-    } else if (filterName == "fourier") {
-        FourierFilter fourierFilter;
-        return processFilter(inputImage, fourierFilter);
-        numThreads = 1;
-    } else if (filterName == "resize") {
-        ResizeRotateFilter resizeFilter(0.5, 0.0);
-        numThreads = 1;
-        return processFilter(inputImage, resizeFilter);
-    } else if (filterName == "rotate") {
-        ResizeRotateFilter rotateFilter(1.0, 180.0);
-        numThreads = 1;
-        return processFilter(inputImage, rotateFilter);
+    auto it = filterMap.find(filterName);
+    if (it == filterMap.end()) {
+        cout << "Error: Unknown filter name '" << filterName << "'" << endl;
+        return {Mat(), 0};
+    }
+
+    TRACE_SCOPE(filterName, "filter");
+    const Mat& input = (context && !it->second.applyInContext) ? context->frame() : inputImage;
+    auto result = processFilter(input, it->second, resolveOptions(it->second, options), trace, context);
+    recordMetrics(filterName, result.second);
+    return result;
+}
+
+// Per-filter latency and throughput for the live metrics surface
+void MultiThreadImageProcessor::recordMetrics(const string& filterName, double durationUs) const {
+    MetricsRegistry& registry = MetricsRegistry::instance();
+    registry.histogram(MetricsRegistry::labelled("cpmulti_filter_latency_us", "filter", filterName), "Filter latency in microseconds").record(durationUs);
+    registry.counter(MetricsRegistry::labelled("cpmulti_filter_runs_total", "filter", filterName), "Completed filter runs").increment();
+}
+
+// Filters that cannot be stitched from strips always run on the whole frame
+ExecutionOptions MultiThreadImageProcessor::resolveOptions(const FilterEntry& filter, const ExecutionOptions& options) const {
+    ExecutionOptions resolved = options;
+    if (!filter.capabilities.stripParallel) {
+        resolved.policy = ParallelPolicy::Sequential;
+        resolved.numThreads = 1;
+    }
+    return resolved;
+}
+
+// Apply a filter within a per-frame deadline, degrading quality when needed
+pair<Mat, double> MultiThreadImageProcessor::applyFilterAdaptive(const string& filterName, const Mat& inputImage, const ExecutionOptions& options,
+                                                                 LatencyGovernor& governor, DegradationDecision* decision) {
+    return filterAdaptive(filterName, inputImage, nullptr, options, governor, decision);
+}
+
+pair<Mat, double> MultiThreadImageProcessor::applyFilterAdaptive(const string& filterName, FrameContext& context, const ExecutionOptions& options,
+                                                                 LatencyGovernor& governor, DegradationDecision* decision) {
+    return filterAdaptive(filterName, Mat(), &context, options, governor, decision);
+}
+
+pair<Mat, double> MultiThreadImageProcessor::filterAdaptive(const string& filterName, const Mat& inputImage, FrameContext* context, const ExecutionOptions& options,
+                                                            LatencyGovernor& governor, DegradationDecision* decision) {
+    const Mat& captured = context ? context->native() : inputImage;
+    Size frameSize = context ? context->size() : inputImage.size();
+    if (captured.empty()) {
+        cout << "Error: Empty image provided for processing" << endl;
+        return {Mat(), 0};
     }
-    
-    else {
+
+    auto it = filterMap.find(filterName);
+    if (it == filterMap.end()) {
         cout << "Error: Unknown filter name '" << filterName << "'" << endl;
         return {Mat(), 0};
     }
+    const FilterEntry& entry = it->second;
+
+    DegradationDecision chosen = governor.decide(filterName, static_cast<bool>(entry.reducedApply), entry.capabilities.preservesSize);
+    if (decision) {
+        *decision = chosen;
+    }
+    if (chosen.level == DegradationLevel::SkipFrame) {
+        return {Mat(), 0};
+    }
+
+    TRACE_SCOPE(filterName + " (" + LatencyGovernor::levelName(chosen.level) + ")", "filter");
+    auto startTime = chrono::high_resolution_clock::now();
+
+    // Frozen or duplicated frames are served from the cache. Hits are not recorded with the governor
+    // or the filter latency, which must keep describing the cost of actually filtering.
+    CacheKey key;
+    if (resultCache.isEnabled()) {
+        key = ResultCache::makeKey(captured, cacheId(filterName, LatencyGovernor::levelName(chosen.level),
+                                                     resolveOptions(entry, options), frameSize));
+        Mat cached;
+        if (resultCache.lookup(key, cached)) {
+            return {cached, chrono::duration<double, micro>(chrono::high_resolution_clock::now() - startTime).count()};
+        }
+    }
+
+    FilterEntry effective = entry;
+    if (chosen.level == DegradationLevel::ReducedKernel) {
+        effective.apply = entry.reducedApply;
+        effective.applyInContext = nullptr;
+    }
+
+    // Reduced resolution filters a half-size copy and scales the result back up. The copy has no
+    // planes of its own, and filters that cannot use the context need the colour frame.
+    Mat input = inputImage;
+    if (context && (chosen.level == DegradationLevel::ReducedResolution || !effective.applyInContext)) {
+        input = context->frame();
+        context = nullptr;
+    }
+    if (chosen.level == DegradationLevel::ReducedResolution) {
+        TRACE_SCOPE("downscale", "filter");
+        resize(input, input, Size(), 0.5, 0.5, INTER_AREA);
+    }
+
+    Mat output = processFilter(input, effective, resolveOptions(effective, options), nullptr, context).first;
+    if (chosen.level == DegradationLevel::ReducedResolution && !output.empty()) {
+        TRACE_SCOPE("upscale", "filter");
+        resize(output, output, frameSize, 0, 0, INTER_LINEAR);
+    }
+
+    auto stopTime = chrono::high_resolution_clock::now();
+    double duration = chrono::duration_cast<chrono::microseconds>(stopTime - startTime).count();
+    governor.record(filterName, chosen.level, duration);
+    recordMetrics(filterName, duration);
+    if (resultCache.isEnabled()) {
+        resultCache.insert(key, output);
+    }
+
+    return {output, duration};
 }
 
-// Generalized function to process any filter with threading
-template<typename FilterType>
-pair<Mat, double> MultiThreadImageProcessor::processFilter(const Mat& inputImage, FilterType& filter) {
-    Mat sampleOutput = filter.applyFilter(inputImage);
-    Mat finalImage = Mat(sampleOutput.rows, sampleOutput.cols, sampleOutput.type());
+// Change-gated variant for mostly static scenes
+pair<Mat, double> MultiThreadImageProcessor::applyFilterIncremental(const string& filterName, const Mat& inputImage, const ExecutionOptions& options,
+                                                                    IncrementalState& state, const IncrementalOptions& incremental,
+                                                                    IncrementalStats* stats) {
+    if (inputImage.empty()) {
+        cout << "Error: Empty image provided for processing" << endl;
+        return {Mat(), 0};
+    }
+
+    auto it = filterMap.find(filterName);
+    if (it == filterMap.end()) {
+        cout << "Error: Unknown filter name '" << filterName << "'" << endl;
+        return {Mat(), 0};
+    }
+    const FilterEntry& entry = it->second;
+    ExecutionOptions resolved = resolveOptions(entry, options);
 
+    TRACE_SCOPE(filterName + " (incremental)", "filter");
     auto startTime = chrono::high_resolution_clock::now();
 
-    if (numThreads <= 1) {
-        finalImage = filter.applyFilter(inputImage);
-    } else {
-        vector<thread> threads;
-        int segmentHeight = inputImage.rows / numThreads;
-        int overlap = 10;
+    int block = max(16, incremental.blockSize);
+    int blockCols = (inputImage.cols + block - 1) / block;
+    int blockRows = (inputImage.rows + block - 1) / block;
+    auto blockRect = [&](int bx, int by) {
+        return Rect(bx * block, by * block, min(block, inputImage.cols - bx * block), min(block, inputImage.rows - by * block));
+    };
 
-        for (int i = 0; i < numThreads; i++) {
-            int startRow = max(0, i * segmentHeight - overlap);
-            int endRow = min(inputImage.rows, (i + 1) * segmentHeight + overlap);
+    IncrementalStats result;
+    result.totalBlocks = blockCols * blockRows;
 
-            threads.emplace_back([&, startRow, endRow, i]() {
-                Mat inputSegment = inputImage(Range(startRow, endRow), Range::all());
-                Mat processedSegment = filter.applyFilter(inputSegment);
+    bool fullRefresh = !entry.capabilities.stripParallel || !entry.capabilities.preservesSize || state.cachedOutput.empty() ||
+                       state.filterName != filterName || state.referenceInput.size() != inputImage.size() ||
+                       state.referenceInput.type() != inputImage.type() ||
+                       (incremental.refreshInterval > 0 && state.framesSinceRefresh + 1 >= incremental.refreshInterval);
 
-                // Convert grayscale to color if necessary
-                if (processedSegment.channels() != finalImage.channels()) {
-                    cvtColor(processedSegment, processedSegment, COLOR_GRAY2BGR);
+    // Block-wise difference against the input the cached output came from, one block row per task
+    vector<uint8_t> dirty;
+    if (!fullRefresh) {
+        TRACE_SCOPE("change detection", "filter");
+        dirty.assign(result.totalBlocks, 0);
+        threadPool.parallelFor(blockRows, resolved.numThreads, [&](size_t by, int) {
+            Mat difference, changed;
+            for (int bx = 0; bx < blockCols; bx++) {
+                Rect region = blockRect(bx, static_cast<int>(by));
+                absdiff(inputImage(region), state.referenceInput(region), difference);
+                compare(difference.reshape(1), incremental.pixelThreshold, changed, CMP_GT);
+                dirty[by * blockCols + bx] = countNonZero(changed) > incremental.minChangedPixels;
+            }
+        });
+        result.dirtyBlocks = static_cast<int>(count(dirty.begin(), dirty.end(), 1));
+        fullRefresh = result.dirtyBlocks > incremental.maxDirtyFraction * result.totalBlocks;
+    }
+
+    if (fullRefresh) {
+        Mat output = processFilter(inputImage, entry, resolved, nullptr).first;
+        state.filterName = filterName;
+        inputImage.copyTo(state.referenceInput);
+        output.copyTo(state.cachedOutput);
+        state.framesSinceRefresh = 0;
+        result.fullRefresh = true;
+        result.dirtyBlocks = result.totalBlocks;
+        result.filteredFraction = 1.0;
+
+        double duration = chrono::duration_cast<chrono::microseconds>(chrono::high_resolution_clock::now() - startTime).count();
+        recordMetrics(filterName, duration);
+        if (stats) *stats = result;
+        return {output, duration};
+    }
+
+    // Output pixels within the halo of a changed block change as well. Each block recomputes the
+    // bounding box of its own pixels that are dirty or near a dirty block, so no two units overlap.
+    int halo = entry.capabilities.halo;
+    int reach = (halo + block - 1) / block;
+    Rect bounds(0, 0, inputImage.cols, inputImage.rows);
+    vector<Rect> units;
+    for (int by = 0; by < blockRows; by++) {
+        for (int bx = 0; bx < blockCols; bx++) {
+            Rect own = blockRect(bx, by);
+            if (dirty[by * blockCols + bx]) {
+                units.push_back(own);
+                continue;
+            }
+            Rect needed;
+            for (int ny = max(0, by - reach); ny <= min(blockRows - 1, by + reach); ny++) {
+                for (int nx = max(0, bx - reach); nx <= min(blockCols - 1, bx + reach); nx++) {
+                    if (!dirty[ny * blockCols + nx]) continue;
+                    Rect neighbour = blockRect(nx, ny);
+                    Rect affected = Rect(neighbour.x - halo, neighbour.y - halo, neighbour.width + 2 * halo, neighbour.height + 2 * halo) & bounds & own;
+                    if (affected.area() > 0) {
+                        needed = (needed.area() > 0) ? (needed | affected) : affected;
+                    }
                 }
+            }
+            if (needed.area() > 0) {
+                units.push_back(needed);
+            }
+        }
+    }
 
-                // Crop and copy to final image
-                int cropStart = (i == 0) ? 0 : overlap;
-                int cropEnd = (i == numThreads - 1) ? processedSegment.rows : processedSegment.rows - overlap;
-                Mat croppedSegment = processedSegment(Range(cropStart, cropEnd), Range::all());
+    int overlap = max(resolved.overlap, halo);
+    threadPool.parallelFor(units.size(), resolved.numThreads, [&](size_t u, int) {
+        TRACE_SCOPE("dirty block", "strip");
+        Mat processedSegment = filterRegion(inputImage, entry, units[u], overlap, resolved);
+        if (processedSegment.empty()) return;
+        if (processedSegment.channels() != state.cachedOutput.channels()) {
+            cvtColor(processedSegment, processedSegment, COLOR_GRAY2BGR);
+        }
+        processedSegment.copyTo(state.cachedOutput(units[u]));
+    });
 
-                croppedSegment.copyTo(finalImage(Range(i * segmentHeight, i * segmentHeight + croppedSegment.rows), Range::all()));
-            });
+    // Only changed blocks move the reference, so slow drift below the threshold still adds up to a change
+    for (int by = 0; by < blockRows; by++) {
+        for (int bx = 0; bx < blockCols; bx++) {
+            if (dirty[by * blockCols + bx]) {
+                inputImage(blockRect(bx, by)).copyTo(state.referenceInput(blockRect(bx, by)));
+            }
         }
+    }
+    state.framesSinceRefresh++;
+
+    double filteredPixels = 0;
+    for (const auto& unit : units) filteredPixels += unit.area();
+    result.filteredFraction = filteredPixels / inputImage.total();
 
-        for (auto& thread : threads) {
-            thread.join();
+    // The cache is patched again by the next frame, so the caller gets its own copy
+    Mat output = state.cachedOutput.clone();
+    double duration = chrono::duration_cast<chrono::microseconds>(chrono::high_resolution_clock::now() - startTime).count();
+    recordMetrics(filterName, duration);
+    if (stats) *stats = result;
+    return {output, duration};
+}
+
+// Split the output into the units handed to the workers
+vector<Rect> MultiThreadImageProcessor::splitWork(const Size& imageSize, const ExecutionOptions& options) const {
+    vector<Rect> units;
+    int threads = max(1, options.numThreads);
+
+    if (options.policy == ParallelPolicy::Sequential || threads == 1) {
+        units.push_back(Rect(0, 0, imageSize.width, imageSize.height));
+    } else if (options.policy == ParallelPolicy::Strips) {
+        int segmentHeight = imageSize.height / threads;
+        for (int i = 0; i < threads; i++) {
+            int startRow = i * segmentHeight;
+            int endRow = (i == threads - 1) ? imageSize.height : startRow + segmentHeight;
+            units.push_back(Rect(0, startRow, imageSize.width, endRow - startRow));
         }
+    } else {
+        int tile = max(16, options.tileSize);
+        for (int y = 0; y < imageSize.height; y += tile) {
+            for (int x = 0; x < imageSize.width; x += tile) {
+                units.push_back(Rect(x, y, min(tile, imageSize.width - x), min(tile, imageSize.height - y)));
+            }
+        }
+    }
+    return units;
+}
+
+// Filter one region from its halo-padded surroundings and return the result cropped to the region
+Mat MultiThreadImageProcessor::filterRegion(const Mat& inputImage, const FilterEntry& filter, const Rect& region, int overlap, const ExecutionOptions& options,
+                                            FrameContext* context) const {
+    // Grow the region by the halo, clipped to the image
+    Rect padded(region.x - overlap, region.y - overlap, region.width + 2 * overlap, region.height + 2 * overlap);
+    padded &= Rect(Point(0, 0), context ? context->size() : inputImage.size());
+
+    Mat processed;
+    if (context && filter.applyInContext) {
+        // The shared planes are read in place; they were derived across all workers
+        processed = filter.applyInContext(*context, padded);
+    } else if (options.localCopy) {
+        // Reused per thread; a pinned worker first-touches it, so the filter's repeated reads stay on its node
+        static thread_local Mat localInput;
+        TRACE_SCOPE("local copy", "alloc");
+        inputImage(padded).copyTo(localInput);
+        processed = filter.apply(localInput);
+    } else {
+        processed = filter.apply(inputImage(padded));
+    }
+    if (processed.empty()) return processed;
+
+    // Crop the halo
+    return processed(Rect(region.x - padded.x, region.y - padded.y, region.width, region.height));
+}
+
+// Generalized function to process any filter with threading
+pair<Mat, double> MultiThreadImageProcessor::processFilter(const Mat& inputImage, const FilterEntry& filter, const ExecutionOptions& options, ScheduleTrace* trace,
+                                                           FrameContext* context) {
+    // A context only serves filters that know how to use it; with one, inputImage may be empty
+    if (!filter.applyInContext) {
+        context = nullptr;
+    }
+    Size frameSize = context ? context->size() : inputImage.size();
+
+    vector<Rect> units = splitWork(frameSize, options);
+    int threads = min({max(1, options.numThreads), static_cast<int>(units.size()), threadBudget});
+    int overlap = max(options.overlap, filter.capabilities.halo);
+
+    if (trace) {
+        trace->strips.assign(units.size(), StripRecord());
+        trace->numThreads = threads;
+    }
+
+    Mat finalImage;
+    once_flag allocateOutput;
+    atomic<bool> unitFailed{false};
+
+    auto startTime = chrono::high_resolution_clock::now();
+    auto elapsedUs = [&startTime]() {
+        return chrono::duration<double, micro>(chrono::high_resolution_clock::now() - startTime).count();
+    };
+
+    if (context && filter.prepareContext) {
+        filter.prepareContext(*context);
+    }
+
+    if (units.size() == 1) {
+        // Still a parallelFor, so a caller kept off the compute CPUs hands the frame to a worker
+        threadPool.parallelFor(1, 1, [&](size_t, int workerIndex) {
+            TRACE_SCOPE("whole frame", "strip");
+            // A result read straight from a shared plane is copied, since later filters still read the plane
+            finalImage = context ? filter.applyInContext(*context, Rect(Point(0, 0), frameSize)).clone() : filter.apply(inputImage);
+            if (trace) {
+                trace->strips[0] = {Rect(0, 0, finalImage.cols, finalImage.rows), workerIndex, 0, elapsedUs()};
+            }
+        });
+    } else {
+        // Units are pulled by the caller and up to threads - 1 pool workers
+        threadPool.parallelFor(units.size(), threads, [&](size_t u, int workerIndex) {
+            TRACE_SCOPE("strip", "strip");
+            double unitStart = elapsedUs();
+            const Rect& unit = units[u];
+
+            Mat processedSegment = filterRegion(inputImage, filter, unit, overlap, options, context);
+            if (processedSegment.empty()) {
+                unitFailed = true;
+                return;
+            }
+
+            // The first finished unit tells us the output type. Its pages are first written by the
+            // copy below, so each unit of the output lands on the node of the worker that produced it.
+            call_once(allocateOutput, [&]() {
+                TRACE_SCOPE("allocate output", "alloc");
+                finalImage.create(frameSize, processedSegment.type());
+            });
+
+            // Convert grayscale to color if necessary
+            if (processedSegment.channels() != finalImage.channels()) {
+                cvtColor(processedSegment, processedSegment, COLOR_GRAY2BGR);
+            }
+
+            processedSegment.copyTo(finalImage(unit));
+
+            // Each unit owns its own slot in the trace
+            if (trace) {
+                trace->strips[u] = {unit, workerIndex, unitStart, elapsedUs() - unitStart};
+            }
+        });
     }
 
     auto stopTime = chrono::high_resolution_clock::now();
     double duration = chrono::duration_cast<chrono::microseconds>(stopTime - startTime).count();
+    if (trace) {
+        trace->totalUs = duration;
+    }
+
+    // A missing unit would leave part of the output unwritten, or none of it allocated
+    if (unitFailed) {
+        cerr << "Error: A unit of the " << frameSize.width << "x" << frameSize.height << " frame produced no output" << endl;
+        return {Mat(), duration};
+    }
 
     return {finalImage, duration};
 }
 
-// Set and get number of threads
+BatchResult MultiThreadImageProcessor::applyFilterBatch(const string& filterName, const vector<Mat>& frames, const ExecutionOptions& options) {
+    return applyChainBatch({filterName}, frames, options);
+}
+
+BatchResult MultiThreadImageProcessor::applyChainBatch(const vector<string>& chain, const vector<Mat>& frames, const ExecutionOptions& options) {
+    BatchResult result;
+    result.frames.resize(frames.size());
+    if (chain.empty()) {
+        cerr << "Error: A batch needs at least one filter" << endl;
+        return result;
+    }
+
+    // Looked up and resolved once for the whole batch
+    vector<const FilterEntry*> entries;
+    bool stitchable = true;
+    int halo = 0;
+    string chainName;
+    for (const auto& filterName : chain) {
+        auto it = filterMap.find(filterName);
+        if (it == filterMap.end()) {
+            cerr << "Error: Unknown filter name '" << filterName << "'" << endl;
+            return result;
+        }
+        entries.push_back(&it->second);
+        stitchable = stitchable && it->second.capabilities.stripParallel && it->second.capabilities.preservesSize;
+        halo += it->second.capabilities.halo;
+        chainName += (chainName.empty() ? "" : "+") + filterName;
+    }
+
+    ExecutionOptions resolved = options;
+    resolved.numThreads = max(1, options.numThreads);
+    ExecutionOptions splitting = resolved;
+    if (!stitchable) {
+        splitting.policy = ParallelPolicy::Sequential;   // Whole frames only, still run side by side
+    }
+    // Each filter of a chain needs its own halo around what the next one reads
+    int overlap = max(resolved.overlap, halo);
+
+    // Every unit of every frame, frame by frame, so early frames tend to finish first
+    struct BatchUnit {
+        size_t frame;
+        Rect region;
+        double startUs = 0;
+        double endUs = 0;
+    };
+    vector<BatchUnit> units;
+    vector<size_t> unitsPerFrame(frames.size(), 0);
+    for (size_t f = 0; f < frames.size(); f++) {
+        if (frames[f].empty()) {
+            cerr << "Error: Empty image at position " << f << " of the batch" << endl;
+            continue;
+        }
+        for (const Rect& region : splitWork(frames[f].size(), splitting)) {
+            units.push_back({f, region});
+            unitsPerFrame[f]++;
+        }
+    }
+    unique_ptr<once_flag[]> allocateOutput(new once_flag[frames.size()]);
+    unique_ptr<atomic<bool>[]> frameFailed(new atomic<bool>[frames.size()]());
+
+    auto startTime = chrono::high_resolution_clock::now();
+    auto elapsedUs = [&startTime]() {
+        return chrono::duration<double, micro>(chrono::high_resolution_clock::now() - startTime).count();
+    };
+
+    int threads = min({resolved.numThreads, static_cast<int>(units.size()), threadBudget});
+    threadPool.parallelFor(units.size(), max(1, threads), [&](size_t u, int) {
+        TRACE_SCOPE("batch unit", "strip");
+        BatchUnit& unit = units[u];
+        unit.startUs = elapsedUs();
+        const Mat& input = frames[unit.frame];
+        Mat& output = result.frames[unit.frame].output;
+
+        if (unitsPerFrame[unit.frame] == 1) {
+            output = filterChainRegion(input, entries, unit.region, 0, resolved);
+            if (output.empty()) {
+                frameFailed[unit.frame] = true;
+            }
+        } else {
+            Mat processedSegment = filterChainRegion(input, entries, unit.region, overlap, resolved);
+            if (processedSegment.empty()) {
+                frameFailed[unit.frame] = true;
+            } else {
+                call_once(allocateOutput[unit.frame], [&]() {
+                    TRACE_SCOPE("allocate output", "alloc");
+                    output.create(input.size(), processedSegment.type());
+                });
+                if (processedSegment.channels() != output.channels()) {
+                    cvtColor(processedSegment, processedSegment, COLOR_GRAY2BGR);
+                }
+                processedSegment.copyTo(output(unit.region));
+            }
+        }
+        unit.endUs = elapsedUs();
+    });
+    result.totalUs = elapsedUs();
+
+    // A frame with a failed unit is partly unwritten, so it gets no output at all
+    for (size_t f = 0; f < frames.size(); f++) {
+        if (frameFailed[f]) {
+            cerr << "Error: " << chainName << " produced no output for part of frame " << f << " of the batch" << endl;
+            result.frames[f].output = Mat();
+        }
+    }
+
+    // A frame ran from its first unit starting to its last one finishing
+    double pixels = 0;
+    vector<bool> seen(frames.size(), false);
+    for (const BatchUnit& unit : units) {
+        BatchFrameResult& frame = result.frames[unit.frame];
+        double endUs = seen[unit.frame] ? max(frame.startUs + frame.durationUs, unit.endUs) : unit.endUs;
+        frame.startUs = seen[unit.frame] ? min(frame.startUs, unit.startUs) : unit.startUs;
+        frame.durationUs = endUs - frame.startUs;
+        seen[unit.frame] = true;
+    }
+    size_t framesFiltered = 0;
+    for (size_t f = 0; f < frames.size(); f++) {
+        if (!seen[f] || frameFailed[f]) continue;
+        framesFiltered++;
+        pixels += static_cast<double>(frames[f].total());
+        recordMetrics(chainName, result.frames[f].durationUs);
+    }
+    if (result.totalUs > 0) {
+        result.framesPerSecond = framesFiltered * 1e6 / result.totalUs;
+        result.megapixelsPerSecond = pixels / result.totalUs;
+    }
+    return result;
+}
+
+// Run a chain of filters on one region and its halo; each filter reads what the previous one produced
+Mat MultiThreadImageProcessor::filterChainRegion(const Mat& inputImage, const vector<const FilterEntry*>& chain, const Rect& region, int overlap,
+                                                 const ExecutionOptions& options) const {
+    Rect padded(region.x - overlap, region.y - overlap, region.width + 2 * overlap, region.height + 2 * overlap);
+    padded &= Rect(Point(0, 0), inputImage.size());
+
+    Mat processed;
+    if (options.localCopy) {
+        // Reused per thread across the whole batch, and first touched by the worker that reads it
+        static thread_local Mat localInput;
+        TRACE_SCOPE("local copy", "alloc");
+        inputImage(padded).copyTo(localInput);
+        processed = localInput;
+    } else {
+        processed = inputImage(padded);
+    }
+    for (const FilterEntry* filter : chain) {
+        processed = filter->apply(processed);
+        if (processed.empty()) return processed;
+    }
+
+    if (padded.size() == processed.size() && padded.size() != region.size()) {
+        return processed(Rect(region.x - padded.x, region.y - padded.y, region.width, region.height));
+    }
+    return processed;
+}
+
+// Set and get the default number of threads
 void MultiThreadImageProcessor::setNumThreads(int numThreads) {
     this->numThreads = numThreads;
 }
@@ -129,7 +695,51 @@ int MultiThreadImageProcessor::getNumThreads() const {
     return numThreads;
 }
 
-unordered_map<string, Mat> MultiThreadImageProcessor::applyAllFiltersWithCutLines(const Mat& inputImage) {
+ExecutionOptions MultiThreadImageProcessor::getDefaultOptions() const {
+    ExecutionOptions options;
+    options.numThreads = numThreads;
+    // Only worth a copy when frames can live on another node than the worker
+    options.localCopy = affinity.policy != AffinityPolicy::None && affinity.firstTouch && CpuTopology::instance().nodeCount() > 1;
+    return options;
+}
+
+vector<int> MultiThreadImageProcessor::getIoCpus() const {
+    return CpuTopology::instance().ioCpus(affinity);
+}
+
+bool MultiThreadImageProcessor::hasFilter(const string& filterName) const {
+    return filterMap.find(filterName) != filterMap.end();
+}
+
+string MultiThreadImageProcessor::getSavableFilter(const string& filterName) const {
+    // The float spectrum is stretched to [0,1] and would be written almost black
+    return (filterName == "fourier") ? "fourier8" : filterName;
+}
+
+FilterCapabilities MultiThreadImageProcessor::getCapabilities(const string& filterName) const {
+    auto it = filterMap.find(filterName);
+    return (it != filterMap.end()) ? it->second.capabilities : FilterCapabilities{false, false, 0};
+}
+
+vector<string> MultiThreadImageProcessor::getFilterNames() const {
+    vector<string> names;
+    for (const auto& [name, entry] : filterMap) {
+        names.push_back(name);
+    }
+    sort(names.begin(), names.end());
+    return names;
+}
+
+// Run every strip-parallel filter through the real scheduler and overlay what it did
+unordered_map<string, Mat> MultiThreadImageProcessor::applyAllFiltersWithCutLines(const Mat& inputImage, int visualThreads) {
+    ExecutionOptions options = getDefaultOptions();
+    if (visualThreads > 0) {
+        options.numThreads = visualThreads;
+    }
+    return applyAllFiltersWithCutLines(inputImage, options);
+}
+
+unordered_map<string, Mat> MultiThreadImageProcessor::applyAllFiltersWithCutLines(const Mat& inputImage, const ExecutionOptions& options) {
     if (inputImage.empty()) {
         cerr << "Error: Empty image provided for processing" << endl;
         return {};
@@ -137,54 +747,74 @@ unordered_map<string, Mat> MultiThreadImageProcessor::applyAllFiltersWithCutLine
 
     vector<string> filters = {"greyscale", "gaussian", "median", "denoising", "canny" , "sobel"};
     unordered_map<string, Mat> results;
-    const int visualThreads = 10; // Use 4 threads for clear visualization
-    
-    for (const auto& filterName : filters) {
-        Mat processedImage = inputImage.clone();
-        int segmentHeight = processedImage.rows / visualThreads;
-        
-        // Process each segment
-        vector<thread> threads;
-        for (int i = 0; i < visualThreads; i++) {
-            int startRow = i * segmentHeight;
-            int endRow = (i == visualThreads - 1) ? processedImage.rows : (i + 1) * segmentHeight;
-            
-            threads.emplace_back([&, startRow, endRow, filterName]() {
-                Mat segment = inputImage(Range(startRow, endRow), Range::all());
-                Mat processedSegment = applyFilter(filterName, segment);
-                
-                // Convert to BGR if grayscale
-                if (processedSegment.channels() == 1) {
-                    cvtColor(processedSegment, processedSegment, COLOR_GRAY2BGR);
-                }
-                
-                processedSegment.copyTo(processedImage(Range(startRow, endRow), Range::all()));
-            });
-        }
 
-        // Wait for all threads to complete
-        for (auto& t : threads) {
-            t.join();
-        }
+    // Greyscale, Canny and Sobel share one grey plane, and Canny and Sobel one set of gradients
+    FrameContext context(inputImage, &threadPool, options.numThreads);
 
-        // Draw thread separation lines
-        for (int i = 1; i < visualThreads; i++) {
-            int y = i * segmentHeight;
-            line(processedImage, Point(0, y), Point(processedImage.cols, y), 
-                 Scalar(0, 255, 255), 2); // Yellow line
-            
-            // Add thread number label
-            putText(processedImage, "Thread " + to_string(i), 
-                   Point(10, y - 5), FONT_HERSHEY_SIMPLEX, 0.5, 
-                   Scalar(0, 255, 255), 1);
+    for (const auto& filterName : filters) {
+        ScheduleTrace trace;
+        auto [processedImage, duration] = applyFilterTimed(filterName, context, options, &trace);
+        if (processedImage.empty()) continue;
+
+        // Convert to BGR if grayscale so the overlay can be coloured
+        if (processedImage.channels() == 1) {
+            cvtColor(processedImage, processedImage, COLOR_GRAY2BGR);
         }
 
+        drawScheduleOverlay(processedImage, trace);
         results[filterName] = processedImage;
     }
 
     return results;
 }
 
+// Tint each strip or tile by the time its worker spent on it and label the boundaries
+void MultiThreadImageProcessor::drawScheduleOverlay(Mat& image, const ScheduleTrace& trace) const {
+    if (trace.strips.empty()) return;
+
+    double minUs = trace.strips[0].durationUs;
+    double maxUs = trace.strips[0].durationUs;
+    for (const auto& strip : trace.strips) {
+        minUs = min(minUs, strip.durationUs);
+        maxUs = max(maxUs, strip.durationUs);
+    }
+
+    // Map each strip duration onto a heat colour (blue = fastest, red = slowest)
+    Mat heatLevels(1, static_cast<int>(trace.strips.size()), CV_8UC1);
+    for (size_t i = 0; i < trace.strips.size(); i++) {
+        double ratio = (maxUs > minUs) ? (trace.strips[i].durationUs - minUs) / (maxUs - minUs) : 0.0;
+        heatLevels.at<uchar>(0, static_cast<int>(i)) = saturate_cast<uchar>(ratio * 255);
+    }
+    Mat heatColors;
+    applyColorMap(heatLevels, heatColors, COLORMAP_JET);
+
+    Rect bounds(0, 0, image.cols, image.rows);
+    for (size_t i = 0; i < trace.strips.size(); i++) {
+        const StripRecord& strip = trace.strips[i];
+        Rect region = strip.region & bounds;
+        if (region.empty()) continue;
+
+        Vec3b heat = heatColors.at<Vec3b>(0, static_cast<int>(i));
+        Scalar color(heat[0], heat[1], heat[2]);
+
+        Mat roi = image(region);
+        Mat tint(roi.rows, roi.cols, roi.type(), color);
+        addWeighted(roi, 0.65, tint, 0.35, 0, roi);
+
+        rectangle(image, region, YELLOW_COLOR, 1);
+
+        stringstream label;
+        label << "Worker " << strip.worker << ": " << fixed << setprecision(0) << strip.durationUs << " us";
+        putText(image, label.str(), Point(region.x + 10, region.y + 20),
+                FONT_HERSHEY_SIMPLEX, 0.5, YELLOW_COLOR, 1);
+    }
+
+    stringstream summary;
+    summary << trace.numThreads << " threads, " << trace.strips.size() << " units, total " << fixed << setprecision(0) << trace.totalUs
+            << " us, strip time " << minUs << "-" << maxUs << " us";
+    putText(image, summary.str(), Point(10, image.rows - 10), FONT_HERSHEY_SIMPLEX, 0.5, YELLOW_COLOR, 1);
+}
+
 pair<Mat, double> MultiThreadImageProcessor::sequentialFilter(const string& filterName, const Mat& inputImage) {
     if (inputImage.empty()) {
         cerr << "Error: Empty image provided for processing" << endl;
@@ -206,6 +836,9 @@ pair<Mat, double> MultiThreadImageProcessor::sequentialFilter(const string& filt
     } else if (filterName == "denoising") {
         DenoisingFilter denoisingFilter;
         result = denoisingFilter.applyFilter(inputImage);
+    } else if (filterName == "guided") {
+        GuidedFilter guidedFilter(8);
+        result = guidedFilter.applyFilter(inputImage);
     } else if (filterName == "canny") {
         CannyFilter cannyFilter(50, 150);
         result = cannyFilter.applyFilter(inputImage);
@@ -215,6 +848,9 @@ pair<Mat, double> MultiThreadImageProcessor::sequentialFilter(const string& filt
     } else if (filterName == "fourier") {
         FourierFilter fourierFilter;
         result = fourierFilter.applyFilter(inputImage);
+    } else if (filterName == "fourier8") {
+        FourierFilter fourierFilter(SpectrumOutput::Bytes);
+        result = fourierFilter.applyFilter(inputImage);
     } else if (filterName == "resize") {
         ResizeRotateFilter resizeFilter(0.5, 0.0);
         result = resizeFilter.applyFilter(inputImage);
@@ -0,0 +1,164 @@
+#include "Headers/NativeCapture.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+NativeCapture::~NativeCapture() {                                                                                       // Destructor
+    release();
+}
+
+bool NativeCapture::open(const string& source, bool native) {                                                           // Open a camera, a video or a raw recording
+    release();
+    if (source.find(".nv12:") != string::npos || source.find(".yuyv:") != string::npos) {
+        return openRawFile(source);
+    }
+    if (source.size() >= 6 && source.compare(source.size() - 6, 6, ".cpraw") == 0) {
+        if (!recording.open(source)) return false;
+        recordingIndex = 0;
+        pixelFormat = recording.format();
+        size = (recording.frameCount() > 0) ? FrameContext::frameSizeOf(recording.frame(0), pixelFormat) : recording.frameSize();
+        return true;
+    }
+
+    // A purely numeric source is a camera index, anything else a file or URL
+    bool isCameraIndex = !source.empty() && all_of(source.begin(), source.end(), ::isdigit);
+    bool opened = isCameraIndex ? capture.open(stoi(source)) : capture.open(source);
+    if (!opened) return false;
+    size = Size(static_cast<int>(capture.get(CAP_PROP_FRAME_WIDTH)), static_cast<int>(capture.get(CAP_PROP_FRAME_HEIGHT)));
+    if (!native || !isCameraIndex) return true;
+
+    // Only uncompressed formats can be handed on; MJPEG and the like still need decoding to BGR
+    int fourcc = static_cast<int>(capture.get(CAP_PROP_FOURCC));
+    string code;
+    for (int i = 0; i < 4; i++) code += static_cast<char>((fourcc >> (8 * i)) & 0xFF);
+    if (code == "NV12") {
+        pixelFormat = PixelFormat::NV12;
+    } else if (code == "YUYV" || code == "YUY2") {
+        pixelFormat = PixelFormat::YUYV;
+    } else {
+        cerr << "Warning: Camera delivers " << (fourcc ? code : string("an unknown format")) << ", capturing BGR instead." << endl;
+        return true;
+    }
+    if (!capture.set(CAP_PROP_CONVERT_RGB, 0)) {
+        cerr << "Warning: The capture backend cannot disable BGR conversion, capturing BGR instead." << endl;
+        pixelFormat = PixelFormat::BGR;
+    }
+    return true;
+}
+
+// "<path>.<format>:<width>x<height>", frames stored back to back without headers
+bool NativeCapture::openRawFile(const string& source) {                                                                 // Open a raw recording
+    size_t colon = source.rfind(':');
+    size_t times = source.find('x', colon);
+    if (times == string::npos) {
+        cerr << "Error: Raw source '" << source << "' needs a size, as in clip.nv12:640x480" << endl;
+        return false;
+    }
+    string path = source.substr(0, colon);
+    size = Size(atoi(source.substr(colon + 1, times - colon - 1).c_str()), atoi(source.substr(times + 1).c_str()));
+    pixelFormat = (path.size() >= 5 && path.compare(path.size() - 5, 5, ".nv12") == 0) ? PixelFormat::NV12 : PixelFormat::YUYV;
+    if (size.width <= 0 || size.height <= 0 || size.width % 2 || size.height % 2) {
+        cerr << "Error: Raw frames must have an even, nonzero width and height." << endl;
+        return false;
+    }
+
+    rawFile.open(path, ios::binary);
+    return rawFile.is_open();
+}
+
+bool NativeCapture::read(Mat& frame) {                                                                                  // Read the next frame as captured
+    if (recording.isOpen()) {
+        frame = recording.frame(recordingIndex++);
+        return !frame.empty();
+    }
+    if (rawFile.is_open()) {
+        frame.create(pixelFormat == PixelFormat::NV12 ? size.height * 3 / 2 : size.height, size.width,
+                     pixelFormat == PixelFormat::NV12 ? CV_8UC1 : CV_8UC2);
+        rawFile.read(reinterpret_cast<char*>(frame.data), static_cast<streamsize>(frame.total() * frame.elemSize()));
+        return rawFile.gcount() == static_cast<streamsize>(frame.total() * frame.elemSize());
+    }
+    if (!capture.read(frame) || frame.empty()) return false;
+    return pixelFormat == PixelFormat::BGR || normalizeRaw(frame);
+}
+
+// Backends differ in how they shape an unconverted buffer: some return the picture layout, some
+// one row of bytes. Either way the bytes are in the camera's order, so only the header changes.
+bool NativeCapture::normalizeRaw(Mat& frame) const {                                                                    // Give a raw buffer the layout FrameContext expects
+    int rows = pixelFormat == PixelFormat::NV12 ? size.height * 3 / 2 : size.height;
+    int channels = pixelFormat == PixelFormat::NV12 ? 1 : 2;
+    if (frame.rows == rows && frame.cols == size.width && frame.channels() == channels) return true;
+
+    size_t expectedBytes = static_cast<size_t>(rows) * size.width * channels;
+    if (!frame.isContinuous() || frame.total() * frame.elemSize() != expectedBytes) {
+        cerr << "Error: Native frame of " << frame.total() * frame.elemSize() << " bytes does not match "
+             << FrameContext::formatName(pixelFormat) << " at " << size.width << "x" << size.height << "." << endl;
+        return false;
+    }
+    frame = frame.reshape(channels, rows);
+    return true;
+}
+
+bool NativeCapture::isOpened() const {                                                                                  // True while frames can be read
+    return rawFile.is_open() || recording.isOpen() || capture.isOpened();
+}
+
+void NativeCapture::release() {                                                                                         // Close the source
+    if (rawFile.is_open()) rawFile.close();
+    recording.close();
+    capture.release();
+    pixelFormat = PixelFormat::BGR;
+}
+
+double NativeCapture::fps() const {                                                                                     // Nominal frame rate, 0 when unknown
+    if (recording.isOpen()) {
+        // Recordings keep capture timestamps rather than a nominal rate
+        size_t frames = recording.frameCount();
+        double spanUs = (frames > 1) ? static_cast<double>(recording.timestampUs(frames - 1) - recording.timestampUs(0)) : 0.0;
+        return (spanUs > 0) ? (frames - 1) * 1e6 / spanUs : 0.0;
+    }
+    return rawFile.is_open() ? 0.0 : capture.get(CAP_PROP_FPS);
+}
+
+Mat NativeCapture::encode(const Mat& bgr, PixelFormat format) {                                                         // Convert BGR to a camera layout
+    if (format == PixelFormat::BGR) return bgr.clone();
+    if (bgr.type() != CV_8UC3 || bgr.cols % 2 || bgr.rows % 2) {
+        cerr << "Error: Only BGR frames with an even width and height can be encoded as " << FrameContext::formatName(format) << "." << endl;
+        return Mat();
+    }
+
+    // I420 keeps U and V in separate planes; both native layouts interleave them
+    Mat i420;
+    cvtColor(bgr, i420, COLOR_BGR2YUV_I420);
+    int width = bgr.cols;
+    int height = bgr.rows;
+    const uint8_t* y = i420.ptr<uint8_t>();
+    const uint8_t* u = y + width * height;
+    const uint8_t* v = u + (width / 2) * (height / 2);
+
+    if (format == PixelFormat::NV12) {
+        Mat nv12(height * 3 / 2, width, CV_8UC1);
+        memcpy(nv12.data, y, static_cast<size_t>(width) * height);
+        uint8_t* uv = nv12.ptr<uint8_t>(height);
+        for (int i = 0; i < (width / 2) * (height / 2); i++) {
+            uv[2 * i] = u[i];
+            uv[2 * i + 1] = v[i];
+        }
+        return nv12;
+    }
+
+    // YUYV carries chroma on every row; rows of a pair share the same I420 samples
+    Mat yuyv(height, width, CV_8UC2);
+    for (int row = 0; row < height; row++) {
+        uint8_t* out = yuyv.ptr<uint8_t>(row);
+        const uint8_t* luma = y + row * width;
+        const uint8_t* uRow = u + (row / 2) * (width / 2);
+        const uint8_t* vRow = v + (row / 2) * (width / 2);
+        for (int x = 0; x < width; x += 2) {
+            out[2 * x] = luma[x];
+            out[2 * x + 1] = uRow[x / 2];
+            out[2 * x + 2] = luma[x + 1];
+            out[2 * x + 3] = vRow[x / 2];
+        }
+    }
+    return yuyv;
+}
@@ -0,0 +1,125 @@
+#include "Headers/PerfCounters.hpp"
+#include <cstring>
+#include <cerrno>
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+static const uint64_t EVENT_CONFIGS[] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+};
+
+// Open one disabled user-space counter on a single thread
+static int openCounter(uint64_t config, pid_t threadId) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, threadId, -1, -1, 0));
+}
+#endif
+
+PerfCounters::PerfCounters() {                                                                                          // Constructor probing whether counters can be opened
+#ifdef __linux__
+    int probe = openCounter(PERF_COUNT_HW_INSTRUCTIONS, 0);
+    if (probe < 0) {
+        unavailableReason = string("perf_event_open failed: ") + strerror(errno);
+        return;
+    }
+    close(probe);
+    available = true;
+#else
+    unavailableReason = "hardware counters are only supported on Linux";
+#endif
+}
+
+PerfCounters::~PerfCounters() {                                                                                         // Destructor
+    closeAll();
+}
+
+void PerfCounters::closeAll() {                                                                                         // Close every open counter
+#ifdef __linux__
+    for (int fd : descriptors) {
+        if (fd >= 0) close(fd);
+    }
+#endif
+    descriptors.clear();
+}
+
+void PerfCounters::start() {                                                                                            // Open and enable counters on every current thread
+    closeAll();
+    incomplete = false;
+    if (!available) return;
+
+#ifdef __linux__
+    error_code error;
+    for (const auto& entry : filesystem::directory_iterator("/proc/self/task", error)) {
+        pid_t threadId = static_cast<pid_t>(stol(entry.path().filename().string()));
+        for (uint64_t config : EVENT_CONFIGS) {
+            int fd = openCounter(config, threadId);
+            // A thread that exited since the listing does no work while we measure
+            if (fd < 0 && errno != ESRCH) incomplete = true;
+            descriptors.push_back(fd);
+        }
+    }
+
+    for (int fd : descriptors) {
+        if (fd < 0) continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+CounterSample PerfCounters::stop() {                                                                                    // Disable, read and sum the counters
+    CounterSample sample;
+    if (!available || descriptors.empty()) return sample;
+
+#ifdef __linux__
+    uint64_t totals[NUM_EVENTS] = {0, 0, 0, 0};
+    bool anyRead = false;
+
+    for (size_t i = 0; i < descriptors.size(); i++) {
+        int fd = descriptors[i];
+        if (fd < 0) continue;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+        // value, time enabled, time running; scale up when the PMU was multiplexed
+        uint64_t values[3] = {0, 0, 0};
+        if (read(fd, values, sizeof(values)) != static_cast<ssize_t>(sizeof(values))) {
+            incomplete = true;
+            continue;
+        }
+        double scale = (values[2] > 0) ? static_cast<double>(values[1]) / values[2] : 1.0;
+        totals[i % NUM_EVENTS] += static_cast<uint64_t>(values[0] * scale);
+        anyRead = true;
+    }
+    closeAll();
+
+    if (incomplete && !warnedIncomplete) {
+        cerr << "Warning: Hardware counters could not be opened or read on every thread; counter metrics are left out." << endl;
+        warnedIncomplete = true;
+    }
+    sample.valid = anyRead && !incomplete;
+    sample.cycles = totals[0];
+    sample.instructions = totals[1];
+    sample.llcMisses = totals[2];
+    sample.branchMisses = totals[3];
+#endif
+    return sample;
+}
@@ -1,92 +1,204 @@
 #include "Headers/PerformanceVisualization.hpp"
 
+PerformanceVisualization::PerformanceVisualization(const string& resPath)                                                // Constructor starting the render thread
+    : resourcesPath(resPath) {
+    renderThread = thread(&PerformanceVisualization::renderLoop, this);
+}
+
+PerformanceVisualization::~PerformanceVisualization() {                                                                 // Destructor finishing the queued plot
+    {
+        lock_guard<mutex> lock(renderMutex);
+        stopping = true;
+    }
+    renderCondition.notify_all();
+    renderThread.join();
+}
+
 void PerformanceVisualization::plotPerformance(const unordered_map<string, vector<double>>& performanceData) {
+    auto job = make_unique<RenderJob>();
+    job->config = plotConfig;
+    job->data = performanceData;
+    if (!plotConfig.outputName.empty()) {
+        job->outputPath = resourcesPath + "/" + plotConfig.outputName;
+    }
+
+    {
+        lock_guard<mutex> lock(renderMutex);
+        auto sameOutput = find_if(pendingJobs.begin(), pendingJobs.end(), [&](const unique_ptr<RenderJob>& pending) {
+            return pending->outputPath == job->outputPath && pending->config.windowName == job->config.windowName;
+        });
+        if (sameOutput != pendingJobs.end()) {
+            *sameOutput = move(job);
+        } else {
+            pendingJobs.push_back(move(job));
+        }
+    }
+    renderCondition.notify_one();
+}
+
+bool PerformanceVisualization::showLatestPlot() {
+    unordered_map<string, Mat> plots;
+    {
+        lock_guard<mutex> lock(renderMutex);
+        if (latestPlots.empty()) return false;
+        plots.swap(latestPlots);
+    }
+
+    for (const auto& [windowName, plot] : plots) {
+        namedWindow(windowName, WINDOW_NORMAL);
+        imshow(windowName, plot);
+    }
+    return true;
+}
+
+void PerformanceVisualization::renderLoop() {
+    while (true) {
+        unique_ptr<RenderJob> job;
+        {
+            unique_lock<mutex> lock(renderMutex);
+            renderCondition.wait(lock, [this]() { return stopping || !pendingJobs.empty(); });
+            if (pendingJobs.empty()) return;
+            job = move(pendingJobs.front());
+            pendingJobs.pop_front();
+        }
+
+        Mat plot = render(*job);
+        {
+            lock_guard<mutex> lock(renderMutex);
+            latestPlots[job->config.windowName] = plot;
+        }
 
-    int originalWidth = plotConfig.width;
+        // Save the graph
+        if (!job->outputPath.empty()) {
+            imwrite(job->outputPath, plot);
+        }
+    }
+}
+
+// Round the axis maximum up to one significant digit
+double PerformanceVisualization::niceScale(double maxValue) {
+    if (maxValue <= 0) return 1;
+    double magnitude = pow(10.0, floor(log10(maxValue)));
+    return ceil(maxValue / magnitude) * magnitude;
+}
+
+Mat PerformanceVisualization::render(const RenderJob& job) {
+    renderConfig = job.config;
+    int plotWidth = renderConfig.width;
     int legendWidth = 250;  // Width reserved for the legend
-    plotConfig.width += legendWidth;  // Extra space for the legend
-    
-    // Create the background with configuration values
-    plotImage = Mat(plotConfig.height, plotConfig.width, CV_8UC3, plotConfig.backgroundColor);
+    int canvasWidth = plotWidth + legendWidth;
 
-    // Find max and min values for better scaling
+    // Find the max value for scaling
     double maxTime = 0;
-    double minTime = std::numeric_limits<double>::max();
-    for (const auto& [filter, times] : performanceData) {
-        maxTime = max(maxTime, *max_element(times.begin(), times.end()));
-        minTime = min(minTime, *min_element(times.begin(), times.end()));
+    for (const auto& [filter, times] : job.data) {
+        if (!times.empty()) {
+            maxTime = max(maxTime, *max_element(times.begin(), times.end()));
+        }
+    }
+    double maxScaleValue = niceScale(maxTime * 1.1);  // Add 10% padding
+
+    // Grid, axes and title only change with the layout or the axis scale
+    stringstream key;
+    key << canvasWidth << "x" << renderConfig.height << "|" << maxScaleValue << "|" << renderConfig.title << "|"
+        << renderConfig.xLabel << "|" << renderConfig.yLabel << "|" << renderConfig.yUnit << "|" << renderConfig.showGrid << "|"
+        << renderConfig.xTickCount << "," << renderConfig.xTickStart << "," << renderConfig.xTickStep << "|";
+    for (const auto& label : renderConfig.xTickLabels) {
+        key << label << ",";
+    }
+    key << "|"
+        << renderConfig.yScaleDivisor << "," << renderConfig.valuePrecision << "|" << renderConfig.fontSize << "|" << renderConfig.lineThickness;
+    for (const Scalar& color : {renderConfig.backgroundColor, renderConfig.textColor, renderConfig.axisColor}) {
+        key << "|" << color[0] << "," << color[1] << "," << color[2];
+    }
+    if (key.str() != staticLayerKey || staticLayer.empty()) {
+        drawStaticLayer(maxScaleValue, plotWidth, canvasWidth);
+        staticLayerKey = key.str();
     }
 
-    maxTime *= 1.1;  // Add 10% padding
+    // Only the series and the legend, whose averages change, are drawn per update
+    staticLayer.copyTo(plotImage);
+    drawSeries(job.data, maxScaleValue, plotWidth);
+
+    // Place the legend completely to the right of the graph
+    drawLegendOutsideGraph(job.data, plotWidth);
+
+    return plotImage.clone();
+}
+
+void PerformanceVisualization::drawStaticLayer(double maxScaleValue, int plotWidth, int canvasWidth) {
+    // Create the background with configuration values
+    plotImage = Mat(renderConfig.height, canvasWidth, CV_8UC3, renderConfig.backgroundColor);
 
     // Draw the grid first (if enabled)
-    if (plotConfig.showGrid) {
-        drawGrid(originalWidth);
+    if (renderConfig.showGrid) {
+        drawGrid(plotWidth);
     }
 
     // Draw axes with labels
-    drawAxes(maxTime, originalWidth);
+    drawAxes(maxScaleValue, plotWidth);
+
+    // Draw a vertical line to separate the graph from the legend
+    line(plotImage,
+         Point(plotWidth, 50),
+         Point(plotWidth, renderConfig.height - 50),
+         Scalar(200, 200, 200),
+         1,
+         LINE_AA);
+
+    // Draw the title
+    int titleY = 40;
+    putText(plotImage, renderConfig.title,
+           Point(plotWidth/2 - 100, titleY),
+           FONT_HERSHEY_SIMPLEX,
+           renderConfig.fontSize * 1.5,
+           renderConfig.textColor,
+           2);
 
-    // Plot the data
+    staticLayer = plotImage.clone();
+}
+
+void PerformanceVisualization::drawSeries(const unordered_map<string, vector<double>>& performanceData, double maxScaleValue, int plotWidth) {
     int colorIndex = 0;
     for (const auto& [filter, times] : performanceData) {
+        size_t positions = renderConfig.xPoints > 0 ? static_cast<size_t>(renderConfig.xPoints) : times.size();
+        Scalar color = renderConfig.colors[colorIndex % renderConfig.colors.size()];
+
+        // Fixed-width series (live charts) are right-aligned so the newest sample is always at the end
+        size_t offset = (renderConfig.rightAlign && positions > times.size()) ? positions - times.size() : 0;
+
         vector<Point> points;
-        for (size_t i = 0; i < times.size(); i++) {
-            int x = getXCoordinate(i, times.size(), originalWidth);
-            int y = getYCoordinate(times[i], maxTime);
+        for (size_t i = 0; i < times.size() && i < positions; i++) {
+            int x = getXCoordinate(static_cast<int>(offset + i), positions, plotWidth);
+            int y = getYCoordinate(times[i], maxScaleValue);
             points.push_back(Point(x, y));
-            
+
             // Draw the points
-            circle(plotImage, Point(x, y), 
-                   plotConfig.pointSize, 
-                   plotConfig.colors[colorIndex % plotConfig.colors.size()], 
-                   -1);
-
-            // Divide by 1000 for display in thousands (k)
-            stringstream ss;
-            ss << fixed << setprecision(0) << times[i];  // Divide by 1000
-            
-            putText(plotImage, ss.str(), 
-                   Point(x - 15, y - 10),  // Position above the point
-                   FONT_HERSHEY_SIMPLEX, 
-                   plotConfig.fontSize * 0.6,
-                   plotConfig.textColor, 
-                   1);
+            circle(plotImage, Point(x, y), renderConfig.pointSize, color, -1);
+
+            if (renderConfig.showValues) {
+                stringstream ss;
+                ss << fixed << setprecision(renderConfig.valuePrecision) << times[i];
+
+                putText(plotImage, ss.str(),
+                       Point(x - 15, y - 10),  // Position above the point
+                       FONT_HERSHEY_SIMPLEX,
+                       renderConfig.fontSize * 0.6,
+                       renderConfig.textColor,
+                       1);
+            }
         }
 
         // Draw lines between points
-        for (size_t i = 0; i < points.size() - 1; i++) {
-            line(plotImage, points[i], points[i + 1], 
-                 plotConfig.colors[colorIndex % plotConfig.colors.size()], 
-                 plotConfig.lineThickness);
+        for (size_t i = 1; i < points.size(); i++) {
+            line(plotImage, points[i - 1], points[i], color, renderConfig.lineThickness);
         }
 
         colorIndex++;
     }
-
-    // Place the legend completely to the right of the graph
-    drawLegendOutsideGraph(performanceData, originalWidth);
-
-    // Draw the title
-    int titleY = 40;
-    putText(plotImage, plotConfig.title,
-           Point(originalWidth/2 - 100, titleY),
-           FONT_HERSHEY_SIMPLEX,
-           plotConfig.fontSize * 1.5,
-           plotConfig.textColor,
-           2);
-
-    // Display the graph
-    namedWindow("Performance Analysis", WINDOW_NORMAL);
-    imshow("Performance Analysis", plotImage);
-    waitKey(1);
-
-    // Save the graph
-    imwrite(resourcesPath + "/performance_plot.png", plotImage);
 }
 
 void PerformanceVisualization::drawLegendCompact(const unordered_map<string, vector<double>>& performanceData, int originalWidth) {
-    if (!plotConfig.showLegend) return;
+    if (!renderConfig.showLegend) return;
     
     // Position of the legend (outside the graph)
     int legendX = originalWidth - 150;  // reduce the width
@@ -102,8 +214,8 @@ void PerformanceVisualization::drawLegendCompact(const unordered_map<string, vec
     putText(plotImage, "Legend", 
             Point(legendX + 50, legendY - 5),
             FONT_HERSHEY_SIMPLEX, 
-            plotConfig.fontSize, 
-            plotConfig.textColor, 
+            renderConfig.fontSize, 
+            renderConfig.textColor, 
             1);
     
     // Draw each legend entry
@@ -114,7 +226,7 @@ void PerformanceVisualization::drawLegendCompact(const unordered_map<string, vec
         // colored rectangle
         Rect colorRect(legendX, legendY, 15, 15);
         rectangle(plotImage, colorRect, 
-                 plotConfig.colors[colorIndex % plotConfig.colors.size()], 
+                 renderConfig.colors[colorIndex % renderConfig.colors.size()], 
                  -1);
                  
         // Calculate average time
@@ -125,8 +237,8 @@ void PerformanceVisualization::drawLegendCompact(const unordered_map<string, vec
         putText(plotImage, ss.str(),
                Point(legendX + 25, legendY + 12),
                FONT_HERSHEY_SIMPLEX,
-               plotConfig.fontSize * 0.8,
-               plotConfig.textColor,
+               renderConfig.fontSize * 0.8,
+               renderConfig.textColor,
                1);
                
         // Pass to the next line
@@ -135,7 +247,7 @@ void PerformanceVisualization::drawLegendCompact(const unordered_map<string, vec
     }
 }
 void PerformanceVisualization::drawLegendBox(const unordered_map<string, vector<double>>& performanceData, int originalWidth) {
-    if (!plotConfig.showLegend) return;
+    if (!renderConfig.showLegend) return;
     
     // Position of the legend
     int legendX = originalWidth - 250;
@@ -153,8 +265,8 @@ void PerformanceVisualization::drawLegendBox(const unordered_map<string, vector<
     putText(plotImage, "Legend", 
             Point(legendX + legendWidth/2 - 30, legendY - 10),
             FONT_HERSHEY_SIMPLEX, 
-            plotConfig.fontSize * 1.2, 
-            plotConfig.textColor, 
+            renderConfig.fontSize * 1.2, 
+            renderConfig.textColor, 
             1);
     
     // Draw each legend entry
@@ -163,7 +275,7 @@ void PerformanceVisualization::drawLegendBox(const unordered_map<string, vector<
         // Draw colored rectangle
         Rect colorRect(legendX, legendY + colorIndex * legendSpacing, 20, 15);
         rectangle(plotImage, colorRect, 
-                 plotConfig.colors[colorIndex % plotConfig.colors.size()], 
+                 renderConfig.colors[colorIndex % renderConfig.colors.size()], 
                  -1);
                  
         // Calculate average time
@@ -176,8 +288,8 @@ void PerformanceVisualization::drawLegendBox(const unordered_map<string, vector<
         putText(plotImage, ss.str(),
                Point(legendX + 30, legendY + colorIndex * legendSpacing + 12),
                FONT_HERSHEY_SIMPLEX,
-               plotConfig.fontSize * 0.8,
-               plotConfig.textColor,
+               renderConfig.fontSize * 0.8,
+               renderConfig.textColor,
                1);
                
         colorIndex++;
@@ -185,7 +297,7 @@ void PerformanceVisualization::drawLegendBox(const unordered_map<string, vector<
 }
 // Add the legend outside the graph
 void PerformanceVisualization::drawLegendOutside(const unordered_map<string, vector<double>>& performanceData, int originalWidth) {
-    if (!plotConfig.showLegend) return;
+    if (!renderConfig.showLegend) return;
     
     // Position of departure of the legend (outside the graph)
     int legendX = originalWidth + 20;  // 20 pixels after the end of the graph
@@ -201,8 +313,8 @@ void PerformanceVisualization::drawLegendOutside(const unordered_map<string, vec
     putText(plotImage, "Legend", 
             Point(legendX + 90, legendY - 10),
             FONT_HERSHEY_SIMPLEX, 
-            plotConfig.fontSize * 1.2, 
-            plotConfig.textColor, 
+            renderConfig.fontSize * 1.2, 
+            renderConfig.textColor, 
             1);
     
     // Draw each legend entry
@@ -211,7 +323,7 @@ void PerformanceVisualization::drawLegendOutside(const unordered_map<string, vec
 
         Rect colorRect(legendX, legendY, 20, 20);
         rectangle(plotImage, colorRect, 
-                 plotConfig.colors[colorIndex % plotConfig.colors.size()], 
+                 renderConfig.colors[colorIndex % renderConfig.colors.size()], 
                  -1);
                  
         double avgTime = accumulate(times.begin(), times.end(), 0.0) / times.size();
@@ -222,8 +334,8 @@ void PerformanceVisualization::drawLegendOutside(const unordered_map<string, vec
         putText(plotImage, ss.str(),
                Point(legendX + 30, legendY + 15),
                FONT_HERSHEY_SIMPLEX,
-               plotConfig.fontSize,
-               plotConfig.textColor,
+               renderConfig.fontSize,
+               renderConfig.textColor,
                1);
                
         legendY += legendSpacing;
@@ -234,7 +346,7 @@ void PerformanceVisualization::drawLegendOutside(const unordered_map<string, vec
 // limit of the graph
 void PerformanceVisualization::drawGrid(int plotWidth) {
     const int stepX = (plotWidth - 100) / 10;  // 10 verticales lignes
-    const int stepY = (plotConfig.height - 100) / 10;  // 10 horizontal lines
+    const int stepY = (renderConfig.height - 100) / 10;  // 10 horizontal lines
 
     Scalar gridColor(220, 220, 220);  // Light gray
 
@@ -242,14 +354,14 @@ void PerformanceVisualization::drawGrid(int plotWidth) {
     for (int x = 50; x <= plotWidth - 50; x += stepX) {
         line(plotImage,
              Point(x, 50),
-             Point(x, plotConfig.height - 50),
+             Point(x, renderConfig.height - 50),
              gridColor,
              1,
              LINE_AA);
     }
 
     // Draw grid lines horizontally
-    for (int y = 50; y <= plotConfig.height - 50; y += stepY) {
+    for (int y = 50; y <= renderConfig.height - 50; y += stepY) {
         line(plotImage,
              Point(50, y),
              Point(plotWidth - 50, y),
@@ -260,98 +372,97 @@ void PerformanceVisualization::drawGrid(int plotWidth) {
 }
 
 // limit axes of the graph and labels
-void PerformanceVisualization::drawAxes(double maxTime, int plotWidth) {
+void PerformanceVisualization::drawAxes(double maxScaleValue, int plotWidth) {
     // draw the principal axes
     line(plotImage,
-        Point(50, plotConfig.height - 50),
+        Point(50, renderConfig.height - 50),
         Point(50, 50),
-        plotConfig.axisColor,
-        plotConfig.lineThickness);
+        renderConfig.axisColor,
+        renderConfig.lineThickness);
    
    line(plotImage,
-        Point(50, plotConfig.height - 50),
-        Point(plotWidth - 50, plotConfig.height - 50),
-        plotConfig.axisColor,
-        plotConfig.lineThickness);
+        Point(50, renderConfig.height - 50),
+        Point(plotWidth - 50, renderConfig.height - 50),
+        renderConfig.axisColor,
+        renderConfig.lineThickness);
 
    // Y axis labels values
-   // Round maxTime to a nice round number for better readability
-   double maxScaleValue = ceil(maxTime / 100000.0) * 100000;
    int numYLabels = 10;
    
    for (int i = 0; i <= numYLabels; i++) {
        // Calculate the y-coordinate for this label
-       int y = plotConfig.height - 50 - (i * (plotConfig.height - 100) / numYLabels);
+       int y = renderConfig.height - 50 - (i * (renderConfig.height - 100) / numYLabels);
        
        // Calculate the actual value this position represents
        double value = (maxScaleValue * i) / numYLabels;
        
        // Draw a small tick on the y-axis
-       line(plotImage, Point(45, y), Point(50, y), plotConfig.axisColor, 1);
+       line(plotImage, Point(45, y), Point(50, y), renderConfig.axisColor, 1);
        
        // Format and draw the label
        stringstream ss;
-       ss << fixed << setprecision(0) << value / 1000;
+       ss << fixed << setprecision(renderConfig.valuePrecision) << value / renderConfig.yScaleDivisor;
        putText(plotImage, ss.str(),
               Point(20, y + 5),
               FONT_HERSHEY_SIMPLEX,
-              plotConfig.fontSize * 0.8,
-              plotConfig.textColor,
+              renderConfig.fontSize * 0.8,
+              renderConfig.textColor,
               1);
    }
 
-    // X axis labels values (1, 2, 3...)
-    for (int i = 1; i <= 10; i++) {
-        int x = getXCoordinate(i-1, 10, plotWidth);
-        putText(plotImage, to_string(i),
-               Point(x - 10, plotConfig.height - 30),
+    // X axis labels values (1, 2, 3... by default)
+    for (int i = 0; i < renderConfig.xTickCount; i++) {
+        int x = getXCoordinate(i, renderConfig.xTickCount, plotWidth);
+        bool named = i < static_cast<int>(renderConfig.xTickLabels.size());
+        string label = named ? renderConfig.xTickLabels[i] : to_string(renderConfig.xTickStart + i * renderConfig.xTickStep);
+        int labelOffset = named ? getTextSize(label, FONT_HERSHEY_SIMPLEX, renderConfig.fontSize, 1, nullptr).width / 2 : 10;
+        putText(plotImage, label,
+               Point(x - labelOffset, renderConfig.height - 30),
                FONT_HERSHEY_SIMPLEX,
-               plotConfig.fontSize,
-               plotConfig.textColor,
+               renderConfig.fontSize,
+               renderConfig.textColor,
                1);
     }
 
     // create a rectangle for the Y axis title
-    Rect yTitleRect(-15, plotConfig.height/2 - 150, 30, 300);
+    Rect yTitleRect(-15, renderConfig.height/2 - 150, 30, 300);
     rectangle(plotImage, yTitleRect, Scalar(255, 255, 255), -1);
     rectangle(plotImage, yTitleRect, Scalar(230, 230, 230), 1);
 
     // Draw Y axis title text vertically
-    string yLabelText = "Processing Time";
-    
+
     int fontFace = FONT_HERSHEY_SIMPLEX;
-    double fontScale = plotConfig.fontSize * 0.9;
+    double fontScale = renderConfig.fontSize * 0.9;
     int thickness = 1;
     int lineType = LINE_AA;
-    int yPos = plotConfig.height/2 - 120;
+    int yPos = renderConfig.height/2 - 120;
     
     // Draw the characters one by one
-    vector<char> chars = {'P', 'r', 'o', 'c', 'e', 's', 's', 'i', 'n', 'g', ' ', 'T', 'i', 'm', 'e'};
-    
-    for (char c : chars) {
-        putText(plotImage, string(1, c), Point(0, yPos), fontFace, fontScale, plotConfig.textColor, thickness, lineType);
+    for (char c : renderConfig.yLabel) {
+        putText(plotImage, string(1, c), Point(0, yPos), fontFace, fontScale, renderConfig.textColor, thickness, lineType);
         yPos += 20;
     }
     
     // Draw the time unit
-    putText(plotImage, "(x1000 us)", Point(5, 40), fontFace, fontScale * 0.9, plotConfig.textColor, thickness, lineType);
+    putText(plotImage, renderConfig.yUnit, Point(5, 40), fontFace, fontScale * 0.9, renderConfig.textColor, thickness, lineType);
 
     // Draw X axis title
-    putText(plotImage, plotConfig.xLabel,
-           Point(plotWidth/2 - 50, plotConfig.height - 10),
+    putText(plotImage, renderConfig.xLabel,
+           Point(plotWidth/2 - 50, renderConfig.height - 10),
            FONT_HERSHEY_SIMPLEX,
-           plotConfig.fontSize,
-           plotConfig.textColor,
+           renderConfig.fontSize,
+           renderConfig.textColor,
            1,
            LINE_AA);
 }
 
 // modifiy the x coordinate of the point of the graph to fit the graph
 int PerformanceVisualization::getXCoordinate(int index, size_t totalPoints, int plotWidth) {
-    return 50 + (index * (plotWidth - 100) / (totalPoints - 1));
+    if (totalPoints < 2) return 50;
+    return 50 + (index * (plotWidth - 100) / static_cast<int>(totalPoints - 1));
 }
 void PerformanceVisualization::drawLegendOutsideGraph(const unordered_map<string, vector<double>>& performanceData, int originalWidth) {
-    if (!plotConfig.showLegend) return;
+    if (!renderConfig.showLegend) return;
     
     int legendX = originalWidth + 20;
     int legendY = 100;
@@ -359,14 +470,6 @@ void PerformanceVisualization::drawLegendOutsideGraph(const unordered_map<string
     int legendWidth = 200;
     int legendHeight = performanceData.size() * legendSpacing + 40;
     
-    // Draw a vertical line to separate the graph from the legend
-    line(plotImage, 
-         Point(originalWidth, 50), 
-         Point(originalWidth, plotConfig.height - 50),
-         Scalar(200, 200, 200), 
-         1, 
-         LINE_AA);
-    
     Rect legendBackground(legendX, legendY - 30, legendWidth, legendHeight);
     rectangle(plotImage, legendBackground, Scalar(255, 255, 255), -1);
     rectangle(plotImage, legendBackground, Scalar(200, 200, 200), 1);
@@ -374,36 +477,33 @@ void PerformanceVisualization::drawLegendOutsideGraph(const unordered_map<string
     putText(plotImage, "Legend", 
             Point(legendX + legendWidth/2 - 30, legendY - 10),
             FONT_HERSHEY_SIMPLEX, 
-            plotConfig.fontSize * 1.2, 
-            plotConfig.textColor, 
+            renderConfig.fontSize * 1.2, 
+            renderConfig.textColor, 
             1);
     
     int colorIndex = 0;
     for (const auto& [filter, times] : performanceData) {
         Rect colorRect(legendX + 10, legendY + colorIndex * legendSpacing, 20, 15);
         rectangle(plotImage, colorRect, 
-                 plotConfig.colors[colorIndex % plotConfig.colors.size()], 
+                 renderConfig.colors[colorIndex % renderConfig.colors.size()], 
                  -1);
 
-        double avgTime = accumulate(times.begin(), times.end(), 0.0) / times.size();
+        double avgTime = times.empty() ? 0 : accumulate(times.begin(), times.end(), 0.0) / times.size();
         stringstream ss;
-        ss << filter << " (avg: " << fixed << setprecision(1) << avgTime / 1000 << "k)";
+        ss << filter << " (avg: " << fixed << setprecision(1) << avgTime / renderConfig.yScaleDivisor << renderConfig.valueSuffix << ")";
         
         putText(plotImage, ss.str(),
                Point(legendX + 40, legendY + colorIndex * legendSpacing + 12),
                FONT_HERSHEY_SIMPLEX,
-               plotConfig.fontSize * 0.8,
-               plotConfig.textColor,
+               renderConfig.fontSize * 0.8,
+               renderConfig.textColor,
                1);
                
         colorIndex++;
     }
 }
 
-int PerformanceVisualization::getYCoordinate(double value, double maxValue) {
-    // Scale to the rounded max value, not the actual max value
-    double maxScaleValue = ceil(maxValue / 100000.0) * 100000;
-    
+int PerformanceVisualization::getYCoordinate(double value, double maxScaleValue) {
     // Map the value to the plot height, with 50 pixels of padding on top and bottom
-    return plotConfig.height - 50 - (value * (plotConfig.height - 100) / maxScaleValue);
+    return renderConfig.height - 50 - (value * (renderConfig.height - 100) / maxScaleValue);
 }
\ No newline at end of file
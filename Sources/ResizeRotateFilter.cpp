@@ -5,9 +5,6 @@ ResizeRotateFilter::ResizeRotateFilter(double scale, double angle)
 }
 
 ResizeRotateFilter::~ResizeRotateFilter() {                                                                         // Destructor
-    #ifdef __APPLE__
-        destroyWindow(windowName);
-    #endif
 }
 
 void ResizeRotateFilter::setScale(double scale) {                                                                   // Set the scale factor for resizing
@@ -0,0 +1,108 @@
+#include "Headers/ResultCache.hpp"
+#include "Headers/ImageKernels.hpp"
+#include "Headers/TraceRecorder.hpp"
+
+ResultCache::ResultCache(size_t capacityBytes)                                                                          // Constructor registering the cache metrics
+    : capacity(capacityBytes),
+      hitCounter(MetricsRegistry::instance().counter("cpmulti_result_cache_hits_total", "Filter results served from the cache")),
+      missCounter(MetricsRegistry::instance().counter("cpmulti_result_cache_misses_total", "Cache lookups that had to filter")),
+      evictionCounter(MetricsRegistry::instance().counter("cpmulti_result_cache_evictions_total", "Results dropped to stay within the memory bound")),
+      bytesGauge(MetricsRegistry::instance().gauge("cpmulti_result_cache_bytes", "Bytes held by the result cache")) {
+}
+
+void ResultCache::setCapacity(size_t capacityBytes) {                                                                   // Change the memory bound, evicting as needed
+    lock_guard<mutex> lock(cacheMutex);
+    capacity = capacityBytes;
+    evictLocked();
+}
+
+size_t ResultCache::getCapacity() const {
+    lock_guard<mutex> lock(cacheMutex);
+    return capacity;
+}
+
+uint64_t ResultCache::hashImage(const Mat& image) {                                                                     // Hash the pixels, skipping any padding between rows
+    TRACE_SCOPE("content hash", "cache");
+    size_t rowBytes = image.cols * image.elemSize();
+    if (image.isContinuous()) {
+        return ImageKernels::hash64(image.data, rowBytes * image.rows);
+    }
+    // Same value as the contiguous case, so a view shares entries with a copy of its pixels
+    return ImageKernels::hash64Rows(image.data, rowBytes, image.rows, image.step[0]);
+}
+
+CacheKey ResultCache::makeKey(const Mat& input, const string& filterId) {
+    CacheKey key;
+    key.contentHash = hashImage(input);
+    key.size = input.size();
+    key.type = input.type();
+    key.filterId = filterId;
+    return key;
+}
+
+bool ResultCache::lookup(const CacheKey& key, Mat& output) {                                                            // Find a result and mark it most recently used
+    Mat cached;
+    {
+        lock_guard<mutex> lock(cacheMutex);
+        auto it = index.find(key);
+        if (it == index.end()) {
+            missCount++;
+            missCounter.increment();
+            return false;
+        }
+        entries.splice(entries.begin(), entries, it->second);
+        cached = it->second->output;    // Keeps the data alive if the entry is evicted meanwhile
+        hitCount++;
+        hitCounter.increment();
+    }
+    output = cached.clone();
+    return true;
+}
+
+void ResultCache::insert(const CacheKey& key, const Mat& output) {                                                      // Store a private copy of a result
+    if (output.empty()) return;
+    size_t bytes = output.total() * output.elemSize();
+
+    lock_guard<mutex> lock(cacheMutex);
+    if (bytes > capacity) return;   // Would evict everything and still not fit
+
+    auto it = index.find(key);
+    if (it != index.end()) {
+        // Another caller filtered the same frame concurrently; keep the first result
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+    entries.push_front({key, output.clone(), bytes});
+    index[key] = entries.begin();
+    usedBytes += bytes;
+    evictLocked();
+}
+
+void ResultCache::clear() {
+    lock_guard<mutex> lock(cacheMutex);
+    entries.clear();
+    index.clear();
+    usedBytes = 0;
+    bytesGauge.set(0);
+}
+
+size_t ResultCache::sizeBytes() const {
+    lock_guard<mutex> lock(cacheMutex);
+    return usedBytes;
+}
+
+size_t ResultCache::entryCount() const {
+    lock_guard<mutex> lock(cacheMutex);
+    return entries.size();
+}
+
+void ResultCache::evictLocked() {                                                                                       // Drop least recently used entries until within the bound
+    while (usedBytes > capacity && !entries.empty()) {
+        const Entry& oldest = entries.back();
+        usedBytes -= oldest.bytes;
+        index.erase(oldest.key);
+        entries.pop_back();
+        evictionCounter.increment();
+    }
+    bytesGauge.set(static_cast<double>(usedBytes));
+}
@@ -0,0 +1,158 @@
+#include "Headers/ScalingAnalysis.hpp"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <sstream>
+
+// A missing USL peak is printed as a placeholder; the CSV leaves it empty
+static string peakText(double value, int precision, const string& missing) {
+    if (isnan(value)) return missing;
+    ostringstream text;
+    text << fixed << setprecision(precision) << value;
+    return text.str();
+}
+
+vector<double> ScalingAnalysis::speedup(const vector<double>& times) {                                                 // T(1) / T(N) for every thread count
+    vector<double> result;
+    if (times.empty() || times[0] <= 0) return result;
+    for (double time : times) {
+        result.push_back(time > 0 ? times[0] / time : 0);
+    }
+    return result;
+}
+
+vector<double> ScalingAnalysis::efficiency(const vector<double>& times) {                                              // Speedup divided by the thread count
+    vector<double> result = speedup(times);
+    for (size_t i = 0; i < result.size(); i++) {
+        result[i] /= static_cast<double>(i + 1);
+    }
+    return result;
+}
+
+double ScalingAnalysis::amdahlSpeedup(double serialFraction, double threads) {                                          // Speedup predicted by Amdahl's law
+    return 1.0 / (serialFraction + (1.0 - serialFraction) / threads);
+}
+
+double ScalingAnalysis::uslSpeedup(double sigma, double kappa, double threads) {                                        // Speedup predicted by the Universal Scalability Law
+    return threads / (1.0 + sigma * (threads - 1.0) + kappa * threads * (threads - 1.0));
+}
+
+// Both models become linear least-squares problems without an intercept once rearranged:
+//   Amdahl: 1/S - 1/N = s (1 - 1/N)
+//   USL:    N/S - 1   = sigma (N - 1) + kappa N (N - 1)
+ScalingFit ScalingAnalysis::fit(const string& filterName, const vector<double>& times) {                              // Fit Amdahl and USL to a thread sweep
+    ScalingFit result;
+    result.filterName = filterName;
+
+    vector<double> measured = speedup(times);
+    if (measured.size() < 2) return result;
+
+    double xx = 0, xy = 0;
+    double aa = 0, ab = 0, bb = 0, ay = 0, by = 0;
+    for (size_t i = 1; i < measured.size(); i++) {
+        double n = static_cast<double>(i + 1);
+        double s = measured[i];
+        if (s <= 0) continue;
+
+        double x = 1.0 - 1.0 / n;
+        double y = 1.0 / s - 1.0 / n;
+        xx += x * x;
+        xy += x * y;
+
+        double a = n - 1.0;
+        double b = n * (n - 1.0);
+        double z = n / s - 1.0;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        ay += a * z;
+        by += b * z;
+    }
+
+    result.amdahlSerial = (xx > 0) ? clamp(xy / xx, 0.0, 1.0) : 0;
+
+    // Solve the 2x2 normal equations; a negative coefficient is pinned to zero and the other refitted
+    double determinant = aa * bb - ab * ab;
+    double sigma = (determinant != 0) ? (ay * bb - by * ab) / determinant : 0;
+    double kappa = (determinant != 0) ? (aa * by - ab * ay) / determinant : 0;
+    if (kappa < 0) {
+        kappa = 0;
+        sigma = (aa > 0) ? ay / aa : 0;
+    }
+    if (sigma < 0) {
+        sigma = 0;
+        kappa = (bb > 0) ? max(0.0, by / bb) : 0;
+    }
+    result.uslSigma = sigma;
+    result.uslKappa = kappa;
+
+    double amdahlError = 0, uslError = 0;
+    for (size_t i = 0; i < measured.size(); i++) {
+        double n = static_cast<double>(i + 1);
+        amdahlError += pow(measured[i] - amdahlSpeedup(result.amdahlSerial, n), 2);
+        uslError += pow(measured[i] - uslSpeedup(sigma, kappa, n), 2);
+    }
+    result.amdahlRmse = sqrt(amdahlError / measured.size());
+    result.uslRmse = sqrt(uslError / measured.size());
+
+    result.maxSpeedup = (result.amdahlSerial > 0) ? 1.0 / result.amdahlSerial : numeric_limits<double>::infinity();
+    double peakSquared = (kappa > 0) ? (1.0 - sigma) / kappa : 0;
+    if (kappa > 0 && peakSquared > 0 && isfinite(peakSquared)) {
+        result.peakThreads = sqrt(peakSquared);
+        result.peakSpeedup = uslSpeedup(sigma, kappa, result.peakThreads);
+    } else if (kappa > 0) {
+        // Contention of 1 or more: speedup only falls as threads are added, so there is no peak to report
+        result.peakThreads = numeric_limits<double>::quiet_NaN();
+        result.peakSpeedup = numeric_limits<double>::quiet_NaN();
+    } else {
+        result.peakThreads = numeric_limits<double>::infinity();
+        result.peakSpeedup = (sigma > 0) ? 1.0 / sigma : numeric_limits<double>::infinity();
+    }
+    return result;
+}
+
+void ScalingAnalysis::printFits(const vector<ScalingFit>& fits) {                                                       // Print one line per filter
+    cout << "\nScaling analysis (speedup over 1 thread):\n"
+         << left << setw(12) << "  Filter" << right
+         << setw(12) << "serial s" << setw(12) << "Amdahl max"
+         << setw(12) << "USL sigma" << setw(12) << "USL kappa"
+         << setw(12) << "peak N" << setw(12) << "peak S"
+         << setw(12) << "RMSE A/U" << "\n";
+
+    cout << fixed;
+    for (const auto& fit : fits) {
+        cout << "  " << left << setw(10) << fit.filterName << right
+             << setprecision(3) << setw(12) << fit.amdahlSerial
+             << setprecision(2) << setw(12) << fit.maxSpeedup
+             << setprecision(4) << setw(12) << fit.uslSigma
+             << setprecision(5) << setw(12) << fit.uslKappa
+             << setw(12) << peakText(fit.peakThreads, 1, "no peak")
+             << setprecision(2) << setw(12) << peakText(fit.peakSpeedup, 2, "-")
+             << setw(7) << fit.amdahlRmse << "/" << fit.uslRmse << "\n";
+    }
+    cout.unsetf(ios::floatfield);
+    cout << setprecision(6);
+}
+
+bool ScalingAnalysis::writeCsv(const string& path, const vector<ScalingFit>& fits) {                                   // Save the fitted coefficients
+    ofstream out(path);
+    if (!out) {
+        cerr << "Error: Unable to write scaling fit to " << path << endl;
+        return false;
+    }
+
+    out << "filter,amdahl_serial,amdahl_max_speedup,amdahl_rmse,usl_sigma,usl_kappa,usl_peak_threads,usl_peak_speedup,usl_rmse\n";
+    out << setprecision(6);
+    for (const auto& fit : fits) {
+        out << fit.filterName << "," << fit.amdahlSerial << "," << fit.maxSpeedup << "," << fit.amdahlRmse << ","
+            << fit.uslSigma << "," << fit.uslKappa << ",";
+        if (!isnan(fit.peakThreads)) out << fit.peakThreads;
+        out << ",";
+        if (!isnan(fit.peakSpeedup)) out << fit.peakSpeedup;
+        out << "," << fit.uslRmse << "\n";
+    }
+    return true;
+}
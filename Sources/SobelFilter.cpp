@@ -7,9 +7,6 @@ SobelFilter::SobelFilter(int dx, int dy, int ksize)
 }
 
 SobelFilter::~SobelFilter() {                                                                               // Destructor              
-    #ifdef __APPLE__
-        destroyWindow(windowName);
-    #endif
 }
 
 void SobelFilter::setDx(int dx) { this->dx = dx; }
@@ -30,23 +27,43 @@ Mat SobelFilter::applyFilter(const Mat& inputFrame) {
     if (inputFrame.channels() == 3)
         cvtColor(inputFrame, gray, COLOR_BGR2GRAY);
     else
-        gray = inputFrame.clone();
+        gray = inputFrame;
+
+    Mat grad_x, grad_y, grad;
 
-    Mat grad_x, grad_y, abs_grad_x, abs_grad_y, grad;
     // Compute gradients only if the derivative orders are nonzero.
+    // Replicated borders match the gradients FrameContext shares with Canny
     if (dx > 0)
-        Sobel(gray, grad_x, CV_16S, dx, 0, kernelSize);
-    else
-        grad_x = Mat::zeros(gray.size(), CV_16S);
-
+        Sobel(gray, grad_x, CV_16S, dx, 0, kernelSize, 1, 0, BORDER_REPLICATE);
     if (dy > 0)
-        Sobel(gray, grad_y, CV_16S, 0, dy, kernelSize);
-    else
-        grad_y = Mat::zeros(gray.size(), CV_16S);
+        Sobel(gray, grad_y, CV_16S, 0, dy, kernelSize, 1, 0, BORDER_REPLICATE);
+
+    // Absolute values and the 50/50 blend in one pass instead of three
+    grad.create(gray.size(), CV_8U);
+    ImageKernels::gradientMagnitude(grad_x.empty() ? nullptr : grad_x.ptr<int16_t>(),
+                                    grad_y.empty() ? nullptr : grad_y.ptr<int16_t>(),
+                                    grad.ptr<uint8_t>(), grad.total());
+    return grad;
+}
 
-    convertScaleAbs(grad_x, abs_grad_x);
-    convertScaleAbs(grad_y, abs_grad_y);
-    addWeighted(abs_grad_x, 0.5, abs_grad_y, 0.5, 0, grad);
+Mat SobelFilter::applyFilter(FrameContext& context, const Rect& region) {                                   // Sobel filter of a region from the frame's shared gradients
+    if (context.empty()) {
+        cerr << "Error: Empty input frame provided to SobelFilter." << endl;
+        return Mat();
+    }
+    // The context only holds first-order 3x3 derivatives
+    if (kernelSize != 3 || dx > 1 || dy > 1) {
+        return applyFilter(context.frame()(region));
+    }
 
+    // ROIs of the shared planes are not continuous, so the magnitude runs row by row
+    Mat grad_x = (dx > 0) ? context.gradientX()(region) : Mat();
+    Mat grad_y = (dy > 0) ? context.gradientY()(region) : Mat();
+    Mat grad(region.size(), CV_8U);
+    for (int y = 0; y < grad.rows; y++) {
+        ImageKernels::gradientMagnitude(grad_x.empty() ? nullptr : grad_x.ptr<int16_t>(y),
+                                        grad_y.empty() ? nullptr : grad_y.ptr<int16_t>(y),
+                                        grad.ptr<uint8_t>(y), grad.cols);
+    }
     return grad;
 }
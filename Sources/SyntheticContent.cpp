@@ -0,0 +1,71 @@
+#include "Headers/SyntheticContent.hpp"
+
+Mat SyntheticContent::generate(const Size& size, ContentClass content, uint64_t seed) {                                // Generate a BGR test image
+    RNG rng(seed);
+
+    switch (content) {
+        case ContentClass::Flat:
+            return Mat(size, CV_8UC3, Scalar(128, 128, 128));
+
+        case ContentClass::Noise: {
+            Mat image(size, CV_8UC3);
+            rng.fill(image, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+            return image;
+        }
+
+        case ContentClass::Natural: {
+            // Sum of upsampled random grids; each finer octave has less energy, like real scenes
+            Mat accumulated(size, CV_32FC3, Scalar::all(0));
+            Mat grid, upsampled;
+            double amplitude = 1.0, total = 0.0;
+            for (int cells = 4; cells <= size.width / 2; cells *= 2) {
+                int rows = max(2, cells * size.height / size.width);
+                grid.create(rows, cells, CV_32FC3);
+                rng.fill(grid, RNG::UNIFORM, Scalar::all(0), Scalar::all(1));
+                resize(grid, upsampled, size, 0, 0, INTER_CUBIC);
+                scaleAdd(upsampled, amplitude, accumulated, accumulated);
+                total += amplitude;
+                amplitude *= 0.6;
+            }
+            Mat image;
+            accumulated.convertTo(image, CV_8UC3, 255.0 / total);
+            return image;
+        }
+
+        case ContentClass::HighEdge: {
+            Mat image(size, CV_8UC3);
+            const int cell = 8;
+            for (int y = 0; y < size.height; y++) {
+                Vec3b* row = image.ptr<Vec3b>(y);
+                for (int x = 0; x < size.width; x++) {
+                    uchar value = (((x / cell) + (y / cell)) & 1) ? 220 : 30;
+                    row[x] = Vec3b(value, value, value);
+                }
+            }
+
+            // Random lines break up the regular grid so edges appear at every orientation
+            int lines = max(50, size.area() / 20000);
+            for (int i = 0; i < lines; i++) {
+                Point from(rng.uniform(0, size.width), rng.uniform(0, size.height));
+                Point to(rng.uniform(0, size.width), rng.uniform(0, size.height));
+                line(image, from, to, Scalar(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256)), 1);
+            }
+            return image;
+        }
+    }
+    return Mat();
+}
+
+string SyntheticContent::name(ContentClass content) {                                                                   // Short name used in reports and file names
+    switch (content) {
+        case ContentClass::Flat: return "flat";
+        case ContentClass::Noise: return "noise";
+        case ContentClass::Natural: return "natural";
+        case ContentClass::HighEdge: return "edges";
+    }
+    return "unknown";
+}
+
+vector<ContentClass> SyntheticContent::all() {                                                                          // Every content class, cheapest first
+    return {ContentClass::Flat, ContentClass::Noise, ContentClass::Natural, ContentClass::HighEdge};
+}
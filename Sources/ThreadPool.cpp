@@ -0,0 +1,117 @@
+#include "Headers/ThreadPool.hpp"
+#include <exception>
+#include <memory>
+#include "Headers/TraceRecorder.hpp"
+#include "Headers/CpuTopology.hpp"
+
+// Cleared on threads pinned to the reserved I/O CPUs, whose loops then run entirely on the pool
+static thread_local bool callerParticipates = true;
+
+ThreadPool::ThreadPool(int numWorkers, const vector<int>& workerCpus)                                                  // Constructor starting the workers
+    : queueDepth(MetricsRegistry::instance().gauge("cpmulti_pool_queue_depth", "Tasks waiting for a pool worker")) {
+    for (int i = 0; i < numWorkers; i++) {
+        int cpu = workerCpus.empty() ? -1 : workerCpus[i % workerCpus.size()];
+        // The worker number only names the thread in traces
+        workers.emplace_back([this, cpu]([[maybe_unused]] int worker) {
+            TRACE_THREAD_NAME("pool worker " + to_string(worker));
+            // Pin before the first task so everything the worker allocates is first touched on its node
+            if (cpu >= 0 && CpuTopology::pinCurrentThread({cpu})) {
+                pinned++;
+            }
+            workerLoop();
+        }, i + 1);
+    }
+}
+
+ThreadPool::~ThreadPool() {                                                                                             // Destructor finishing queued tasks and joining the workers
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueCondition.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::enqueue(function<void()> task) {                                                                       // Add a task to the queue
+    {
+        lock_guard<mutex> lock(queueMutex);
+        tasks.push(move(task));
+        queueDepth.set(static_cast<double>(tasks.size()));
+    }
+    queueCondition.notify_one();
+}
+
+void ThreadPool::setCallerParticipates(bool participates) {                                                             // Whether this thread runs its own parallelFor indices
+    callerParticipates = participates;
+}
+
+size_t ThreadPool::pendingTasks() const {                                                                               // Number of tasks waiting for a worker
+    lock_guard<mutex> lock(queueMutex);
+    return tasks.size();
+}
+
+void ThreadPool::workerLoop() {                                                                                         // Pull and run tasks until the pool stops
+    while (true) {
+        function<void()> task;
+        {
+            unique_lock<mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) return;
+            task = move(tasks.front());
+            tasks.pop();
+            queueDepth.set(static_cast<double>(tasks.size()));
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, int maxWorkers, const function<void(size_t, int)>& body) {                  // Split a loop between the caller and the pool
+    if (count == 0) return;
+
+    // Shared with the helpers; a helper that starts after the loop is finished only touches this state
+    struct LoopState {
+        atomic<size_t> next{0};
+        size_t done = 0;
+        mutex doneMutex;
+        condition_variable doneCondition;
+        exception_ptr error;
+    };
+    auto state = make_shared<LoopState>();
+
+    auto runIndices = [state, count, &body](int worker) {
+        for (size_t i = state->next++; i < count; i = state->next++) {
+            try {
+                body(i, worker);
+            } catch (...) {
+                lock_guard<mutex> lock(state->doneMutex);
+                if (!state->error) state->error = current_exception();
+            }
+            lock_guard<mutex> lock(state->doneMutex);
+            if (++state->done == count) {
+                state->doneCondition.notify_all();
+            }
+        }
+    };
+
+    bool callerWorks = callerParticipates || workers.empty();
+    int first = callerWorks ? 1 : 0;
+    int helpers = min(static_cast<int>(count), max(1, maxWorkers)) - first;
+    helpers = min(helpers, size());
+    for (int h = first; h < first + helpers; h++) {
+        enqueue([runIndices, h]() { runIndices(h); });
+    }
+
+    // The caller usually works too, then waits only for indices already taken by helpers
+    if (callerWorks) {
+        runIndices(0);
+    }
+
+    TRACE_SCOPE("join wait", "sync");
+    unique_lock<mutex> lock(state->doneMutex);
+    state->doneCondition.wait(lock, [&]() { return state->done == count; });
+    if (state->error) {
+        rethrow_exception(state->error);
+    }
+}
@@ -0,0 +1,105 @@
+#include "Headers/TraceRecorder.hpp"
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <algorithm>
+
+TraceRecorder& TraceRecorder::instance() {                                                                              // Process-wide recorder
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+TraceRecorder::TraceRecorder() : origin(chrono::steady_clock::now()) {                                                  // Constructor
+}
+
+int64_t TraceRecorder::nowNs() const {                                                                                  // Nanoseconds since the recorder was created
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - origin).count();
+}
+
+TraceRecorder::ThreadBuffer& TraceRecorder::localBuffer() {                                                             // Ring buffer of the calling thread, created on first use
+    // The recorder keeps the buffer alive after the thread exits so its events can still be exported
+    thread_local shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = make_shared<ThreadBuffer>();
+        buffer->events.resize(EVENTS_PER_THREAD);
+
+        lock_guard<mutex> lock(buffersMutex);
+        buffer->threadId = static_cast<int>(buffers.size()) + 1;
+        buffer->threadName = "thread " + to_string(buffer->threadId);
+        buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void TraceRecorder::record(const char* name, const char* category, int64_t startNs, int64_t endNs) {                  // Append an event without taking a lock
+    ThreadBuffer& buffer = localBuffer();
+    uint64_t index = buffer.written.load(memory_order_relaxed);
+
+    TraceEvent& event = buffer.events[index % EVENTS_PER_THREAD];
+    strncpy(event.name, name, sizeof(event.name) - 1);
+    event.name[sizeof(event.name) - 1] = '\0';
+    event.category = category;
+    event.startNs = startNs;
+    event.durationNs = endNs - startNs;
+
+    buffer.written.store(index + 1, memory_order_release);
+}
+
+void TraceRecorder::setThreadName(const string& name) {                                                                 // Name shown for the calling thread in the trace viewer
+    ThreadBuffer& buffer = localBuffer();
+    lock_guard<mutex> lock(buffersMutex);
+    buffer.threadName = name;
+}
+
+void TraceRecorder::clear() {                                                                                           // Forget all recorded events
+    lock_guard<mutex> lock(buffersMutex);
+    for (auto& buffer : buffers) {
+        buffer->written.store(0, memory_order_release);
+    }
+}
+
+// Escape the few characters that can appear in filter and thread names
+static string escapeJson(const string& text) {
+    string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+bool TraceRecorder::writeChromeTrace(const string& path) const {                                                        // Export every buffer as Chrome trace JSON
+    ofstream out(path);
+    if (!out) {
+        cerr << "Error: Unable to write trace file " << path << endl;
+        return false;
+    }
+
+    lock_guard<mutex> lock(buffersMutex);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    size_t exported = 0;
+
+    for (const auto& buffer : buffers) {
+        if (!first) out << ",\n";
+        first = false;
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+            << ",\"args\":{\"name\":\"" << escapeJson(buffer->threadName) << "\"}}";
+
+        // Only the newest EVENTS_PER_THREAD events survive in the ring
+        uint64_t written = buffer->written.load(memory_order_acquire);
+        uint64_t begin = (written > EVENTS_PER_THREAD) ? written - EVENTS_PER_THREAD : 0;
+        for (uint64_t i = begin; i < written; i++) {
+            const TraceEvent& event = buffer->events[i % EVENTS_PER_THREAD];
+            out << ",\n{\"name\":\"" << escapeJson(event.name) << "\",\"cat\":\"" << event.category
+                << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId << fixed << setprecision(3)
+                << ",\"ts\":" << event.startNs / 1000.0 << ",\"dur\":" << event.durationNs / 1000.0 << "}";
+            exported++;
+        }
+    }
+    out << "\n]}\n";
+
+    cout << "Trace with " << exported << " events written to " << path << endl;
+    return static_cast<bool>(out);
+}
@@ -1,9 +1,66 @@
 #include "Headers/WebcamOperations.hpp"
 
-WebcamOperations::WebcamOperations() : imageProcessor(1) , keyHandler(imageProcessor, resourcesPath) {                              // Constructor
+WebcamOperations::WebcamOperations() : imageProcessor(1, 0, AffinityOptions::fromEnvironment()) , keyHandler(imageProcessor, resourcesPath), throughputChart(resourcesPath) {  // Constructor
+    setupThroughputChart();
+
+    // Live camera frames almost never repeat bit for bit, so the result cache costs a hash and a copy
+    // per frame for nothing; CPMULTI_RESULT_CACHE_MB turns it on for sources that do freeze or repeat
+    const char* cacheMb = getenv("CPMULTI_RESULT_CACHE_MB");
+    imageProcessor.getResultCache().setCapacity(static_cast<size_t>(max(0, cacheMb ? atoi(cacheMb) : 0)) << 20);
     cout << "WebCamOperations initialized." << endl;
 }
 
+void WebcamOperations::pinIoThread() {                                                                                              // Keep capture and display off the compute cores
+    const AffinityOptions& affinity = imageProcessor.getAffinity();
+    if (affinity.policy == AffinityPolicy::None) return;
+    const CpuTopology& topology = CpuTopology::instance();
+    vector<int> ioCpus = imageProcessor.getIoCpus();
+    bool pinned = CpuTopology::pinCurrentThread(ioCpus);
+    // Filters started from this thread would otherwise run their first unit on the reserved CPUs
+    ThreadPool::setCallerParticipates(!pinned);
+    cout << "CPU topology: " << topology.describe() << ". Workers " << CpuTopology::policyName(affinity.policy) << "-pinned ("
+         << imageProcessor.getThreadPool().pinnedWorkers() << "/" << imageProcessor.getThreadPool().size() << "), capture and display on "
+         << ioCpus.size() << " reserved CPU" << (ioCpus.size() == 1 ? "" : "s") << (pinned ? "." : " (pinning refused).") << endl;
+}
+
+void WebcamOperations::toggleRecording(const Mat& frame) {                                                                          // Start or stop recording raw frames
+    if (recorder.isOpen()) {
+        recorder.close();
+        cout << "Recorded " << recorder.framesWritten() << " frames to " << recorder.getPath() << " (" << recorder.framesDropped()
+             << " dropped). Replay with --replay " << recorder.getPath() << endl;
+        return;
+    }
+
+    if (!filesystem::exists(resourcesPath)) {
+        filesystem::create_directories(resourcesPath);
+    }
+    auto seconds = chrono::duration_cast<chrono::seconds>(chrono::system_clock::now().time_since_epoch()).count();
+    string path = resourcesPath + "/recording_" + to_string(seconds) + ".cpraw";
+    if (recorder.open(path, frame.size(), frame.type())) {
+        cout << "Recording raw frames to " << path << ". Press 'w' again to stop." << endl;
+    }
+}
+
+void WebcamOperations::setupThroughputChart() {                                                                                     // Live fps chart over the last minute
+    PerformanceVisualization::PlotConfig config;
+    config.title = "Live Throughput";
+    config.xLabel = "Seconds Ago";
+    config.yLabel = "Frames/s";
+    config.yUnit = "(fps)";
+    config.yScaleDivisor = 1;
+    config.valueSuffix = " fps";
+    config.showValues = false;
+    config.pointSize = 2;
+    config.xPoints = THROUGHPUT_HISTORY;
+    config.rightAlign = true;
+    config.xTickCount = 7;
+    config.xTickStart = -THROUGHPUT_HISTORY;
+    config.xTickStep = THROUGHPUT_HISTORY / 6;
+    config.windowName = "Live Throughput";
+    config.outputName = "throughput_live.png";
+    throughputChart.setConfig(config);
+}
+
 WebcamOperations::~WebcamOperations() {                                                                                             // Destructor
     closeWebcam();
 }
@@ -13,27 +70,102 @@ void WebcamOperations::openWebcam() {
         cerr << "Error: Unable to access the webcam." << endl;
         return;
     }
+    pinIoThread();
     cout << "" << endl;
     cout << "Webcam opened successfully. Press 'g' for greyscale feed, 'q' to quit." << endl;
     cout << "Press 't' to test all filters, 'x' to test some filters with cut lines." << endl;
     cout << "Press 'c' for canny edge detection, 'k' for sobel edge detection." << endl;
     cout << "Press 'l' for fourier transform, 'm' for resize, 'n' for rotate." << endl;
-    cout << "Press 'i' for gaussian blur, press 'o' for median filter, 'p' for denoising filter." << endl;
+    cout << "Press 'i' for gaussian blur, press 'o' for median filter, 'p' for denoising filter, 'u' for guided filter." << endl;
+    cout << "Press 'f' to toggle the metrics overlay, 'j' for the live throughput chart." << endl;
+    cout << "Press 'w' to start or stop recording raw frames for replay." << endl;
     cout << "" << endl;
 
     namedWindow(windowName, WINDOW_NORMAL);
     resizeWindow(windowName, 400, 300);
 
+    MetricsRegistry& registry = MetricsRegistry::instance();
+    Counter& framesCounter = registry.counter("cpmulti_frames_captured_total", "Frames read from the webcam");
+    Counter& droppedCounter = registry.counter("cpmulti_frames_dropped_total", "Camera frames missed because the loop ran late");
+    LatencyHistogram& frameTime = registry.histogram("cpmulti_frame_time_us", "Capture to display loop time in microseconds");
+    Gauge& fpsGauge = registry.gauge("cpmulti_fps", "Frames per second over the last second");
+    MetricsExporter exporter = startExporter();
+
+    // Loop iterations longer than the camera's frame interval mean frames were missed
+    double nominalFps = cap.get(CAP_PROP_FPS);
+    double frameIntervalUs = 1e6 / (nominalFps > 0 ? nominalFps : 30.0);
+
+    auto lastFrame = chrono::steady_clock::now();
+    auto windowStart = lastFrame;
+    int windowFrames = 0;
+
+    TRACE_THREAD_NAME("capture/display");
     while(true) {
-        cap >> frame;
+        {
+            TRACE_SCOPE("capture", "io");
+            cap >> frame;
+        }
         if(frame.empty()) {
             cerr << "Error: No frame available from the webcam." << endl;
             break;
         }
 
-        imshow(windowName, frame);
+        auto now = chrono::steady_clock::now();
+        double elapsedUs = chrono::duration<double, micro>(now - lastFrame).count();
+        lastFrame = now;
+        framesCounter.increment();
+        frameTime.record(elapsedUs);
+        droppedCounter.increment(static_cast<uint64_t>(max(0.0, round(elapsedUs / frameIntervalUs) - 1)));
+        if (recorder.isOpen()) {
+            recorder.append(frame);     // A copy; the disk write happens on the recorder's thread
+        }
 
-        char key = waitKey(10);
+        windowFrames++;
+        double windowSeconds = chrono::duration<double>(now - windowStart).count();
+        if (windowSeconds >= 1.0) {
+            fpsGauge.set(windowFrames / windowSeconds);
+            windowFrames = 0;
+            windowStart = now;
+
+            fpsHistory.push_back(fpsGauge.get());
+            if (static_cast<int>(fpsHistory.size()) > THROUGHPUT_HISTORY) {
+                fpsHistory.pop_front();
+            }
+            if (showThroughputChart) {
+                throughputChart.plotPerformance({{"fps", vector<double>(fpsHistory.begin(), fpsHistory.end())}});
+            }
+        }
+
+        char key;
+        {
+            TRACE_SCOPE("display", "display");
+            if (showMetricsOverlay) {
+                Mat display = frame.clone();
+                drawMetricsOverlay(display, fpsGauge.get(), frameTime, droppedCounter.get());
+                imshow(windowName, display);
+            } else {
+                imshow(windowName, frame);
+            }
+            // Plots are rendered off this thread; only finished images are shown here
+            keyHandler.refreshPlots();
+            throughputChart.showLatestPlot();
+            key = waitKey(10);
+        }
+        if (key == 'f') {
+            showMetricsOverlay = !showMetricsOverlay;
+            continue;
+        }
+        if (key == 'w') {
+            toggleRecording(frame);
+            continue;
+        }
+        if (key == 'j') {
+            showThroughputChart = !showThroughputChart;
+            if (!showThroughputChart) {
+                destroyWindow(throughputChart.getConfig().windowName);
+            }
+            continue;
+        }
         if (!keyHandler.handleKeyPress(key, frame)) {
             break;
         }
@@ -41,6 +173,278 @@ void WebcamOperations::openWebcam() {
     closeWebcam();
 }
 
+void WebcamOperations::openMultiStream(const vector<string>& sources, const string& filterName, bool incremental, bool native) {    // Process several feeds on the shared processor
+    pinIoThread();
+    MultiStreamProcessor streamProcessor(imageProcessor);
+
+    for (const auto& source : sources) {
+        StreamConfig config;
+        config.source = source;
+        config.filterName = filterName;
+        config.name = "Stream " + source;
+        config.incremental = incremental;
+        config.nativeFormat = native;
+        streamProcessor.addStream(config);
+    }
+    if (streamProcessor.getStreamCount() == 0) {
+        cerr << "Error: No stream could be opened." << endl;
+        return;
+    }
+
+    cout << "Processing " << streamProcessor.getStreamCount() << " streams with '" << filterName
+         << "' on a budget of " << imageProcessor.getThreadBudget() << " threads. Press 'q' to quit, 'f' to toggle the metrics overlay." << endl;
+
+    for (size_t i = 0; i < streamProcessor.getStreamCount(); i++) {
+        namedWindow(streamProcessor.getConfig(static_cast<int>(i)).name, WINDOW_NORMAL);
+        resizeWindow(streamProcessor.getConfig(static_cast<int>(i)).name, 400, 300);
+    }
+    MetricsExporter exporter = startExporter();
+    streamProcessor.start();
+
+    // Processed frames per second of each stream, refreshed once a second
+    vector<double> streamFps(streamProcessor.getStreamCount(), 0.0);
+    vector<uint64_t> windowProcessed(streamProcessor.getStreamCount(), 0);
+    auto windowStart = chrono::steady_clock::now();
+
+    // HighGUI must be driven from this thread, so outputs are polled and shown here
+    TRACE_THREAD_NAME("display");
+    Mat output;
+    while (true) {
+        TRACE_SCOPE("display", "display");
+
+        double windowSeconds = chrono::duration<double>(chrono::steady_clock::now() - windowStart).count();
+        bool windowDone = windowSeconds >= 1.0;
+
+        for (size_t i = 0; i < streamProcessor.getStreamCount(); i++) {
+            int id = static_cast<int>(i);
+            StreamStats stats = streamProcessor.getStats(id);
+            if (windowDone) {
+                streamFps[i] = (stats.framesProcessed - windowProcessed[i]) / windowSeconds;
+                windowProcessed[i] = stats.framesProcessed;
+            }
+
+            if (streamProcessor.getLatestOutput(id, output)) {
+                string name = streamProcessor.getConfig(id).name;
+                if (showMetricsOverlay) {
+                    output = output.clone();
+                    drawMetricsOverlay(output, streamFps[i],
+                                       MetricsRegistry::instance().histogram(MetricsRegistry::labelled("cpmulti_stream_latency_us", "stream", name)),
+                                       stats.framesDropped);
+                }
+                imshow(name, output);
+            }
+        }
+        if (windowDone) {
+            windowStart = chrono::steady_clock::now();
+        }
+
+        char key = waitKey(10);
+        if (key == 'q') break;
+        if (key == 'f') showMetricsOverlay = !showMetricsOverlay;
+    }
+    streamProcessor.stop();
+
+#ifdef CPMULTI_TRACING
+    TraceRecorder::instance().writeChromeTrace(resourcesPath + "/trace.json");
+#endif
+
+    for (size_t i = 0; i < streamProcessor.getStreamCount(); i++) {
+        StreamStats stats = streamProcessor.getStats(static_cast<int>(i));
+        cout << streamProcessor.getConfig(static_cast<int>(i)).name << ": "
+             << stats.framesProcessed << " processed, " << stats.framesDropped << " dropped of "
+             << stats.framesCaptured << " captured, " << stats.framesDegraded << " degraded, average latency "
+             << stats.averageLatencyMs << " ms";
+        if (streamProcessor.getConfig(static_cast<int>(i)).incremental) {
+            cout << ", " << fixed << setprecision(1) << stats.averageFilteredFraction * 100 << defaultfloat << "% of each frame re-filtered";
+        }
+        cout << endl;
+        streamProcessor.getGovernor(static_cast<int>(i)).printSummary();
+    }
+    const ResultCache& cache = imageProcessor.getResultCache();
+    if (cache.isEnabled()) {
+        cout << "Result cache: " << cache.hits() << " hits, " << cache.misses() << " misses, "
+             << cache.sizeBytes() / (1 << 20) << " MB held." << endl;
+    }
+    destroyAllWindows();
+}
+
+MetricsExporter WebcamOperations::startExporter() {                                                                                 // Write live metrics next to the other resources
+    if (!filesystem::exists(resourcesPath)) {
+        filesystem::create_directories(resourcesPath);
+    }
+    cout << "Live metrics are written to " << resourcesPath << "/metrics.prom." << endl;
+    return MetricsExporter(resourcesPath + "/metrics.prom");
+}
+
+void WebcamOperations::drawMetricsOverlay(Mat& image, double fps, const LatencyHistogram& latency, uint64_t droppedFrames) const {  // Draw fps, latency percentiles and drops in the corner
+    char lines[3][64];
+    snprintf(lines[0], sizeof(lines[0]), "FPS: %.1f", fps);
+    snprintf(lines[1], sizeof(lines[1]), "p50 / p99: %.1f / %.1f ms", latency.percentile(50) / 1000.0, latency.percentile(99) / 1000.0);
+    snprintf(lines[2], sizeof(lines[2]), "Dropped: %llu", static_cast<unsigned long long>(droppedFrames));
+
+    // Darken the box behind the text so it stays readable on bright frames
+    Rect box = Rect(0, 0, 260, 80) & Rect(0, 0, image.cols, image.rows);
+    Mat background = image(box);
+    background.convertTo(background, -1, 0.4);
+
+    for (int i = 0; i < 3; i++) {
+        putText(image, lines[i], Point(10, 22 + i * 22), FONT_HERSHEY_SIMPLEX, 0.55, Scalar(255, 255, 255), 1, LINE_AA);
+    }
+}
+
+void WebcamOperations::runResolutionSweep(bool quick) {                                                                              // Benchmark without a camera
+    if (!filesystem::exists(resourcesPath)) {
+        filesystem::create_directories(resourcesPath);
+    }
+    keyHandler.handleResolutionSweep(quick);
+}
+
+void WebcamOperations::runReplay(const string& source, const string& filterName, FrameParallelism mode, const string& outputPath) {  // Filter a recording as fast as it can be read
+    if (!imageProcessor.hasFilter(filterName)) {
+        cerr << "Error: Unknown filter name '" << filterName << "'" << endl;
+        return;
+    }
+    NativeCapture capture;
+    if (!capture.open(source, false)) {
+        cerr << "Error: Unable to open replay source '" << source << "'" << endl;
+        return;
+    }
+
+    FramePipelineOptions options;
+    options.mode = mode;
+    // Written outputs need 8-bit pixels, so a filter with an 8-bit variant runs that one instead
+    FramePipeline pipeline(imageProcessor, outputPath.empty() ? filterName : imageProcessor.getSavableFilter(filterName), options);
+    VideoWriter writer;
+    bool writeOutput = !outputPath.empty();
+
+    // Outputs are released in input order, so each one can be written as soon as it is taken
+    auto drain = [&](bool waitForAll) {
+        Mat output;
+        while (waitForAll ? pipeline.pop(output) : pipeline.tryPop(output)) {
+            if (!writeOutput || output.empty()) continue;
+            if (!writer.isOpened()) {
+                double fps = (capture.fps() > 0) ? capture.fps() : 30.0;
+                if (!writer.open(outputPath, VideoWriter::fourcc('M', 'J', 'P', 'G'), fps, output.size(), output.channels() == 3)) {
+                    cerr << "Error: Unable to open output video '" << outputPath << "'" << endl;
+                    writeOutput = false;
+                    continue;
+                }
+            }
+            writer.write(output);
+        }
+    };
+
+    cout << "Replaying '" << source << "' through '" << filterName << "' on a budget of " << imageProcessor.getThreadBudget() << " threads." << endl;
+    Mat frame;
+    while (true) {
+        {
+            TRACE_SCOPE("capture", "io");
+            if (!capture.read(frame) || frame.empty()) break;
+        }
+        // Raw recordings come in their native layout; the pipeline takes BGR
+        if (capture.format() != PixelFormat::BGR) {
+            frame = FrameContext(frame, capture.format()).frame();
+        }
+        pipeline.push(frame);
+        frame = Mat();      // The pushed frame stays shared with its filter until it is emitted
+        drain(false);
+    }
+    pipeline.finish();
+    drain(true);
+    writer.release();
+
+    pipeline.printSummary();
+#ifdef CPMULTI_TRACING
+    TraceRecorder::instance().writeChromeTrace(resourcesPath + "/trace.json");
+#endif
+}
+
+void WebcamOperations::runBatch(const string& source, const vector<string>& chain, const string& outputDir) {                       // Filter a folder or recording in batches
+    for (const auto& filterName : chain) {
+        if (!imageProcessor.hasFilter(filterName)) {
+            cerr << "Error: Unknown filter name '" << filterName << "'" << endl;
+            return;
+        }
+    }
+
+    // A folder is read as its images in name order; anything else is opened as a video or recording
+    vector<string> imagePaths;
+    NativeCapture capture;
+    bool folder = filesystem::is_directory(source);
+    if (folder) {
+        for (const auto& entry : filesystem::directory_iterator(source)) {
+            if (entry.is_regular_file()) imagePaths.push_back(entry.path().string());
+        }
+        sort(imagePaths.begin(), imagePaths.end());
+    } else if (!capture.open(source, false)) {
+        cerr << "Error: Unable to open batch source '" << source << "'" << endl;
+        return;
+    }
+    if (!outputDir.empty()) {
+        filesystem::create_directories(outputDir);
+    }
+
+    // Saved outputs need 8-bit pixels, so a last filter with an 8-bit variant runs that one instead
+    vector<string> filters = chain;
+    if (!outputDir.empty() && !filters.empty()) {
+        filters.back() = imageProcessor.getSavableFilter(filters.back());
+    }
+
+    static const size_t BATCH_FRAMES = 32;
+    ExecutionOptions options;
+    options.numThreads = imageProcessor.getThreadBudget();
+    size_t nextImage = 0;
+    size_t framesDone = 0;
+    double totalUs = 0;
+    double megapixels = 0;
+    vector<Mat> frames;
+    vector<string> names;
+
+    cout << "Filtering '" << source << "' in batches of " << BATCH_FRAMES << " frames on a budget of " << imageProcessor.getThreadBudget() << " threads." << endl;
+    while (true) {
+        frames.clear();
+        names.clear();
+        while (frames.size() < BATCH_FRAMES) {
+            TRACE_SCOPE("capture", "io");
+            Mat frame;
+            if (folder) {
+                if (nextImage >= imagePaths.size()) break;
+                frame = imread(imagePaths[nextImage]);
+                names.push_back(filesystem::path(imagePaths[nextImage++]).stem().string());
+                if (frame.empty()) cerr << "Warning: Skipping '" << imagePaths[nextImage - 1] << "', which is not an image." << endl;
+            } else {
+                if (!capture.read(frame) || frame.empty()) break;
+                if (capture.format() != PixelFormat::BGR) {
+                    frame = FrameContext(frame, capture.format()).frame();
+                }
+                char name[32];
+                snprintf(name, sizeof(name), "frame_%06zu", framesDone + frames.size());
+                names.push_back(name);
+            }
+            frames.push_back(frame);
+        }
+        if (frames.empty()) break;
+
+        BatchResult result = imageProcessor.applyChainBatch(filters, frames, options);
+        totalUs += result.totalUs;
+        for (const Mat& frame : frames) megapixels += frame.total() / 1e6;
+        framesDone += frames.size();
+        for (size_t i = 0; i < result.frames.size() && !outputDir.empty(); i++) {
+            Mat output = result.frames[i].output;
+            if (output.empty()) continue;
+            imwrite(outputDir + "/" + names[i] + ".png", output);
+        }
+    }
+
+    if (totalUs > 0) {
+        cout << "Batch: " << framesDone << " frames in " << fixed << setprecision(1) << totalUs / 1000.0 << " ms, "
+             << framesDone * 1e6 / totalUs << " fps, " << setprecision(2) << megapixels * 1e6 / totalUs << " MP/s." << defaultfloat << endl;
+    }
+#ifdef CPMULTI_TRACING
+    TraceRecorder::instance().writeChromeTrace(resourcesPath + "/trace.json");
+#endif
+}
+
 void WebcamOperations::takeSnapShot(const cv::Mat& inputFrame, const std::string& filename) {                                       // Take a snapshot of the input frame
     if (inputFrame.empty()) {
         cerr << "Error: No frame available to take a snapshot." << endl;
@@ -81,14 +485,22 @@ void WebcamOperations::saveSnapShot() {
 }
 
 void WebcamOperations::closeWebcam() {                                                                                                  // Close the Webcam
+    if (recorder.isOpen()) {
+        toggleRecording(Mat());
+    }
     if (cap.isOpened()) {
         cap.release();
         destroyAllWindows();
         cout << "Webcam closed successfully." << endl;
+
+#ifdef CPMULTI_TRACING
+        TraceRecorder::instance().writeChromeTrace(resourcesPath + "/trace.json");
+#endif
     }
 }
 
 void WebcamOperations::setResourcesPath(const string& path) {                                                                           // Set the resources path
     resourcesPath = path;
+    throughputChart.setResourcePath(path);
     cout << "Resources path set to: " << resourcesPath << endl;
 }
\ No newline at end of file
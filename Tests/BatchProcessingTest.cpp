@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "Headers/MultiThreadImageProcessor.hpp"
+#include "Headers/SyntheticContent.hpp"
+
+static vector<Mat> batchFrames() {
+    vector<Mat> frames;
+    ContentClass contents[] = {ContentClass::Natural, ContentClass::HighEdge, ContentClass::Noise};
+    for (int i = 0; i < 9; i++) {
+        frames.push_back(SyntheticContent::generate(Size(320, 240), contents[i % 3]));
+    }
+    frames.push_back(SyntheticContent::generate(Size(161, 97), ContentClass::Natural));   // Sizes may differ within a batch
+    return frames;
+}
+
+static ExecutionOptions sequentialOptions() {
+    ExecutionOptions options;
+    options.numThreads = 1;
+    options.policy = ParallelPolicy::Sequential;
+    return options;
+}
+
+// Whatever the split, each output equals filtering its frame on its own
+TEST(BatchProcessingTest, MatchesOneCallPerFrame) {
+    MultiThreadImageProcessor processor(1, 4);
+    vector<Mat> frames = batchFrames();
+
+    for (ParallelPolicy policy : {ParallelPolicy::Sequential, ParallelPolicy::Strips, ParallelPolicy::Tiles}) {
+        ExecutionOptions options;
+        options.numThreads = 4;
+        options.policy = policy;
+        for (const char* filterName : {"gaussian", "median", "rotate"}) {
+            BatchResult result = processor.applyFilterBatch(filterName, frames, options);
+            ASSERT_EQ(result.frames.size(), frames.size());
+            for (size_t i = 0; i < frames.size(); i++) {
+                Mat expected = processor.applyFilter(filterName, frames[i], sequentialOptions());
+                ASSERT_EQ(result.frames[i].output.size(), expected.size()) << filterName << " frame " << i;
+                EXPECT_EQ(norm(result.frames[i].output, expected, NORM_INF), 0) << filterName << " frame " << i;
+                EXPECT_GE(result.frames[i].startUs, 0);
+                EXPECT_LE(result.frames[i].startUs + result.frames[i].durationUs, result.totalUs);
+            }
+            EXPECT_GT(result.framesPerSecond, 0);
+            EXPECT_GT(result.megapixelsPerSecond, 0);
+        }
+    }
+}
+
+// A chain is the same as applying its filters one after another
+TEST(BatchProcessingTest, ChainsMatchFiltersAppliedInTurn) {
+    MultiThreadImageProcessor processor(1, 4);
+    vector<Mat> frames = batchFrames();
+    ExecutionOptions options;
+    options.numThreads = 4;
+
+    // gaussian and median stitch strips together; fourier needs whole frames
+    for (const vector<string>& chain : vector<vector<string>>{{"gaussian", "median"}, {"gaussian", "fourier"}}) {
+        BatchResult result = processor.applyChainBatch(chain, frames, options);
+        ASSERT_EQ(result.frames.size(), frames.size());
+        for (size_t i = 0; i < frames.size(); i++) {
+            Mat expected = frames[i];
+            for (const auto& filterName : chain) {
+                expected = processor.applyFilter(filterName, expected, sequentialOptions());
+            }
+            ASSERT_EQ(result.frames[i].output.size(), expected.size()) << chain.back() << " frame " << i;
+            EXPECT_LE(norm(result.frames[i].output, expected, NORM_INF), 1e-4) << chain.back() << " frame " << i;
+        }
+    }
+}
+
+TEST(BatchProcessingTest, SkipsEmptyFramesAndRejectsUnknownFilters) {
+    MultiThreadImageProcessor processor(1, 4);
+    vector<Mat> frames = {SyntheticContent::generate(Size(64, 48), ContentClass::Natural), Mat()};
+    ExecutionOptions options;
+    options.numThreads = 2;
+
+    BatchResult result = processor.applyFilterBatch("gaussian", frames, options);
+    ASSERT_EQ(result.frames.size(), 2u);
+    EXPECT_FALSE(result.frames[0].output.empty());
+    EXPECT_TRUE(result.frames[1].output.empty());
+
+    BatchResult unknown = processor.applyChainBatch({"gaussian", "no-such-filter"}, frames, options);
+    ASSERT_EQ(unknown.frames.size(), 2u);
+    EXPECT_TRUE(unknown.frames[0].output.empty());
+    EXPECT_TRUE(processor.applyChainBatch({}, frames, options).frames[0].output.empty());
+}
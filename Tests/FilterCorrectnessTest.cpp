@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include "Headers/MultiThreadImageProcessor.hpp"
+#include "Headers/SyntheticContent.hpp"
+
+// Each parallel path must reproduce the filter applied to the whole frame, which is the
+// plain OpenCV call. Strips and tiles are stitched from halo-padded pieces, so any
+// error in the halo or the stitching shows up as a seam.
+
+struct CorrectnessCase {
+    string filterName;
+    ParallelPolicy policy;
+    int threads;
+    ContentClass content;
+};
+
+static string caseName(const testing::TestParamInfo<CorrectnessCase>& info) {
+    const CorrectnessCase& c = info.param;
+    string policy = (c.policy == ParallelPolicy::Strips) ? "Strips" : (c.policy == ParallelPolicy::Tiles) ? "Tiles" : "Sequential";
+    return c.filterName + "_" + policy + "_" + to_string(c.threads) + "_" + SyntheticContent::name(c.content);
+}
+
+// Share of pixels that may differ. Canny's hysteresis follows edges across the whole
+// image, so a chain that leaves a strip through its halo can be cut short there.
+static double allowedMismatch(const string& filterName) {
+    return filterName == "canny" ? 0.005 : 0.0;
+}
+
+class FilterCorrectnessTest : public testing::TestWithParam<CorrectnessCase> {
+protected:
+    static MultiThreadImageProcessor& processor() {
+        static MultiThreadImageProcessor instance(1, 8);
+        return instance;
+    }
+};
+
+TEST_P(FilterCorrectnessTest, MatchesWholeFrameReference) {
+    const CorrectnessCase& c = GetParam();
+    Mat input = SyntheticContent::generate(Size(643, 487), c.content);  // Odd size so strips and tiles are uneven
+
+    ExecutionOptions reference;
+    reference.numThreads = 1;
+    reference.policy = ParallelPolicy::Sequential;
+    Mat expected = processor().applyFilter(c.filterName, input, reference);
+
+    ExecutionOptions options;
+    options.numThreads = c.threads;
+    options.policy = c.policy;
+    options.tileSize = 96;
+    Mat actual = processor().applyFilter(c.filterName, input, options);
+
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(expected.size(), actual.size());
+    ASSERT_EQ(expected.type(), actual.type());
+
+    Mat difference;
+    absdiff(expected, actual, difference);
+    Mat differing;
+    compare(difference.reshape(1, difference.rows), 0, differing, CMP_NE);
+    double mismatch = static_cast<double>(countNonZero(differing)) / differing.total();
+    EXPECT_LE(mismatch, allowedMismatch(c.filterName)) << "max difference " << norm(difference, NORM_INF);
+}
+
+static vector<CorrectnessCase> allCases() {
+    vector<CorrectnessCase> cases;
+    for (const char* filterName : {"greyscale", "gaussian", "median", "denoising", "guided", "canny", "sobel", "fourier", "fourier8", "resize", "rotate"}) {
+        for (ParallelPolicy policy : {ParallelPolicy::Strips, ParallelPolicy::Tiles}) {
+            for (int threads : {2, 3, 8}) {
+                for (ContentClass content : {ContentClass::Natural, ContentClass::HighEdge}) {
+                    cases.push_back({filterName, policy, threads, content});
+                }
+            }
+        }
+    }
+    return cases;
+}
+
+INSTANTIATE_TEST_SUITE_P(AllFilters, FilterCorrectnessTest, testing::ValuesIn(allCases()), caseName);
+
+TEST(FilterCapabilitiesTest, HaloCoversKernelRadius) {
+    MultiThreadImageProcessor processor(1, 2);
+    EXPECT_GE(processor.getCapabilities("gaussian").halo, 7);   // 15x15 kernel
+    EXPECT_GE(processor.getCapabilities("median").halo, 4);     // 9x9 window
+    EXPECT_GE(processor.getCapabilities("sobel").halo, 1);      // 3x3 kernel
+    EXPECT_FALSE(processor.getCapabilities("fourier").stripParallel);
+}
+
+// Median keeps its 9x9 minimum; only the governor's reduced level asks for a smaller window
+TEST(FilterCapabilitiesTest, MedianKernelMinimum) {
+    EXPECT_EQ(MedianFilter().getKernelSize(), 9);
+    EXPECT_EQ(MedianFilter(5).getKernelSize(), 9);
+    EXPECT_EQ(MedianFilter(11).getKernelSize(), 11);
+    EXPECT_EQ(MedianFilter(5, 5).getKernelSize(), 5);
+    EXPECT_EQ(MedianFilter(4, 3).getKernelSize(), 5);
+}
+
+// The 8-bit spectrum is the centred log-magnitude with zero as black and the DC term as white
+TEST(FourierSpectrumTest, BytesMatchExactLogMagnitude) {
+    Mat input = SyntheticContent::generate(Size(321, 243), ContentClass::Natural);
+    Mat spectrum = FourierFilter(SpectrumOutput::Bytes).applyFilter(input);
+    ASSERT_EQ(spectrum.type(), CV_8U);
+    ASSERT_EQ(spectrum.size(), Size(320, 242));     // Odd dimensions are cropped, as in the float spectrum
+
+    Mat grey, complexI;
+    cvtColor(input, grey, COLOR_BGR2GRAY);
+    grey.convertTo(grey, CV_32F);
+    dft(grey, complexI, DFT_COMPLEX_OUTPUT);
+    double scale = 255.0 / log2(1.0 + complexI.at<Vec2f>(0, 0)[0]);
+    int cx = spectrum.cols / 2;
+    int cy = spectrum.rows / 2;
+    int worst = 0;
+    for (int y = 0; y < spectrum.rows; y++) {
+        for (int x = 0; x < spectrum.cols; x++) {
+            Vec2f z = complexI.at<Vec2f>((y + cy) % spectrum.rows, (x + cx) % spectrum.cols);
+            int expected = static_cast<int>(round(log2(1.0 + hypot(double(z[0]), double(z[1]))) * scale));
+            worst = max(worst, abs(expected - spectrum.at<uint8_t>(y, x)));
+        }
+    }
+    EXPECT_LE(worst, 1);
+    EXPECT_EQ(spectrum.at<uint8_t>(cy, cx), 255);   // DC at the centre
+
+    // Same layout as the float spectrum, just not min-max stretched
+    Mat floatSpectrum = FourierFilter().applyFilter(input);
+    EXPECT_EQ(floatSpectrum.size(), spectrum.size());
+    Point brightest;
+    minMaxLoc(floatSpectrum, nullptr, nullptr, nullptr, &brightest);
+    EXPECT_EQ(brightest, Point(cx, cy));
+}
+
+// Every filter the benchmarks save has an 8-bit form to write to disk
+TEST(FilterRegistryTest, SavableFiltersProduceEightBitImages) {
+    MultiThreadImageProcessor processor(1, 2);
+    Mat input = SyntheticContent::generate(Size(64, 48), ContentClass::Natural);
+    EXPECT_EQ(processor.getSavableFilter("fourier"), "fourier8");
+    EXPECT_EQ(processor.getSavableFilter("gaussian"), "gaussian");
+    for (const string& filterName : processor.getFilterNames()) {
+        Mat output = processor.applyFilter(processor.getSavableFilter(filterName), input);
+        ASSERT_FALSE(output.empty()) << filterName;
+        EXPECT_EQ(output.depth(), CV_8U) << filterName;
+    }
+}
+
+TEST(FilterRegistryTest, UnknownFilterReturnsEmpty) {
+    MultiThreadImageProcessor processor(1, 2);
+    Mat input = SyntheticContent::generate(Size(64, 48), ContentClass::Noise);
+    EXPECT_TRUE(processor.applyFilter("does-not-exist", input).empty());
+}
+
+TEST(FilterAffinityTest, PinnedWorkersWithLocalCopiesMatchReference) {
+    AffinityOptions affinity;
+    affinity.policy = AffinityPolicy::Scatter;
+    affinity.reservedCores = 0;
+    MultiThreadImageProcessor processor(1, 4, affinity);
+    Mat input = SyntheticContent::generate(Size(643, 487), ContentClass::Natural);
+
+    ExecutionOptions reference;
+    reference.policy = ParallelPolicy::Sequential;
+    Mat expected = processor.applyFilter("median", input, reference);
+
+    ExecutionOptions options;
+    options.numThreads = 4;
+    options.localCopy = true;
+    Mat actual = processor.applyFilter("median", input, options);
+    ASSERT_EQ(expected.size(), actual.size());
+    EXPECT_EQ(norm(expected, actual, NORM_INF), 0);
+}
+
+// Patching re-filtered blocks into the cached output must give the same frame as filtering it whole
+class IncrementalProcessingTest : public testing::TestWithParam<const char*> {};
+
+TEST_P(IncrementalProcessingTest, PatchedOutputMatchesFullFrame) {
+    MultiThreadImageProcessor processor(1, 4);
+    string filterName = GetParam();
+    ExecutionOptions options;
+    options.numThreads = 4;
+    ExecutionOptions reference;
+    reference.policy = ParallelPolicy::Sequential;
+
+    Mat frame = SyntheticContent::generate(Size(643, 487), ContentClass::Natural);
+    IncrementalState state;
+    IncrementalStats stats;
+    processor.applyFilterIncremental(filterName, frame, options, state, IncrementalOptions(), &stats);
+    EXPECT_TRUE(stats.fullRefresh);
+
+    // Nothing changed: nothing is filtered
+    Mat output = processor.applyFilterIncremental(filterName, frame, options, state, IncrementalOptions(), &stats).first;
+    EXPECT_FALSE(stats.fullRefresh);
+    EXPECT_EQ(stats.dirtyBlocks, 0);
+    EXPECT_EQ(norm(processor.applyFilter(filterName, frame, reference), output, NORM_INF), 0);
+
+    // A small object appears across a block corner
+    rectangle(frame, Rect(120, 100, 20, 40), Scalar(255, 0, 0), FILLED);
+    output = processor.applyFilterIncremental(filterName, frame, options, state, IncrementalOptions(), &stats).first;
+    EXPECT_FALSE(stats.fullRefresh);
+    EXPECT_GT(stats.dirtyBlocks, 0);
+    EXPECT_LT(stats.filteredFraction, 0.2);
+    EXPECT_EQ(norm(processor.applyFilter(filterName, frame, reference), output, NORM_INF), 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(StitchableFilters, IncrementalProcessingTest, testing::Values("gaussian", "median", "sobel"));
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include "Headers/FrameContext.hpp"
+#include "Headers/MultiThreadImageProcessor.hpp"
+#include "Headers/SyntheticContent.hpp"
+#include <thread>
+
+// Planes derived in bands on the pool must equal the plain OpenCV call on the whole frame
+TEST(FrameContextTest, BandedPlanesMatchWholeFrameOperations) {
+    MultiThreadImageProcessor processor(1, 4);
+    Mat frame = SyntheticContent::generate(Size(643, 487), ContentClass::Natural);
+    FrameContext context(frame, &processor.getThreadPool(), 4);
+
+    Mat grey, gradientX, gradientY;
+    cvtColor(frame, grey, COLOR_BGR2GRAY);
+    Sobel(grey, gradientX, CV_16S, 1, 0, 3, 1, 0, BORDER_REPLICATE);
+    Sobel(grey, gradientY, CV_16S, 0, 1, 3, 1, 0, BORDER_REPLICATE);
+
+    EXPECT_EQ(norm(context.grey(), grey, NORM_INF), 0);
+    EXPECT_EQ(norm(context.gradientX(), gradientX, NORM_INF), 0);
+    EXPECT_EQ(norm(context.gradientY(), gradientY, NORM_INF), 0);
+}
+
+TEST(FrameContextTest, EachPlaneIsComputedOnceUnderConcurrentUse) {
+    Mat frame = SyntheticContent::generate(Size(320, 240), ContentClass::HighEdge);
+    FrameContext context(frame);
+
+    vector<const uchar*> seen(8);
+    vector<thread> threads;
+    for (size_t i = 0; i < seen.size(); i++) {
+        threads.emplace_back([&, i]() { seen[i] = context.gradientX().data; });
+    }
+    for (auto& t : threads) t.join();
+
+    for (const uchar* data : seen) {
+        EXPECT_EQ(data, seen[0]);
+    }
+    EXPECT_EQ(context.gradientX().data, seen[0]);
+}
+
+// Filters reading the shared planes give the same result as filtering the frame itself
+class FrameContextFilterTest : public testing::TestWithParam<tuple<const char*, int>> {};
+
+TEST_P(FrameContextFilterTest, SharedPlanesMatchDirectFiltering) {
+    MultiThreadImageProcessor processor(1, 8);
+    string filterName = get<0>(GetParam());
+    ExecutionOptions options;
+    options.numThreads = get<1>(GetParam());
+    options.policy = options.numThreads == 1 ? ParallelPolicy::Sequential : ParallelPolicy::Strips;
+
+    Mat frame = SyntheticContent::generate(Size(643, 487), ContentClass::Natural);
+    FrameContext context(frame, &processor.getThreadPool(), options.numThreads);
+    Mat expected = processor.applyFilter(filterName, frame, options);
+    Mat actual = processor.applyFilter(filterName, context, options);
+
+    ASSERT_EQ(expected.size(), actual.size());
+    ASSERT_EQ(expected.type(), actual.type());
+    Mat differing;
+    compare(expected, actual, differing, CMP_NE);
+    // Canny strips see real neighbours instead of replicated borders at their edges, which may move a few hysteresis decisions
+    double allowed = filterName == "canny" ? 0.005 : 0.0;
+    EXPECT_LE(static_cast<double>(countNonZero(differing)) / differing.total(), allowed);
+
+    // The result is the caller's own, not a view of the shared plane
+    actual.setTo(Scalar(0));
+    EXPECT_GT(countNonZero(context.grey()), 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(ContextFilters, FrameContextFilterTest,
+                         testing::Combine(testing::Values("greyscale", "canny", "sobel"), testing::Values(1, 3)));
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "Headers/FramePipeline.hpp"
+#include "Headers/SyntheticContent.hpp"
+
+static vector<Mat> testFrames(int count, const Size& size) {
+    vector<Mat> frames;
+    ContentClass contents[] = {ContentClass::Natural, ContentClass::HighEdge, ContentClass::Noise};
+    for (int i = 0; i < count; i++) {
+        Mat frame = SyntheticContent::generate(size, contents[i % 3]);
+        frame.row(i % size.height).setTo(Scalar::all(i));     // Tells otherwise identical frames apart
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+class FramePipelineTest : public testing::TestWithParam<FrameParallelism> {};
+
+// Whatever the mode, every frame comes back once, in input order, equal to filtering it alone
+TEST_P(FramePipelineTest, EmitsEveryFrameInOrder) {
+    MultiThreadImageProcessor processor(1, 4);
+    vector<Mat> frames = testFrames(12, Size(320, 240));
+    FramePipelineOptions options;
+    options.mode = GetParam();
+
+    for (const char* filterName : {"median", "rotate"}) {
+        FramePipeline pipeline(processor, filterName, options);
+        vector<Mat> outputs;
+        Mat output;
+        for (const Mat& frame : frames) {
+            pipeline.push(frame);
+            while (pipeline.tryPop(output)) outputs.push_back(output);
+        }
+        pipeline.finish();
+        while (pipeline.pop(output)) outputs.push_back(output);
+
+        ASSERT_EQ(outputs.size(), frames.size()) << filterName;
+        ExecutionOptions reference;
+        reference.numThreads = 1;
+        reference.policy = ParallelPolicy::Sequential;
+        for (size_t i = 0; i < frames.size(); i++) {
+            EXPECT_EQ(norm(outputs[i], processor.applyFilter(filterName, frames[i], reference), NORM_INF), 0) << filterName << " frame " << i;
+        }
+
+        FramePipelineStats stats = pipeline.getStats();
+        EXPECT_EQ(stats.framesPushed, frames.size());
+        EXPECT_EQ(stats.framesEmitted, frames.size());
+        EXPECT_GE(stats.averageLatencyMs, 0);
+        EXPECT_LE(static_cast<int>(stats.maxReorderDepth), pipeline.getPlan().framesInFlight);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllModes, FramePipelineTest,
+                         testing::Values(FrameParallelism::Auto, FrameParallelism::IntraFrame, FrameParallelism::InterFrame, FrameParallelism::Hybrid),
+                         [](const testing::TestParamInfo<FrameParallelism>& info) {
+                             string name = FramePipeline::modeName(info.param);
+                             name.erase(remove(name.begin(), name.end(), '-'), name.end());
+                             return name;
+                         });
+
+TEST(FramePipelinePlanTest, SplitsOnlyFramesThatRepayIt) {
+    FilterCapabilities stitchable{true, true, 8};
+    FilterCapabilities wholeFrame{false, true, 0};
+
+    // Cheap frames and whole-frame filters run one frame per thread
+    FramePipelinePlan cheap = FramePipeline::choosePlan(stitchable, Size(320, 240), 0.5, 8);
+    EXPECT_EQ(cheap.mode, FrameParallelism::InterFrame);
+    EXPECT_EQ(cheap.framesInFlight, 8);
+    EXPECT_EQ(cheap.threadsPerFrame, 1);
+    EXPECT_EQ(FramePipeline::choosePlan(wholeFrame, Size(1920, 1080), 200.0, 8).mode, FrameParallelism::InterFrame);
+
+    // Expensive frames use the whole budget on one frame
+    FramePipelinePlan heavy = FramePipeline::choosePlan(stitchable, Size(1920, 1080), 80.0, 8);
+    EXPECT_EQ(heavy.mode, FrameParallelism::IntraFrame);
+    EXPECT_EQ(heavy.threadsPerFrame, 8);
+    EXPECT_EQ(heavy.framesInFlight, 1);
+
+    // In between, a few frames at a time with a few strips each
+    FramePipelinePlan middle = FramePipeline::choosePlan(stitchable, Size(640, 480), 3.0, 8);
+    EXPECT_EQ(middle.mode, FrameParallelism::Hybrid);
+    EXPECT_EQ(middle.threadsPerFrame, 3);
+    EXPECT_EQ(middle.framesInFlight, 2);
+
+    // Short frames are limited by their rows, not by their cost
+    EXPECT_EQ(FramePipeline::choosePlan(stitchable, Size(4000, 64), 50.0, 8).threadsPerFrame, 2);
+}
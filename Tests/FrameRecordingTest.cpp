@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include "Headers/FrameRecording.hpp"
+#include "Headers/NativeCapture.hpp"
+#include "Headers/SyntheticContent.hpp"
+#include <filesystem>
+#include <thread>
+
+static string temporaryRecording(const string& name) {
+    return (filesystem::temp_directory_path() / name).string();
+}
+
+static void recordFrames(const string& path, const vector<Mat>& frames, PixelFormat format = PixelFormat::BGR) {
+    FrameRecorder recorder(frames.size());
+    EXPECT_TRUE(recorder.open(path, frames[0].size(), frames[0].type(), format));
+    for (const Mat& frame : frames) {
+        EXPECT_TRUE(recorder.append(frame));
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    recorder.close();
+    EXPECT_EQ(recorder.framesWritten(), frames.size());
+    EXPECT_EQ(recorder.framesDropped(), 0u);
+}
+
+TEST(FrameRecordingTest, MappedFramesMatchWhatWasRecorded) {
+    string path = temporaryRecording("cpmulti_recording_test.cpraw");
+    vector<Mat> frames;
+    for (ContentClass content : {ContentClass::Natural, ContentClass::HighEdge, ContentClass::Noise}) {
+        frames.push_back(SyntheticContent::generate(Size(321, 243), content));
+    }
+    recordFrames(path, frames);
+
+    MappedRecording recording;
+    ASSERT_TRUE(recording.open(path));
+    ASSERT_EQ(recording.frameCount(), frames.size());
+    EXPECT_EQ(recording.frameSize(), Size(321, 243));
+    EXPECT_EQ(recording.frameType(), CV_8UC3);
+    for (size_t i = 0; i < frames.size(); i++) {
+        Mat frame = recording.frame(i);
+        ASSERT_EQ(frame.size(), frames[i].size());
+        EXPECT_EQ(norm(frame, frames[i], NORM_INF), 0) << "frame " << i;
+        if (i > 0) {
+            EXPECT_GT(recording.timestampUs(i), recording.timestampUs(i - 1));
+        }
+    }
+    EXPECT_TRUE(recording.frame(frames.size()).empty());
+
+    // Frames are views of the mapping: asking twice gives the same pixels, not a copy, and they
+    // start SLOT_DATA_OFFSET (64) bytes into a page-aligned slot
+    EXPECT_EQ(recording.frame(1).data, recording.frame(1).data);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(recording.frame(1).data) % FrameRecorder::SLOT_DATA_OFFSET, 0u);
+
+    // Writing to a frame stays private to this process
+    recording.frame(0).setTo(Scalar::all(0));
+    MappedRecording again;
+    ASSERT_TRUE(again.open(path, false));
+    EXPECT_EQ(norm(again.frame(0), frames[0], NORM_INF), 0);
+
+    recording.close();
+    again.close();
+    filesystem::remove(path);
+}
+
+TEST(FrameRecordingTest, NativeCaptureReplaysNv12Recordings) {
+    string path = temporaryRecording("cpmulti_recording_nv12_test.cpraw");
+    vector<Mat> frames;
+    for (ContentClass content : {ContentClass::Natural, ContentClass::Noise}) {
+        frames.push_back(NativeCapture::encode(SyntheticContent::generate(Size(320, 240), content), PixelFormat::NV12));
+    }
+    recordFrames(path, frames, PixelFormat::NV12);
+
+    NativeCapture capture;
+    ASSERT_TRUE(capture.open(path));
+    EXPECT_EQ(capture.format(), PixelFormat::NV12);
+    EXPECT_EQ(capture.frameSize(), Size(320, 240));
+    Mat frame;
+    for (const Mat& expected : frames) {
+        ASSERT_TRUE(capture.read(frame));
+        EXPECT_EQ(norm(frame, expected, NORM_INF), 0);
+    }
+    EXPECT_FALSE(capture.read(frame));
+    capture.release();
+    filesystem::remove(path);
+}
+
+TEST(FrameRecordingTest, RejectsFilesThatAreNotRecordings) {
+    string path = temporaryRecording("cpmulti_not_a_recording.cpraw");
+    {
+        ofstream file(path, ios::binary);
+        string text(8192, 'x');
+        file.write(text.data(), static_cast<streamsize>(text.size()));
+    }
+    MappedRecording recording;
+    EXPECT_FALSE(recording.open(path));
+    EXPECT_FALSE(recording.isOpen());
+    filesystem::remove(path);
+
+    // Frames of another size than the recording are dropped, not written into the wrong stride
+    FrameRecorder recorder;
+    ASSERT_TRUE(recorder.open(path, Size(64, 48), CV_8UC3));
+    EXPECT_FALSE(recorder.append(Mat(Size(32, 24), CV_8UC3, Scalar::all(1))));
+    EXPECT_TRUE(recorder.append(Mat(Size(64, 48), CV_8UC3, Scalar::all(1))));
+    recorder.close();
+    EXPECT_EQ(recorder.framesWritten(), 1u);
+    EXPECT_EQ(recorder.framesDropped(), 1u);
+    filesystem::remove(path);
+}
+
+// Once the disk refuses a write, frames are refused too and close() reports the failure
+TEST(FrameRecordingTest, StopsAcceptingFramesAfterAWriteFails) {
+    if (!filesystem::exists("/dev/full")) {
+        GTEST_SKIP() << "needs /dev/full";
+    }
+    FrameRecorder recorder;
+    ASSERT_TRUE(recorder.open("/dev/full", Size(64, 48), CV_8UC3));
+    Mat frame(Size(64, 48), CV_8UC3, Scalar::all(1));
+
+    bool refused = false;
+    for (int attempt = 0; attempt < 200 && !refused; attempt++) {
+        refused = !recorder.append(frame);
+        this_thread::sleep_for(chrono::milliseconds(5));
+    }
+    EXPECT_TRUE(refused);
+    EXPECT_FALSE(recorder.append(frame));
+    EXPECT_FALSE(recorder.close());
+    EXPECT_FALSE(recorder.isOpen());
+}
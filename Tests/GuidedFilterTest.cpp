@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include "Headers/GuidedFilter.hpp"
+#include "Headers/SyntheticContent.hpp"
+
+// Textbook guided filter in floating point, with box means over windows clipped at the border
+static Mat referenceGuidedFilter(const Mat& input, int radius, double smoothing) {
+    Mat image, ones = Mat::ones(input.size(), CV_64FC(input.channels()));
+    input.convertTo(image, CV_64F);
+    Size window(2 * radius + 1, 2 * radius + 1);
+    Mat count;
+    boxFilter(ones, count, CV_64F, window, Point(-1, -1), false, BORDER_CONSTANT);
+    auto boxMean = [&](const Mat& plane) {
+        Mat sum;
+        boxFilter(plane, sum, CV_64F, window, Point(-1, -1), false, BORDER_CONSTANT);
+        return Mat(sum / count);
+    };
+
+    Mat mean = boxMean(image);
+    Mat variance = boxMean(image.mul(image)) - mean.mul(mean);
+    Mat a = variance / (variance + Scalar::all(smoothing * smoothing));
+    Mat b = mean - a.mul(mean);
+    Mat output = boxMean(a).mul(image) + boxMean(b);
+    output.convertTo(output, input.type());
+    return output;
+}
+
+TEST(GuidedFilterTest, MatchesFloatingPointReference) {
+    Mat input = SyntheticContent::generate(Size(203, 157), ContentClass::Natural);
+    for (int radius : {1, 4, 8}) {
+        Mat expected = referenceGuidedFilter(input, radius, 20.0);
+        Mat actual = GuidedFilter(radius, 20.0f).applyFilter(input);
+        ASSERT_EQ(actual.type(), input.type());
+        EXPECT_LE(norm(expected, actual, NORM_INF), 1) << "radius " << radius;
+    }
+}
+
+// Noise on a step edge is smoothed away while the step itself stays sharp
+TEST(GuidedFilterTest, RemovesNoiseAndKeepsEdges) {
+    Mat clean(120, 160, CV_8UC3, Scalar::all(60));
+    clean.colRange(80, 160).setTo(Scalar::all(190));
+    Mat noise(clean.size(), CV_16SC3);
+    randn(noise, Scalar::all(0), Scalar::all(15));
+    Mat noisy;
+    clean.convertTo(noisy, CV_16S);
+    noisy += noise;
+    noisy.convertTo(noisy, CV_8U);
+
+    Mat filtered = GuidedFilter(8, 20.0f).applyFilter(noisy);
+    EXPECT_GT(PSNR(filtered, clean), PSNR(noisy, clean) + 5);
+
+    Scalar dark = mean(filtered(Rect(76, 0, 2, 120)));
+    Scalar bright = mean(filtered(Rect(82, 0, 2, 120)));
+    EXPECT_GT(bright[0] - dark[0], 0.85 * (190 - 60));
+
+    // A flat image has no variance to keep and nothing to smooth
+    Mat flat(64, 48, CV_8UC3, Scalar(10, 128, 250));
+    EXPECT_EQ(norm(GuidedFilter(8, 20.0f).applyFilter(flat), flat, NORM_INF), 0);
+}
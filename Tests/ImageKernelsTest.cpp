@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include "Headers/ImageKernels.hpp"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+
+using namespace cv;
+using namespace std;
+using namespace ImageKernels;
+
+// Every compiled instruction set must reproduce the OpenCV operations the kernel replaces
+class GradientMagnitudeTest : public testing::TestWithParam<IsaLevel> {};
+
+TEST_P(GradientMagnitudeTest, MatchesConvertScaleAbsAndAddWeighted) {
+    IsaLevel level = GetParam();
+    if (!isAvailable(level)) {
+        GTEST_SKIP() << isaName(level) << " is not available on this CPU or build";
+    }
+
+    // Odd length exercises the scalar tail after the vector loop
+    Mat gx(97, 131, CV_16S), gy(97, 131, CV_16S);
+    randu(gx, Scalar(-40000), Scalar(40000));
+    randu(gy, Scalar(-600), Scalar(600));
+    gx.at<int16_t>(0, 0) = -32768;
+
+    Mat absX, absY, expected;
+    convertScaleAbs(gx, absX);
+    convertScaleAbs(gy, absY);
+    addWeighted(absX, 0.5, absY, 0.5, 0, expected);
+
+    Mat actual(gx.size(), CV_8U);
+    gradientMagnitude(level, gx.ptr<int16_t>(), gy.ptr<int16_t>(), actual.ptr<uint8_t>(), actual.total());
+    EXPECT_EQ(norm(expected, actual, NORM_INF), 0);
+
+    // A missing gradient counts as zero
+    addWeighted(absX, 0.5, Mat::zeros(gx.size(), CV_8U), 0.5, 0, expected);
+    gradientMagnitude(level, gx.ptr<int16_t>(), nullptr, actual.ptr<uint8_t>(), actual.total());
+    EXPECT_EQ(norm(expected, actual, NORM_INF), 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(AllLevels, GradientMagnitudeTest,
+                         testing::Values(IsaLevel::Generic, IsaLevel::SSE42, IsaLevel::AVX2, IsaLevel::AVX512),
+                         [](const testing::TestParamInfo<IsaLevel>& info) {
+                             string name = isaName(info.param);
+                             name.erase(remove(name.begin(), name.end(), '.'), name.end());
+                             return name;
+                         });
+
+TEST(IsaDispatchTest, ActiveLevelIsAvailable) {
+    EXPECT_TRUE(isAvailable(activeIsa()));
+    EXPECT_LE(static_cast<int>(activeIsa()), static_cast<int>(detectIsa()));
+}
+
+TEST(ContentHashTest, SameAtEveryLevelAndSensitiveToEveryByte) {
+    vector<uint8_t> data(64 * 37 + 13);     // Whole blocks, a partial block and a tail
+    for (size_t i = 0; i < data.size(); i++) data[i] = static_cast<uint8_t>((i * 2654435761u) >> 13);
+
+    uint64_t expected = hash64(IsaLevel::Generic, data.data(), data.size());
+    for (IsaLevel level : {IsaLevel::SSE42, IsaLevel::AVX2, IsaLevel::AVX512}) {
+        if (isAvailable(level)) {
+            EXPECT_EQ(hash64(level, data.data(), data.size()), expected) << isaName(level);
+        }
+    }
+
+    for (size_t i : {size_t(0), size_t(100), data.size() - 1}) {
+        vector<uint8_t> flipped = data;
+        flipped[i] ^= 1;
+        EXPECT_NE(hash64(flipped.data(), flipped.size()), expected) << "byte " << i;
+    }
+
+    // Moving data between stripes changes the hash, as does the length alone
+    vector<uint8_t> swapped = data;
+    swap_ranges(swapped.begin(), swapped.begin() + 64, swapped.begin() + 64 * 20);
+    EXPECT_NE(hash64(swapped.data(), swapped.size()), expected);
+    vector<uint8_t> zeros(8, 0);
+    EXPECT_NE(hash64(zeros.data(), 7), hash64(zeros.data(), 8));
+}
+
+// Rows with padding between them hash like the same rows stored back to back, whatever the row length
+TEST(ContentHashTest, StridedRowsMatchContiguousBytes) {
+    for (size_t rowBytes : {size_t(3), size_t(64), size_t(100), size_t(192)}) {
+        const size_t rows = 17, stride = rowBytes + 29;
+        vector<uint8_t> strided(stride * rows, 0xAB), contiguous(rowBytes * rows);
+        for (size_t i = 0; i < contiguous.size(); i++) {
+            contiguous[i] = static_cast<uint8_t>((i * 2654435761u) >> 13);
+            strided[(i / rowBytes) * stride + i % rowBytes] = contiguous[i];
+        }
+        uint64_t expected = hash64(contiguous.data(), contiguous.size());
+        EXPECT_EQ(hash64Rows(strided.data(), rowBytes, rows, stride), expected) << rowBytes << " bytes per row";
+        for (IsaLevel level : {IsaLevel::SSE42, IsaLevel::AVX2, IsaLevel::AVX512}) {
+            if (isAvailable(level)) {
+                EXPECT_EQ(hash64Rows(level, strided.data(), rowBytes, rows, stride), expected) << isaName(level);
+            }
+        }
+    }
+}
+
+// The approximated log-magnitude stays within one grey level of the exact one at every level
+class LogMagnitudeTest : public testing::TestWithParam<IsaLevel> {};
+
+TEST_P(LogMagnitudeTest, WithinOneLevelOfExactLog) {
+    IsaLevel level = GetParam();
+    if (!isAvailable(level)) {
+        GTEST_SKIP() << isaName(level) << " is not available on this CPU or build";
+    }
+
+    // Magnitudes over many octaves, including zero, at an odd length
+    Mat logMagnitudes(1, 4099, CV_32F), angles(1, 4099, CV_32F);
+    randu(logMagnitudes, Scalar(-8), Scalar(22));
+    randu(angles, Scalar(0), Scalar(2 * CV_PI));
+    Mat spectrum(1, 4099, CV_32FC2);
+    for (int i = 0; i < spectrum.cols; i++) {
+        float magnitude = (i == 0) ? 0.0f : exp(logMagnitudes.at<float>(i));
+        spectrum.at<Vec2f>(i) = Vec2f(magnitude * cos(angles.at<float>(i)), magnitude * sin(angles.at<float>(i)));
+    }
+    float scale = 255.0f / log2(1.0f + exp(22.0f));
+
+    Mat actual(1, spectrum.cols, CV_8U);
+    logMagnitude(level, spectrum.ptr<float>(), actual.ptr<uint8_t>(), actual.total(), scale);
+    EXPECT_EQ(actual.at<uint8_t>(0), 0);
+    for (int i = 0; i < spectrum.cols; i++) {
+        Vec2f z = spectrum.at<Vec2f>(i);
+        double expected = min(255.0, round(log2(1.0 + hypot(double(z[0]), double(z[1]))) * scale));
+        EXPECT_LE(abs(expected - actual.at<uint8_t>(i)), 1) << "value " << i;
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllLevels, LogMagnitudeTest,
+                         testing::Values(IsaLevel::Generic, IsaLevel::SSE42, IsaLevel::AVX2, IsaLevel::AVX512),
+                         [](const testing::TestParamInfo<IsaLevel>& info) {
+                             string name = isaName(info.param);
+                             name.erase(remove(name.begin(), name.end(), '.'), name.end());
+                             return name;
+                         });
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include "Headers/NativeCapture.hpp"
+#include "Headers/MultiThreadImageProcessor.hpp"
+#include "Headers/SyntheticContent.hpp"
+#include <filesystem>
+#include <fstream>
+
+TEST(NativeCaptureTest, Nv12LumaIsUsedInPlace) {
+    Mat bgr = SyntheticContent::generate(Size(640, 480), ContentClass::Natural);
+    Mat nv12 = NativeCapture::encode(bgr, PixelFormat::NV12);
+    ASSERT_EQ(nv12.size(), Size(640, 720));
+
+    FrameContext context(nv12, PixelFormat::NV12);
+    EXPECT_EQ(context.size(), bgr.size());
+    EXPECT_EQ(context.grey().data, nv12.data);
+    EXPECT_EQ(context.grey().size(), bgr.size());
+
+    Mat expected;
+    cvtColor(nv12, expected, COLOR_YUV2BGR_NV12);
+    EXPECT_EQ(norm(context.frame(), expected, NORM_INF), 0);
+}
+
+TEST(NativeCaptureTest, YuyvLumaMatchesOpenCvConversion) {
+    Mat bgr = SyntheticContent::generate(Size(642, 480), ContentClass::HighEdge);
+    Mat yuyv = NativeCapture::encode(bgr, PixelFormat::YUYV);
+    MultiThreadImageProcessor processor(1, 4);
+    FrameContext context(yuyv, PixelFormat::YUYV, &processor.getThreadPool(), 4);
+
+    Mat expected;
+    cvtColor(yuyv, expected, COLOR_YUV2GRAY_YUYV);
+    EXPECT_EQ(norm(context.grey(), expected, NORM_INF), 0);
+}
+
+// Grey-domain filters on a native frame equal the same filters on its luma plane
+TEST(NativeCaptureTest, GreyFiltersReadTheLumaPlane) {
+    MultiThreadImageProcessor processor(1, 4);
+    ExecutionOptions options;
+    options.numThreads = 3;
+    Mat nv12 = NativeCapture::encode(SyntheticContent::generate(Size(640, 480), ContentClass::Natural), PixelFormat::NV12);
+    Mat luma = nv12.rowRange(0, 480).clone();
+
+    for (const char* filterName : {"sobel", "canny"}) {
+        FrameContext context(nv12, PixelFormat::NV12, &processor.getThreadPool(), options.numThreads);
+        Mat expected = processor.applyFilter(filterName, luma, options);
+        Mat actual = processor.applyFilter(filterName, context, options);
+        ASSERT_EQ(expected.size(), actual.size()) << filterName;
+        Mat differing;
+        compare(expected, actual, differing, CMP_NE);
+        EXPECT_LE(countNonZero(differing), string(filterName) == "canny" ? static_cast<int>(0.005 * differing.total()) : 0) << filterName;
+    }
+
+    // Colour filters still work, from the converted frame
+    FrameContext context(nv12, PixelFormat::NV12, &processor.getThreadPool(), options.numThreads);
+    Mat blurred = processor.applyFilter("gaussian", context, options);
+    EXPECT_EQ(blurred.type(), CV_8UC3);
+    EXPECT_EQ(blurred.size(), Size(640, 480));
+}
+
+TEST(NativeCaptureTest, RawRecordingReadsBackFrameByFrame) {
+    string path = (filesystem::temp_directory_path() / "cpmulti_native_test.nv12").string();
+    vector<Mat> frames;
+    {
+        ofstream file(path, ios::binary);
+        for (ContentClass content : {ContentClass::Natural, ContentClass::HighEdge, ContentClass::Noise}) {
+            frames.push_back(NativeCapture::encode(SyntheticContent::generate(Size(320, 240), content), PixelFormat::NV12));
+            file.write(reinterpret_cast<const char*>(frames.back().data), frames.back().total());
+        }
+    }
+
+    NativeCapture capture;
+    ASSERT_TRUE(capture.open(path + ":320x240"));
+    EXPECT_EQ(capture.format(), PixelFormat::NV12);
+    Mat frame;
+    for (const Mat& expected : frames) {
+        ASSERT_TRUE(capture.read(frame));
+        EXPECT_EQ(norm(frame, expected, NORM_INF), 0);
+    }
+    EXPECT_FALSE(capture.read(frame));
+    capture.release();
+    filesystem::remove(path);
+}
@@ -0,0 +1,30 @@
+#include <gtest/gtest.h>
+#include "Headers/PerformanceVisualization.hpp"
+#include <filesystem>
+
+// Plots queued for one window but different files are all written; only a newer request for
+// the same file replaces a queued one
+TEST(PerformanceVisualizationTest, WritesEveryQueuedOutput) {
+    filesystem::path directory = filesystem::temp_directory_path() / "cpmulti_plot_test";
+    filesystem::remove_all(directory);
+    filesystem::create_directories(directory);
+
+    {
+        PerformanceVisualization visualization(directory.string());
+        unordered_map<string, vector<double>> data = {{"gaussian", {400, 250, 180}}};
+        for (const char* outputName : {"resolution_sweep_gaussian.png", "resolution_sweep_median.png"}) {
+            PerformanceVisualization::PlotConfig config;
+            config.width = 320;
+            config.height = 240;
+            config.windowName = "Resolution Sweep";
+            config.outputName = outputName;
+            visualization.setConfig(config);
+            visualization.plotPerformance(data);
+        }
+    }   // The destructor finishes every queued plot
+
+    EXPECT_TRUE(filesystem::exists(directory / "resolution_sweep_gaussian.png"));
+    EXPECT_TRUE(filesystem::exists(directory / "resolution_sweep_median.png"));
+    EXPECT_FALSE(filesystem::exists(directory / "performance_plot.png"));
+    filesystem::remove_all(directory);
+}
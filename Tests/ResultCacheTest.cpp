@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include "Headers/ResultCache.hpp"
+#include "Headers/MultiThreadImageProcessor.hpp"
+#include "Headers/SyntheticContent.hpp"
+
+TEST(ResultCacheTest, EvictsLeastRecentlyUsedWithinBound) {
+    Mat output(100, 100, CV_8UC3, Scalar(1, 2, 3));     // 30000 bytes
+    ResultCache cache(2 * 30000);
+    CacheKey first = ResultCache::makeKey(SyntheticContent::generate(Size(64, 48), ContentClass::Noise), "f");
+    CacheKey second = ResultCache::makeKey(SyntheticContent::generate(Size(64, 48), ContentClass::Natural), "f");
+    CacheKey third = ResultCache::makeKey(SyntheticContent::generate(Size(64, 48), ContentClass::HighEdge), "f");
+
+    cache.insert(first, output);
+    cache.insert(second, output);
+    Mat found;
+    EXPECT_TRUE(cache.lookup(first, found));    // first is now the most recent
+    cache.insert(third, output);
+
+    EXPECT_EQ(cache.entryCount(), 2u);
+    EXPECT_LE(cache.sizeBytes(), 2u * 30000);
+    EXPECT_TRUE(cache.lookup(first, found));
+    EXPECT_FALSE(cache.lookup(second, found));
+    EXPECT_TRUE(cache.lookup(third, found));
+    EXPECT_EQ(cache.hits(), 3u);
+    EXPECT_EQ(cache.misses(), 1u);
+}
+
+TEST(ResultCacheTest, KeyCoversFilterAndContentButNotStride) {
+    Mat frame = SyntheticContent::generate(Size(64, 48), ContentClass::Natural);
+    Mat padded(48, 80, CV_8UC3, Scalar(0, 0, 0));
+    frame.copyTo(padded(Rect(8, 0, 64, 48)));
+    Mat view = padded(Rect(8, 0, 64, 48));
+
+    EXPECT_EQ(ResultCache::makeKey(frame, "f"), ResultCache::makeKey(frame.clone(), "f"));
+    EXPECT_FALSE(ResultCache::makeKey(frame, "f") == ResultCache::makeKey(frame, "g"));
+    // A view hashes only its own pixels, not the padding around it
+    uint64_t before = ResultCache::hashImage(view);
+    EXPECT_EQ(before, ResultCache::hashImage(frame));
+    padded(Rect(0, 0, 8, 48)).setTo(Scalar(255, 255, 255));
+    padded(Rect(72, 0, 8, 48)).setTo(Scalar(255, 255, 255));
+    EXPECT_EQ(ResultCache::hashImage(view), before);
+}
+
+TEST(ResultCacheTest, ProcessorServesRepeatsButNeverTimedRuns) {
+    MultiThreadImageProcessor processor(2, 2);
+    processor.getResultCache().setCapacity(64 << 20);
+    Mat frame = SyntheticContent::generate(Size(320, 240), ContentClass::Natural);
+
+    Mat first = processor.applyFilter("median", frame);
+    Mat second = processor.applyFilter("median", frame);
+    EXPECT_EQ(processor.getResultCache().hits(), 1u);
+    EXPECT_EQ(norm(first, second, NORM_INF), 0);
+    EXPECT_NE(first.data, second.data);     // Callers get their own copy
+
+    processor.applyFilterTimed("median", frame);
+    EXPECT_EQ(processor.getResultCache().hits(), 1u);
+    EXPECT_EQ(processor.getResultCache().misses(), 1u);
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "Headers/MultiThreadImageProcessor.hpp"
+#include "Headers/SyntheticContent.hpp"
+#include <stdexcept>
+
+TEST(TaskFutureTest, SubmittedFilterMatchesBlockingCall) {
+    MultiThreadImageProcessor processor(1, 4);
+    Mat input = SyntheticContent::generate(Size(643, 487), ContentClass::Natural);
+    ExecutionOptions options;
+    options.numThreads = 3;
+
+    TaskFuture<Mat> pending = processor.submitFilter("gaussian", input, options);
+    Mat expected = processor.applyFilter("gaussian", input, options);
+    Mat actual = pending.get();
+    ASSERT_EQ(expected.size(), actual.size());
+    EXPECT_EQ(norm(expected, actual, NORM_INF), 0);
+
+    auto [sequential, duration] = processor.submitSequential("median", input).get();
+    EXPECT_EQ(norm(sequential, processor.sequentialFilter("median", input).first, NORM_INF), 0);
+    EXPECT_GE(duration, 0);
+}
+
+TEST(TaskFutureTest, ContinuationsRunInOrderAfterTheFilter) {
+    MultiThreadImageProcessor processor(1, 4);
+    Mat input = SyntheticContent::generate(Size(320, 240), ContentClass::HighEdge);
+    ExecutionOptions options;
+    options.numThreads = 2;
+
+    TaskFuture<int> edges = processor.submitFilterTimed("canny", input, options)
+        .then([](pair<Mat, double> result) { return result.first; })
+        .then([](Mat output) { return countNonZero(output); });
+    EXPECT_EQ(edges.get(), countNonZero(processor.applyFilter("canny", input, options)));
+
+    // A continuation added after completion runs right away, on the caller
+    TaskFuture<int> again = edges.then([](int count) { return count + 1; });
+    EXPECT_TRUE(again.isReady());
+    EXPECT_EQ(again.get(), edges.get() + 1);
+}
+
+TEST(TaskFutureTest, ExceptionsPassDownTheChain) {
+    ThreadPool pool(2);
+    TaskFuture<int> failed = pool.submit([]() -> int { throw runtime_error("filter failed"); });
+    bool continued = false;
+    TaskFuture<int> chained = failed.then([&continued](int value) { continued = true; return value; });
+    EXPECT_THROW(chained.get(), runtime_error);
+    EXPECT_FALSE(continued);
+}
+
+// Work and continuations without a result chain like any other; a future without work throws
+TEST(TaskFutureTest, VoidResultsAndEmptyFutures) {
+    ThreadPool pool(2);
+    atomic<int> steps{0};
+    TaskFuture<void> done = pool.submit([&steps]() { steps++; })
+        .then([&steps]() { steps++; });
+    TaskFuture<int> counted = done.then([&steps]() { return steps.load(); });
+    EXPECT_EQ(counted.get(), 2);
+    EXPECT_NO_THROW(done.get());
+
+    TaskFuture<int> empty;
+    EXPECT_FALSE(empty.valid());
+    EXPECT_THROW(empty.isReady(), future_error);
+    EXPECT_THROW(empty.get(), future_error);
+}
+
+// Frame N is filtered while frame N + 1 is prepared on the calling thread
+TEST(TaskFutureTest, OverlapsPreparationOfTheNextFrame) {
+    MultiThreadImageProcessor processor(1, 4);
+    ExecutionOptions options;
+    options.numThreads = 2;
+
+    vector<Mat> frames;
+    for (ContentClass content : {ContentClass::Natural, ContentClass::HighEdge, ContentClass::Noise}) {
+        frames.push_back(SyntheticContent::generate(Size(320, 240), content));
+    }
+
+    Mat next = frames[0].clone();
+    TaskFuture<Mat> inFlight;
+    vector<Mat> outputs;
+    for (size_t i = 0; i < frames.size(); i++) {
+        Mat current = next;
+        TaskFuture<Mat> submitted = processor.submitFilter("sobel", current, options);
+        if (inFlight.valid()) outputs.push_back(inFlight.get());
+        inFlight = submitted;
+        if (i + 1 < frames.size()) next = frames[i + 1].clone();   // The capture stand-in writes a fresh buffer
+    }
+    outputs.push_back(inFlight.get());
+
+    ASSERT_EQ(outputs.size(), frames.size());
+    for (size_t i = 0; i < frames.size(); i++) {
+        EXPECT_EQ(norm(outputs[i], processor.applyFilter("sobel", frames[i], options), NORM_INF), 0);
+    }
+}
@@ -0,0 +1,29 @@
+#include <gtest/gtest.h>
+#include "Headers/ThreadPool.hpp"
+
+// A thread kept off the compute CPUs runs none of its loop itself, but every index still runs once
+TEST(ThreadPoolTest, CallerCanLeaveTheLoopToThePool) {
+    ThreadPool pool(3);
+    for (bool participates : {true, false}) {
+        thread caller([&]() {
+            ThreadPool::setCallerParticipates(participates);
+            vector<atomic<int>> runs(64);
+            atomic<int> onCaller{0};
+            thread::id callerId = this_thread::get_id();
+            for (int maxWorkers : {1, 2, 8}) {
+                for (auto& count : runs) count = 0;
+                pool.parallelFor(runs.size(), maxWorkers, [&](size_t i, int) {
+                    runs[i]++;
+                    if (this_thread::get_id() == callerId) onCaller++;
+                });
+                for (size_t i = 0; i < runs.size(); i++) {
+                    EXPECT_EQ(runs[i], 1) << "index " << i;
+                }
+            }
+            if (!participates) {
+                EXPECT_EQ(onCaller, 0);
+            }
+        });
+        caller.join();
+    }
+}
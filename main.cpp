@@ -1,9 +1,122 @@
 #include "Headers/WebcamOperations.hpp"
+#include "Headers/BenchmarkStore.hpp"
+
+// Options come in pairs; a trailing option without its value is an error, not something to ignore
+static bool hasValue(int argc, char** argv, int i) {
+    if (i + 1 < argc) return true;
+    cerr << "Error: Option '" << argv[i] << "' needs a value" << endl;
+    return false;
+}
+
+// --compare [--store <file>] [--baseline <run|git>] [--candidate <run|git>] [--threshold <percent>]
+static int compareBenchmarks(int argc, char** argv) {
+    string storePath = "../resources/benchmark_results.tsv";
+    ComparisonOptions options;
+    for (int i = 2; i < argc; i += 2) {
+        if (!hasValue(argc, argv, i)) return 2;
+        string arg = argv[i];
+        if (arg == "--store") storePath = argv[i + 1];
+        else if (arg == "--baseline") options.baselineRun = argv[i + 1];
+        else if (arg == "--candidate") options.candidateRun = argv[i + 1];
+        else if (arg == "--threshold") options.thresholdPercent = atof(argv[i + 1]);
+        else if (arg == "--alpha") options.alpha = atof(argv[i + 1]);
+        else {
+            cerr << "Error: Unknown option '" << arg << "'" << endl;
+            return 2;
+        }
+    }
+    return BenchmarkStore(storePath).compare(options);
+}
+
+int main(int argc, char** argv) {
+    // Exits non-zero on a significant regression, so it can gate a release
+    if (argc > 1 && string(argv[1]) == "--compare") {
+        return compareBenchmarks(argc, argv);
+    }
 
-int main() {
     WebcamOperations webcam;
 
     webcam.setResourcesPath("../resources");
+
+    // --sweep runs the resolution and content benchmark without a camera;
+    // --sweep quick stops at 1080p and is the training workload for PGO builds
+    if (argc > 1 && string(argv[1]) == "--sweep") {
+        webcam.runResolutionSweep(argc > 2 && string(argv[2]) == "quick");
+        return 0;
+    }
+
+    // --streams <source> [<source> ...] [--filter <name>] [--incremental] [--native] processes several feeds at once
+    if (argc > 2 && string(argv[1]) == "--streams") {
+        vector<string> sources;
+        string filterName = "gaussian";
+        bool incremental = false;
+        bool native = false;
+        for (int i = 2; i < argc; i++) {
+            string arg = argv[i];
+            if (arg == "--filter") {
+                if (!hasValue(argc, argv, i)) return 2;
+                filterName = argv[++i];
+            } else if (arg == "--incremental") {
+                incremental = true;
+            } else if (arg == "--native") {
+                native = true;
+            } else {
+                sources.push_back(arg);
+            }
+        }
+        webcam.openMultiStream(sources, filterName, incremental, native);
+        return 0;
+    }
+
+    // --replay <source> [--filter <name>] [--mode auto|intra|inter|hybrid] [--output <file>] filters a recording
+    // for throughput, several frames at a time when that pays off, and writes the outputs in order
+    if (argc > 2 && string(argv[1]) == "--replay") {
+        string filterName = "gaussian";
+        string outputPath;
+        FrameParallelism mode = FrameParallelism::Auto;
+        for (int i = 3; i < argc; i += 2) {
+            if (!hasValue(argc, argv, i)) return 2;
+            string arg = argv[i];
+            string value = argv[i + 1];
+            if (arg == "--filter") filterName = value;
+            else if (arg == "--output") outputPath = value;
+            else if (arg == "--mode" && value == "auto") mode = FrameParallelism::Auto;
+            else if (arg == "--mode" && value == "intra") mode = FrameParallelism::IntraFrame;
+            else if (arg == "--mode" && value == "inter") mode = FrameParallelism::InterFrame;
+            else if (arg == "--mode" && value == "hybrid") mode = FrameParallelism::Hybrid;
+            else {
+                cerr << "Error: Unknown option '" << arg << " " << value << "'" << endl;
+                return 2;
+            }
+        }
+        webcam.runReplay(argv[2], filterName, mode, outputPath);
+        return 0;
+    }
+
+    // --batch <folder|file> [--filter <name>[,<name>...]] [--output <folder>] filters many frames per call,
+    // optionally through a chain of filters, and writes each output as a PNG
+    if (argc > 2 && string(argv[1]) == "--batch") {
+        vector<string> chain = {"gaussian"};
+        string outputDir;
+        for (int i = 3; i < argc; i += 2) {
+            if (!hasValue(argc, argv, i)) return 2;
+            string arg = argv[i];
+            string value = argv[i + 1];
+            if (arg == "--filter") {
+                chain.clear();
+                stringstream names(value);
+                for (string name; getline(names, name, ',');) chain.push_back(name);
+            } else if (arg == "--output") {
+                outputDir = value;
+            } else {
+                cerr << "Error: Unknown option '" << arg << " " << value << "'" << endl;
+                return 2;
+            }
+        }
+        webcam.runBatch(argv[2], chain, outputDir);
+        return 0;
+    }
+
     webcam.openWebcam();
     webcam.closeWebcam();
 